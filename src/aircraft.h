@@ -9,6 +9,12 @@
 #include "math.h"
 #include "audio.h"
 #include "assets.h"
+#include "animation.h"
+#include "flight.h"
+#include "terrain.h"
+#include "recorder.h"
+#include "broadphase.h"
+#include "collision.h"
 
 constexpr double ANTI_COLL_LIGHT_PERIOD = 1;
 
@@ -17,12 +23,19 @@ struct Aircraft {
 	Model model;
 	Model cockpit_model;
 	DATMap dat;
+
+	// nodes of model landing gear and propellers drive, set dirty after editing any mesh translation/rotation
+	AnimationTable animation;
 	AudioBuffer* engine_sound;
 	uint64_t audio_playback_id = 0;
 
 	AABB initial_aabb;
 	AABB current_aabb;
 	bool render_aabb;
+	// in World::broadphase, copies are given their own one on next collision test
+	uint32_t broadphase_proxy = BROADPHASE_NONE;
+	// coll.srf/coll.dnm, tested after broadphase finds its AABB intersecting another
+	CollisionMesh collision;
 
 	glm::vec3 translation;
 	glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
@@ -33,9 +46,37 @@ struct Aircraft {
 	float wheelbase = 5.0f;                       // nose→main gear Z-distance, computed from DAT
 	bool visible = true;
 
+	// state before the last simulation step, rendering interpolates from it to current state
+	glm::vec3 prev_translation;
+	glm::quat prev_orientation{1.0f, 0.0f, 0.0f, 0.0f};
+	bool has_prev_state;
+
+	// translation at last collision test, collisions are found all the way from it to current one
+	glm::vec3 swept_from;
+	bool has_swept_from;
+
+	// interpolated state to render, and transformation that takes meshes from current state to it
+	glm::vec3 render_translation;
+	glm::quat render_orientation{1.0f, 0.0f, 0.0f, 0.0f};
+	glm::mat4 render_offset{1.0f};
+
+	// derived from translation, orientation and velocity once per simulation step by aircraft_kinematics_update,
+	// read by physics, AABB, meshes and HUD instead of each of them recomputing it
+	struct {
+		glm::vec3 front{0, 0, 1}, up{0, -1, 0}, right{1, 0, 0};
+		glm::mat4 model_transformation{1.0f};
+		float angle_of_attack;  // degrees
+		float sideslip;         // degrees, +ve -> velocity points right of the nose
+		float airspeed;         // m/s
+		float dynamic_pressure; // Pa
+	} kinematics;
+
 	glm::vec3 acceleration, velocity;
 	float max_velocity;
 
+	// terrain under the aircraft, sampled before every physics step
+	TerrainSample ground = TERRAIN_SAMPLE_PLANE;
+
 	float wing_area; // m^2
 	float friction_coeff = 0.032f;
 	float thrust_multiplier = 500; // too lazy to calculate real thrust
@@ -53,12 +94,15 @@ struct Aircraft {
 	struct {
 		LinearFuncConsts linear;
 
-		bool quad_funcs_dirty;
 		float aoa_crit_neg, aoa_crit_pos;
 		QuadraticFuncConsts quad_neg, quad_pos;
 	} cl_consts;
 	QuadraticFuncConsts cd_consts;
 
+	// baked from cl_consts and cd_consts, set dirty after changing them
+	FlightAeroTable aero_table;
+	bool aero_table_dirty;
+
 	struct {
 		float speed_percent; // 0 -> 1
 		bool burner_enabled = false;
@@ -105,18 +149,10 @@ inline Aircraft aircraft_new(AircraftTemplate aircraft_template) {
 	};
 }
 
-inline void aircraft_load(Aircraft& self) {
+// DNM meshes hierarchy, AABB and DAT constants, everything the flight model needs and nothing of GL
+inline void aircraft_load_physics(Aircraft& self) {
 	self.model = model_from_dnm_file(self.aircraft_template.dnm);
 
-	for (auto& mesh : self.model.meshes) {
-		mesh_load_to_gpu(mesh);
-	}
-
-	self.cockpit_model = model_from_srf_file(self.aircraft_template.cockpit);
-	for (auto& mesh : self.cockpit_model.meshes) {
-		mesh_load_to_gpu(mesh);
-	}
-
 	meshes_foreach(self.model.meshes, [&self](Mesh& mesh) {
 		switch (mesh.animation_type) {
 		case AnimationClass::AIRCRAFT_SPINNER_PROPELLER:
@@ -135,6 +171,9 @@ inline void aircraft_load(Aircraft& self) {
 	});
 
 	self.current_aabb = self.initial_aabb = aabb_from_meshes(self.model.meshes);
+	self.collision = collision_mesh_from_file(self.aircraft_template.collision);
+
+	animation_table_build(self.animation, self.model.meshes, AnimationModel::AIRCRAFT);
 
 	self.dat = datmap_from_dat_file(self.aircraft_template.dat);
 
@@ -179,7 +218,6 @@ inline void aircraft_load(Aircraft& self) {
 		float aoa1 = 0, cl1 = 0.2, aoa2 = 15, cl2 = 1.2;
 		datmap_get_floats(self.dat, "REALPROP 0 CL", {&aoa1, &cl1, &aoa2, &cl2});
 		self.cl_consts.linear = linear_func_new({aoa1, cl1}, {aoa2, cl2});
-		self.cl_consts.quad_funcs_dirty = true;
 	}
 
 	// CRITAOAP  20deg               #CRITICAL AOA POSITIVE
@@ -197,6 +235,7 @@ inline void aircraft_load(Aircraft& self) {
 		datmap_get_floats(self.dat, "REALPROP 0 CD", {&aoa_min, &cd_min, &aoa1, &cl1});
 		self.cd_consts = quad_func_new({aoa_min, cd_min}, {aoa1, cl1});
 	}
+	self.aero_table_dirty = true;
 
 	// MXIPTAOA 20.0deg              #MAX INPUT AOA
 	self.pitch_input_max = 20;
@@ -240,19 +279,75 @@ inline void aircraft_load(Aircraft& self) {
 	self.should_be_loaded = false;
 }
 
+inline void aircraft_load(Aircraft& self) {
+	aircraft_load_physics(self);
+
+	for (auto& mesh : self.model.meshes) {
+		mesh_load_to_gpu(mesh);
+	}
+
+	self.cockpit_model = model_from_srf_file(self.aircraft_template.cockpit);
+	for (auto& mesh : self.cockpit_model.meshes) {
+		mesh_load_to_gpu(mesh);
+	}
+}
+
 inline LocalEulerAngles aircraft_angles(const Aircraft& self) {
 	return local_euler_angles_from_quat(self.orientation);
 }
 
-// degrees
-inline float aircraft_angle_of_attack(const Aircraft& self) {
-	auto ang = aircraft_angles(self);
-	bool other_side = glm::acos(-ang.up.y) > 1.5708f;
-	auto a = 90 + (other_side ? +1 : -1) * glm::acos(-ang.front.y) / RADIANS_MAX * DEGREES_MAX;
-	if (a > 180) {
-		return a - 360;
+inline LocalEulerAngles aircraft_render_angles(const Aircraft& self) {
+	return local_euler_angles_from_quat(self.render_orientation);
+}
+
+// called before each simulation step
+inline void aircraft_prev_state_save(Aircraft& self) {
+	self.prev_translation = self.translation;
+	self.prev_orientation = self.orientation;
+	self.has_prev_state = true;
+}
+
+// `alpha` is where render time is between previous and current state
+inline void aircraft_render_state_interpolate(Aircraft& self, float alpha) {
+	if (self.has_prev_state == false) {
+		alpha = 1;
 	}
-	return a;
+	self.render_translation = glm::mix(self.prev_translation, self.translation, alpha);
+	self.render_orientation = glm::slerp(self.prev_orientation, self.orientation, alpha);
+
+	// meshes are transformed by current state, undo it then apply interpolated one
+	self.render_offset = glm::translate(glm::mat4{1.0f}, self.render_translation)
+		* glm::mat4_cast(self.render_orientation * glm::inverse(self.orientation))
+		* glm::translate(glm::mat4{1.0f}, -self.translation);
+}
+
+// called after anything moves or rotates the aircraft, once per simulation step by physics
+inline void aircraft_kinematics_update(Aircraft& self) {
+	auto& k = self.kinematics;
+
+	const auto ang = aircraft_angles(self);
+	k.front = ang.front;
+	k.up = ang.up;
+	k.right = glm::cross(k.front, k.up);
+	k.model_transformation = local_euler_angles_matrix(ang, self.translation);
+
+	const bool other_side = glm::acos(-k.up.y) > 1.5708f;
+	k.angle_of_attack = 90 + (other_side ? +1 : -1) * glm::acos(-k.front.y) / RADIANS_MAX * DEGREES_MAX;
+	if (k.angle_of_attack > 180) {
+		k.angle_of_attack -= 360;
+	}
+
+	k.airspeed = glm::length(self.velocity);
+	k.sideslip = 0;
+	if (k.airspeed > 0) {
+		k.sideslip = glm::asin(glm::clamp(glm::dot(self.velocity, k.right) / k.airspeed, -1.0f, 1.0f)) / RADIANS_MAX * DEGREES_MAX;
+	}
+	k.dynamic_pressure = 0.5f * float4_first(flight_air_density(self.translation.y)) * k.airspeed * k.airspeed;
+}
+
+// degrees, as of last aircraft_kinematics_update
+inline float aircraft_angle_of_attack(const Aircraft& self) {
+	return self.kinematics.angle_of_attack;
 }
 
 inline float aircraft_calc_drag_coeff(const Aircraft& self, float angle_of_attack) {
@@ -269,6 +364,28 @@ inline float aircraft_calc_lift_coeff(const Aircraft& self, float angle_of_attac
 	return linear_func_eval(self.cl_consts.linear, angle_of_attack);
 }
 
+// stall parts of Cl curve follow its linear part, then both curves are sampled into aero_table for the
+// flight kernel, after DAT load or debug UI edits
+inline void aircraft_update_aero_table(Aircraft& self) {
+	if (self.aero_table_dirty == false) {
+		return;
+	}
+	self.aero_table_dirty = false;
+
+	self.cl_consts.quad_neg = quad_func_new(
+		{self.cl_consts.aoa_crit_neg, linear_func_eval(self.cl_consts.linear, self.cl_consts.aoa_crit_neg)},
+		{-100, 2}
+	);
+	self.cl_consts.quad_pos = quad_func_new(
+		{self.cl_consts.aoa_crit_pos, linear_func_eval(self.cl_consts.linear, self.cl_consts.aoa_crit_pos)},
+		{100, -2}
+	);
+
+	flight_aero_table_bake(self.aero_table, [&](float aoa) {
+		return std::pair{aircraft_calc_lift_coeff(self, aoa), aircraft_calc_drag_coeff(self, aoa)};
+	});
+}
+
 inline void aircraft_unload(Aircraft& self) {
 	for (auto& mesh : self.model.meshes) {
 		mesh_unload_from_gpu(mesh);
@@ -285,21 +402,116 @@ inline void aircraft_set_start(Aircraft& self, const StartInfo& start_info) {
 	self.landing_gear_alpha = start_info.landing_gear_is_out? 0.0f : 1.0f;
 	self.throttle = start_info.throttle;
 	self.engine.speed_percent = start_info.throttle;
+
+	// teleported, nothing to interpolate or sweep from
+	self.has_prev_state = false;
+	self.has_swept_from = false;
+	aircraft_kinematics_update(self);
 }
 
 inline bool aircraft_on_ground(const Aircraft& self) {
-	return self.translation.y >= -1.0f;
+	return self.translation.y >= self.ground.y - 1.0f;
 }
 
 inline float aircraft_mass_total(const Aircraft& self) {
 	return (self.mass.clean + self.mass.fuel + self.mass.load) * 1e6;
 }
 
-inline glm::vec3 aircraft_thrust(const Aircraft& self)   { return aircraft_angles(self).front * self.forces.thrust; }
-inline glm::vec3 aircraft_drag(const Aircraft& self)     { return -aircraft_angles(self).front * self.forces.drag;  }
-inline glm::vec3 aircraft_airlift(const Aircraft& self)  { return aircraft_angles(self).up * self.forces.airlift;   }
+inline glm::vec3 aircraft_thrust(const Aircraft& self)   { return self.kinematics.front * self.forces.thrust; }
+inline glm::vec3 aircraft_drag(const Aircraft& self)     { return -self.kinematics.front * self.forces.drag;  }
+inline glm::vec3 aircraft_airlift(const Aircraft& self)  { return self.kinematics.up * self.forces.airlift;   }
 inline glm::vec3 aircraft_weight(const Aircraft& self)   { return glm::vec3{0,1,0} * self.forces.weight;  }
 
 inline glm::vec3 aircraft_forces_total(const Aircraft& self) {
 	return aircraft_weight(self)+ aircraft_airlift(self) + aircraft_drag(self) + aircraft_thrust(self);
 }
+
+// copies what flight_block_step reads into aircraft's lane
+inline void aircraft_flight_state_store(const Aircraft& self, FlightStates& states, size_t index) {
+	auto& b = states.blocks[index / FLIGHT_LANES];
+	const size_t l = index % FLIGHT_LANES;
+
+	b.px[l] = self.translation.x; b.py[l] = self.translation.y; b.pz[l] = self.translation.z;
+	b.vx[l] = self.velocity.x; b.vy[l] = self.velocity.y; b.vz[l] = self.velocity.z;
+	b.qw[l] = self.orientation.w; b.qx[l] = self.orientation.x; b.qy[l] = self.orientation.y; b.qz[l] = self.orientation.z;
+	b.wx[l] = self.angular_velocity.x; b.wy[l] = self.angular_velocity.y; b.wz[l] = self.angular_velocity.z;
+
+	b.engine_speed[l] = self.engine.speed_percent;
+	b.engine_on[l] = self.engine.cutoff? 0.0f : 1.0f;
+	b.elevator[l] = self.elevator_perc;
+	b.rudder[l] = self.rudder_perc;
+	b.aileron[l] = self.right_aileron_perc;
+	b.braking[l] = self.braking? 1.0f : 0.0f;
+	b.ground_y[l] = self.ground.y;
+
+	b.mass[l] = aircraft_mass_total(self);
+	b.max_power[l] = self.engine.max_power;
+	b.idle_power[l] = self.engine.idle_power;
+	b.thrust_multiplier[l] = self.thrust_multiplier;
+	b.max_velocity[l] = self.max_velocity;
+	b.wing_area[l] = self.wing_area;
+	b.friction_coeff[l] = self.friction_coeff;
+	b.wheelbase[l] = self.wheelbase;
+
+	// code stores inertia in g·m², kernel takes kg·m²
+	b.inertia_inv_x[l] = self.inertia_tensor_inv[0][0] * 1000.0f;
+	b.inertia_inv_y[l] = self.inertia_tensor_inv[1][1] * 1000.0f;
+	b.inertia_inv_z[l] = self.inertia_tensor_inv[2][2] * 1000.0f;
+	b.thrust_offset_x[l] = self.thrust_offset.x;
+	b.thrust_offset_y[l] = self.thrust_offset.y;
+
+	b.aero[l] = &self.aero_table;
+}
+
+// copies what flight_block_step wrote back from aircraft's lane
+inline void aircraft_flight_state_load(Aircraft& self, const FlightStates& states, size_t index) {
+	const auto& b = states.blocks[index / FLIGHT_LANES];
+	const size_t l = index % FLIGHT_LANES;
+
+	self.translation = {b.px[l], b.py[l], b.pz[l]};
+	self.velocity = {b.vx[l], b.vy[l], b.vz[l]};
+	self.orientation = glm::quat{b.qw[l], b.qx[l], b.qy[l], b.qz[l]};
+	self.angular_velocity = {b.wx[l], b.wy[l], b.wz[l]};
+	self.acceleration = {b.ax[l], b.ay[l], b.az[l]};
+	self.torque = {b.tx[l], b.ty[l], b.tz[l]};
+	self.forces.thrust = b.thrust[l];
+	self.forces.drag = b.drag[l];
+	self.forces.airlift = b.airlift[l];
+	self.forces.weight = b.weight[l];
+}
+
+inline RecorderState aircraft_recorder_state(const Aircraft& self) {
+	return RecorderState {
+		.translation = self.translation,
+		.orientation = self.orientation,
+		.velocity = self.velocity,
+		.throttle = self.throttle,
+		.elevator = self.elevator_perc,
+		.aileron = self.right_aileron_perc,
+		.rudder = self.rudder_perc,
+		.engine_speed = self.engine.speed_percent,
+		.landing_gear_alpha = self.landing_gear_alpha,
+		.fuel = self.mass.fuel,
+		.braking = self.braking,
+		.burner_enabled = self.engine.burner_enabled,
+		.engine_cutoff = self.engine.cutoff,
+		.visible = self.visible,
+	};
+}
+
+inline void aircraft_recorder_state_apply(Aircraft& self, const RecorderState& state) {
+	self.translation = state.translation;
+	self.orientation = state.orientation;
+	self.velocity = state.velocity;
+	self.throttle = state.throttle;
+	self.elevator_perc = state.elevator;
+	self.right_aileron_perc = state.aileron;
+	self.rudder_perc = state.rudder;
+	self.engine.speed_percent = state.engine_speed;
+	self.landing_gear_alpha = state.landing_gear_alpha;
+	self.mass.fuel = state.fuel;
+	self.braking = state.braking;
+	self.engine.burner_enabled = state.burner_enabled;
+	self.engine.cutoff = state.engine_cutoff;
+	self.visible = state.visible;
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <mu/utils.h>
+
+#include "assets.h"
+#include "settings.h"
+
+// AnimationClass values mean different things for aircrafts and ground objects
+enum class AnimationModel {
+	AIRCRAFT,
+	GROUND,
+};
+
+// what moves the nodes of a channel each tick, owner of the model sets their translation/rotation/visible
+enum class AnimationChannel {
+	LANDING_GEAR, // STA 0 (up) to STA 1 (down) by landing gear alpha
+	PROPELLER,    // spins around x by engine speed
+	PROPELLER_Z,  // spins around z by engine speed
+	RADAR_SLOW,   // 3 seconds per revolution
+	RADAR_FAST,   // 2 seconds per revolution
+
+	COUNT,
+	NONE = COUNT,
+};
+
+inline AnimationChannel animation_channel_of(const Mesh& mesh, AnimationModel model) {
+	if (model == AnimationModel::AIRCRAFT) {
+		switch (mesh.animation_type) {
+		case AnimationClass::AIRCRAFT_LANDING_GEAR:
+			return mesh.animation_states.size() > 1? AnimationChannel::LANDING_GEAR : AnimationChannel::NONE;
+		case AnimationClass::AIRCRAFT_SPINNER_PROPELLER:   return AnimationChannel::PROPELLER;
+		case AnimationClass::AIRCRAFT_SPINNER_PROPELLER_Z: return AnimationChannel::PROPELLER_Z;
+		default:                                           return AnimationChannel::NONE;
+		}
+	}
+
+	switch (mesh.animation_type) {
+	case AnimationClass::GROUND_SPINNING_RADAR_SLOW: return AnimationChannel::RADAR_SLOW;
+	case AnimationClass::GROUND_SPINNING_RADAR_FAST: return AnimationChannel::RADAR_FAST;
+	default:                                         return AnimationChannel::NONE;
+	}
+}
+
+// parent * T(translation) * Rz * Rx * R-y, same order the DNM is authored in
+inline glm::mat4 mesh_local_transformation(const glm::mat4& parent, const Mesh& mesh) {
+	auto transformation = glm::translate(parent, mesh.translation);
+	transformation = glm::rotate(transformation, mesh.rotation[2], glm::vec3{0, 0, 1});
+	transformation = glm::rotate(transformation, mesh.rotation[1], glm::vec3{1, 0, 0});
+	transformation = glm::rotate(transformation, mesh.rotation[0], glm::vec3{0, -1, 0});
+	return transformation;
+}
+
+// nodes nothing animates, transformation relative to model root is cached
+struct AnimationStaticNode {
+	Mesh* mesh;
+	glm::mat4 model_space;
+};
+
+// animated nodes and everything under them, parents come before their children
+struct AnimationDynamicNode {
+	Mesh* mesh;
+	const Mesh* parent; // null for roots
+};
+
+// built from the model's mesh tree once, instead of visiting all meshes every tick
+// static nodes (the majority, fuselage, wings, ..) cost one matrix multiply with the model root
+struct AnimationTable {
+	const Mesh* meshes_base; // model.meshes.data() it was built for, copying the model rebuilds it
+	AnimationModel model;
+	mu::Vec<AnimationStaticNode> static_nodes;
+	mu::Vec<AnimationDynamicNode> dynamic_nodes;
+	mu::Vec<Mesh*> channels[(size_t) AnimationChannel::COUNT];
+
+	// set after editing translation/rotation of a mesh that isn't animated
+	bool dirty = true;
+};
+
+inline void _animation_table_add(AnimationTable& self, Mesh& mesh, const Mesh* parent, const glm::mat4& parent_model_space, bool parent_dynamic) {
+	const auto channel = animation_channel_of(mesh, self.model);
+	if (channel != AnimationChannel::NONE) {
+		self.channels[(size_t) channel].push_back(&mesh);
+	}
+
+	const bool dynamic = parent_dynamic || channel != AnimationChannel::NONE;
+	glm::mat4 model_space {1.0f};
+	if (dynamic) {
+		self.dynamic_nodes.push_back(AnimationDynamicNode { .mesh = &mesh, .parent = parent });
+	} else {
+		model_space = mesh_local_transformation(parent_model_space, mesh);
+		self.static_nodes.push_back(AnimationStaticNode { .mesh = &mesh, .model_space = model_space });
+	}
+
+	for (auto& child : mesh.children) {
+		_animation_table_add(self, child, &mesh, model_space, dynamic);
+	}
+}
+
+inline void animation_table_build(AnimationTable& self, mu::Vec<Mesh>& meshes, AnimationModel model) {
+	self.meshes_base = meshes.data();
+	self.model = model;
+	self.static_nodes.clear();
+	self.dynamic_nodes.clear();
+	for (auto& channel : self.channels) {
+		channel.clear();
+	}
+
+	for (auto& mesh : meshes) {
+		_animation_table_add(self, mesh, nullptr, glm::mat4{1.0f}, false);
+	}
+
+	self.dirty = false;
+}
+
+// call before touching channels, their nodes point into meshes
+inline void animation_table_update(AnimationTable& self, mu::Vec<Mesh>& meshes, AnimationModel model) {
+	if (self.dirty || self.meshes_base != meshes.data()) {
+		animation_table_build(self, meshes, model);
+	}
+}
+
+// mesh.transformation of all nodes, after channels set their nodes' translation/rotation
+inline void animation_table_transform(AnimationTable& self, const glm::mat4& root) {
+	for (auto& node : self.static_nodes) {
+		node.mesh->transformation = root * node.model_space;
+	}
+	for (auto& node : self.dynamic_nodes) {
+		node.mesh->transformation = mesh_local_transformation(node.parent? node.parent->transformation : root, *node.mesh);
+	}
+}
+
+// visible radars of a ground object turn `dt` seconds worth around x, at the rates their channels are documented with
+inline void animation_table_radars_spin(AnimationTable& self, float dt) {
+	for (Mesh* mesh : self.channels[(size_t) AnimationChannel::RADAR_SLOW]) {
+		if (mesh->visible) {
+			mesh->rotation.x += RADAR_SLOW_ANGLE_SPEED * dt;
+		}
+	}
+	for (Mesh* mesh : self.channels[(size_t) AnimationChannel::RADAR_FAST]) {
+		if (mesh->visible) {
+			mesh->rotation.x += RADAR_FAST_ANGLE_SPEED * dt;
+		}
+	}
+}
+
+inline void test_animation_table() {
+	mu_test_suite("animation_table");
+
+	auto mesh_new = [](glm::vec3 translation, glm::vec3 rotation, AnimationClass animation_type) {
+		Mesh mesh {};
+		mesh.translation = translation;
+		mesh.rotation = rotation;
+		mesh.animation_type = animation_type;
+		mesh.visible = true;
+		return mesh;
+	};
+
+	auto matrices_close = [](const glm::mat4& a, const glm::mat4& b) {
+		for (int i = 0; i < 4; i++) {
+			for (int j = 0; j < 4; j++) {
+				if (std::abs(a[i][j] - b[i][j]) > 1e-4f) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	// fuselage { propeller { spinner }, wing }, tail
+	Model model {};
+	model.meshes.push_back(mesh_new({0, 1, 2}, {0.1f, 0.2f, 0.3f}, AnimationClass::AIRCRAFT_AILERONS));
+	model.meshes.push_back(mesh_new({0, 0, -5}, {0, 0.5f, 0}, AnimationClass::AIRCRAFT_RUDDER));
+	auto& fuselage = model.meshes[0];
+	fuselage.children.push_back(mesh_new({0, 0, 4}, {0, 0, 0}, AnimationClass::AIRCRAFT_SPINNER_PROPELLER));
+	fuselage.children.push_back(mesh_new({3, 0, 0}, {0, 0, 0.2f}, AnimationClass::AIRCRAFT_FLAPS));
+	fuselage.children[0].children.push_back(mesh_new({0, 0, 0.5f}, {0, 0, 0}, AnimationClass::AIRCRAFT_ANTI_COLLISION_LIGHTS));
+
+	AnimationTable table {};
+	animation_table_update(table, model.meshes, AnimationModel::AIRCRAFT);
+
+	{
+		mu_test(table.static_nodes.size() == 3);
+		mu_test(table.dynamic_nodes.size() == 2);
+		mu_test(table.channels[(size_t) AnimationChannel::PROPELLER].size() == 1);
+		mu_test(table.channels[(size_t) AnimationChannel::PROPELLER][0] == &fuselage.children[0]);
+		mu_test(table.channels[(size_t) AnimationChannel::LANDING_GEAR].empty());
+	}
+
+	// same as visiting the whole tree, after animating a node
+	{
+		table.channels[(size_t) AnimationChannel::PROPELLER][0]->rotation.x += 1.0f;
+
+		const auto root = glm::rotate(glm::translate(glm::mat4{1.0f}, glm::vec3{10, 20, 30}), 0.7f, glm::vec3{0, 1, 0});
+		animation_table_transform(table, root);
+
+		const auto fuselage_expected = mesh_local_transformation(root, fuselage);
+		const auto propeller_expected = mesh_local_transformation(fuselage_expected, fuselage.children[0]);
+		mu_test(matrices_close(fuselage.transformation, fuselage_expected));
+		mu_test(matrices_close(fuselage.children[0].transformation, propeller_expected));
+		mu_test(matrices_close(fuselage.children[0].children[0].transformation, mesh_local_transformation(propeller_expected, fuselage.children[0].children[0])));
+		mu_test(matrices_close(fuselage.children[1].transformation, mesh_local_transformation(fuselage_expected, fuselage.children[1])));
+		mu_test(matrices_close(model.meshes[1].transformation, mesh_local_transformation(root, model.meshes[1])));
+	}
+
+	// copied models and edited static nodes rebuild
+	{
+		Model copy = model;
+		animation_table_update(table, copy.meshes, AnimationModel::AIRCRAFT);
+		mu_test(table.channels[(size_t) AnimationChannel::PROPELLER][0] == &copy.meshes[0].children[0]);
+
+		copy.meshes[1].translation.x = 7;
+		table.dirty = true;
+		animation_table_update(table, copy.meshes, AnimationModel::AIRCRAFT);
+		animation_table_transform(table, glm::mat4{1.0f});
+		mu_test(matrices_close(copy.meshes[1].transformation, mesh_local_transformation(glm::mat4{1.0f}, copy.meshes[1])));
+	}
+
+	// a skipped subtree doesn't stop the rest from being visited
+	{
+		mu::Vec<const Mesh*> visited;
+		meshes_visit(model.meshes, [&](const Mesh& mesh) {
+			visited.push_back(&mesh);
+			return &mesh == &fuselage.children[0]? MeshVisit::SKIP_CHILDREN : MeshVisit::CHILDREN;
+		});
+		mu_test(visited.size() == 4);
+		mu_test(std::find(visited.begin(), visited.end(), &fuselage.children[0].children[0]) == visited.end());
+		mu_test(std::find(visited.begin(), visited.end(), &model.meshes[0]) != visited.end());
+	}
+
+	// same classes are radars on ground objects, not propellers
+	{
+		Model ground {};
+		ground.meshes.push_back(mesh_new({0, 0, 0}, {0, 0, 0}, AnimationClass::AIRCRAFT_SPINNER_PROPELLER));
+		ground.meshes.push_back(mesh_new({0, 5, 0}, {0, 0, 0}, AnimationClass::GROUND_SPINNING_RADAR_FAST));
+		AnimationTable ground_table {};
+		animation_table_update(ground_table, ground.meshes, AnimationModel::GROUND);
+		mu_test(ground_table.channels[(size_t) AnimationChannel::PROPELLER].empty());
+		mu_test(ground_table.channels[(size_t) AnimationChannel::RADAR_FAST].size() == 1);
+		mu_test(ground_table.static_nodes.size() == 1);
+	}
+
+	// radars turn once per 3 and 2 seconds, hidden ones don't turn
+	{
+		Model ground {};
+		ground.meshes.push_back(mesh_new({0, 0, 0}, {0, 0, 0}, AnimationClass::GROUND_SPINNING_RADAR_SLOW));
+		ground.meshes.push_back(mesh_new({0, 5, 0}, {0, 0, 0}, AnimationClass::GROUND_SPINNING_RADAR_FAST));
+		ground.meshes.push_back(mesh_new({0, 9, 0}, {0, 0, 0}, AnimationClass::GROUND_SPINNING_RADAR_FAST));
+		ground.meshes[2].visible = false;
+		AnimationTable ground_table {};
+		animation_table_update(ground_table, ground.meshes, AnimationModel::GROUND);
+
+		// 6 seconds in 120Hz steps
+		for (int i = 0; i < 720; i++) {
+			animation_table_radars_spin(ground_table, 1.0f / 120);
+		}
+		mu_test(std::abs(ground.meshes[0].rotation.x - 2 * RADIANS_MAX) < 1e-3f);
+		mu_test(std::abs(ground.meshes[1].rotation.x - 3 * RADIANS_MAX) < 1e-3f);
+		mu_test(ground.meshes[2].rotation.x == 0);
+	}
+}
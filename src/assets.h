@@ -8,6 +8,7 @@
 #include <SDL_image.h>
 
 #include "parser.h"
+#include "textures.h"
 
 struct Face {
 	mu::Vec<uint32_t> vertices_ids;
@@ -245,13 +246,15 @@ struct Mesh {
 	bool render_cnt_axis;
 };
 
-inline void mesh_load_to_gpu(Mesh& self) {
-	struct Stride {
-		glm::vec3 vertex;
-		glm::vec4 color;
-		glm::vec3 normal;
-	};
-	mu::Vec<Stride> buffer(mu::memory::tmp());
+struct MeshVertex {
+	glm::vec3 vertex;
+	glm::vec4 color;
+	glm::vec3 normal;
+};
+
+// vertices of mesh's own faces in mesh space, children not included
+inline mu::Vec<MeshVertex> mesh_vertices(const Mesh& self, mu::memory::Allocator* allocator = mu::memory::tmp()) {
+	mu::Vec<MeshVertex> buffer(allocator);
 	for (const auto& face : self.faces) {
 		auto face_normal = face.normal;
 		// compute from first 3 vertices when SRF file has zero normal
@@ -262,14 +265,18 @@ inline void mesh_load_to_gpu(Mesh& self) {
 			face_normal = glm::normalize(glm::cross(v1 - v0, v2 - v0));
 		}
 		for (size_t i = 0; i < face.vertices_ids.size(); i++) {
-			buffer.push_back(Stride {
+			buffer.push_back(MeshVertex {
 				.vertex=self.vertices[face.vertices_ids[i]],
 				.color=face.color,
 				.normal=face_normal,
 			});
 		}
 	}
-	self.gl_buf = gl_buf_new<glm::vec3, glm::vec4, glm::vec3>(buffer);
+	return buffer;
+}
+
+inline void mesh_load_to_gpu(Mesh& self) {
+	self.gl_buf = gl_buf_new<glm::vec3, glm::vec4, glm::vec3>(mesh_vertices(self));
 
 	for (auto& child : self.children) {
 		mesh_load_to_gpu(child);
@@ -284,8 +291,8 @@ inline void mesh_unload_from_gpu(Mesh& self) {
 	}
 }
 
-inline void meshes_foreach(mu::Vec<Mesh>& meshes, std::function<bool(Mesh&)> f) {
-	mu::Vec<Mesh*> stack(mu::memory::tmp());
+inline void meshes_foreach(mu::Vec<Mesh>& meshes, std::function<bool(Mesh&)> f, mu::memory::Allocator* allocator = mu::memory::tmp()) {
+	mu::Vec<Mesh*> stack(allocator);
 	for (auto& mesh : meshes) {
 		stack.push_back(&mesh);
 	}
@@ -299,8 +306,8 @@ inline void meshes_foreach(mu::Vec<Mesh>& meshes, std::function<bool(Mesh&)> f)
 	}
 }
 
-inline void meshes_foreach(const mu::Vec<Mesh>& meshes, std::function<bool(const Mesh&)> f) {
-	mu::Vec<const Mesh*> stack(mu::memory::tmp());
+inline void meshes_foreach(const mu::Vec<Mesh>& meshes, std::function<bool(const Mesh&)> f, mu::memory::Allocator* allocator = mu::memory::tmp()) {
+	mu::Vec<const Mesh*> stack(allocator);
 	for (const auto& mesh : meshes) {
 		stack.push_back(&mesh);
 	}
@@ -314,6 +321,30 @@ inline void meshes_foreach(const mu::Vec<Mesh>& meshes, std::function<bool(const
 	}
 }
 
+// what `meshes_visit` does after a mesh, STOP is what false is to `meshes_foreach`
+enum class MeshVisit {
+	CHILDREN,      // go on into its children
+	SKIP_CHILDREN, // go on with the rest, not its children
+	STOP,
+};
+
+inline void meshes_visit(const mu::Vec<Mesh>& meshes, std::function<MeshVisit(const Mesh&)> f, mu::memory::Allocator* allocator = mu::memory::tmp()) {
+	mu::Vec<const Mesh*> stack(allocator);
+	for (const auto& mesh : meshes) {
+		stack.push_back(&mesh);
+	}
+	while (stack.empty() == false) {
+		const Mesh& mesh = *stack.back();
+		stack.pop_back();
+		const auto visit = f(mesh);
+		if (visit == MeshVisit::STOP) return;
+		if (visit == MeshVisit::SKIP_CHILDREN) continue;
+		for (auto& child : mesh.children) {
+			stack.push_back(&child);
+		}
+	}
+}
+
 inline AABB aabb_from_meshes(const mu::Vec<Mesh>& meshes) {
 	AABB aabb {
 		.min={+FLT_MAX, +FLT_MAX, +FLT_MAX},
@@ -1125,14 +1156,17 @@ struct TerrMesh {
 	bool visible = true;
 };
 
-inline void terr_mesh_load_to_gpu(TerrMesh& self) {
-	struct Stride {
-		glm::vec3 vertex;
-		glm::vec4 color;
-		glm::vec3 normal;
-		glm::vec2 uv;
-	};
-	mu::Vec<Stride> buffer(mu::memory::tmp());
+struct TerrMeshVertex {
+	glm::vec3 vertex;
+	glm::vec4 color;
+	glm::vec3 normal;
+	glm::vec2 uv;
+};
+
+// triangles of terrain in terrain space (scaled), with face normals and XZ-projected UVs
+inline mu::Vec<TerrMeshVertex> terr_mesh_vertices(const TerrMesh& self, mu::memory::Allocator* allocator = mu::memory::tmp()) {
+	using Stride = TerrMeshVertex;
+	mu::Vec<Stride> buffer(allocator);
 
 	// main triangles
 	for (size_t z = 0; z < self.blocks.size(); z++) {
@@ -1233,7 +1267,11 @@ inline void terr_mesh_load_to_gpu(TerrMesh& self) {
 		}
 	}
 
-	self.gl_buf = gl_buf_new<glm::vec3, glm::vec4, glm::vec3, glm::vec2>(buffer);
+	return buffer;
+}
+
+inline void terr_mesh_load_to_gpu(TerrMesh& self) {
+	self.gl_buf = gl_buf_new<glm::vec3, glm::vec4, glm::vec3, glm::vec2>(terr_mesh_vertices(self));
 }
 
 inline void terr_mesh_unload_from_gpu(TerrMesh& self) {
@@ -1400,8 +1438,9 @@ struct Field {
 	mu::Vec<Mesh> meshes;
 	mu::Vec<GroundObjSpawn> gobs;
 	mu::Vec<FieldGroundPath> ground_paths;
-	mu::Map<mu::Str, uint32_t> textures;
+	mu::Map<mu::Str, TextureHandle> textures;
 
+	// requested from Textures on scenery load, see `scenery_textures_request`
 	struct PendingTexture {
 		mu::Str name;
 		mu::Vec<uint8_t> png_data;
@@ -2223,34 +2262,7 @@ inline Field field_from_fld_file(mu::StrView fld_file_abs_path) {
 	return field;
 }
 
-inline void pending_texture_load_to_gpu(Field& self, Field::PendingTexture& ptex) {
-	auto rw = SDL_RWFromMem(ptex.png_data.data(), (int)ptex.png_data.size());
-	if (auto surface = IMG_Load_RW(rw, 1)) {
-		mu_defer(SDL_FreeSurface(surface));
-
-		GLuint tex_id {};
-		GLenum fmt = surface->format->BytesPerPixel == 3 ? GL_RGB : GL_RGBA;
-
-		glGenTextures(1, &tex_id);
-		glBindTexture(GL_TEXTURE_2D, tex_id);
-			glTexImage2D(GL_TEXTURE_2D, 0, fmt, surface->w, surface->h, 0, fmt, GL_UNSIGNED_BYTE, surface->pixels);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, ptex.filter_min);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, ptex.filter_mag);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		self.textures[ptex.name] = tex_id;
-		mu::log_debug("loaded texture {}", ptex.name);
-	} else {
-		mu::log_warning("failed to decode texture '{}': {}", ptex.name, IMG_GetError());
-	}
-}
-
 inline void field_load_to_gpu(Field& self) {
-	for (auto& ptex : self.pending_textures) {
-		pending_texture_load_to_gpu(self, ptex);
-	}
-	self.pending_textures.clear();
-
 	for (auto& terr_mesh : self.terr_meshes) {
 		terr_mesh_load_to_gpu(terr_mesh);
 	}
@@ -2278,9 +2290,7 @@ inline void field_unload_from_gpu(Field& self) {
 		mesh_unload_from_gpu(mesh);
 	}
 
-	for (auto& [_, tex_id] : self.textures) {
-		glDeleteTextures(1, &tex_id);
-	}
+	// owned by Textures, which is cleared on scenery unload
 	self.textures.clear();
 
 	// recurse
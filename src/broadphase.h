@@ -0,0 +1,252 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+
+#include <mu/utils.h>
+
+#include "math.h"
+
+constexpr uint32_t BROADPHASE_NONE = UINT32_MAX;
+
+// users of two proxies whose AABBs intersect, `a` is always dynamic
+struct BroadphasePair {
+	uint32_t a, b;
+};
+
+struct BroadphaseProxy {
+	AABB aabb;
+	uint32_t user;  // whatever caller wants back in pairs (e.g. index of entity)
+	bool is_static; // never tested against other statics
+	bool alive;
+};
+
+// AABB copy in sweep order, sweeps read these instead of chasing handles
+struct BroadphaseBox {
+	AABB aabb;
+	uint32_t user;
+};
+
+// sweep and prune over x, persistent between frames
+// statics are sorted only when one is added, removed or moved, dynamics barely move between frames
+// so insertion sort keeps them sorted in about linear time
+// pairs: dynamic x dynamic by sweeping dynamics, dynamic x static by binary searching statics
+struct Broadphase {
+	// handle is index, slots of removed proxies are reused
+	mu::Vec<BroadphaseProxy> proxies;
+	mu::Vec<uint32_t> free_handles;
+
+	// handles sorted by aabb.min.x
+	mu::Vec<uint32_t> statics_order, dynamics_order;
+	bool statics_unsorted;
+
+	mu::Vec<BroadphaseBox> statics_sorted, dynamics_sorted;
+	float statics_max_width; // x, how far before a dynamic a static can start and still overlap it
+
+	// result of last broadphase_update
+	mu::Vec<BroadphasePair> pairs;
+};
+
+inline uint32_t broadphase_add(Broadphase& self, const AABB& aabb, uint32_t user, bool is_static) {
+	uint32_t handle;
+	if (self.free_handles.empty() == false) {
+		handle = self.free_handles.back();
+		self.free_handles.pop_back();
+	} else {
+		handle = (uint32_t) self.proxies.size();
+		self.proxies.push_back({});
+	}
+
+	self.proxies[handle] = BroadphaseProxy {
+		.aabb = aabb,
+		.user = user,
+		.is_static = is_static,
+		.alive = true,
+	};
+
+	if (is_static) {
+		self.statics_order.push_back(handle);
+		self.statics_unsorted = true;
+	} else {
+		self.dynamics_order.push_back(handle);
+	}
+
+	return handle;
+}
+
+inline void broadphase_remove(Broadphase& self, uint32_t handle) {
+	auto& proxy = self.proxies[handle];
+	mu_assert(proxy.alive);
+
+	auto& order = proxy.is_static? self.statics_order : self.dynamics_order;
+	order.erase(std::find(order.begin(), order.end(), handle));
+	if (proxy.is_static) {
+		self.statics_unsorted = true;
+	}
+
+	proxy.alive = false;
+	self.free_handles.push_back(handle);
+}
+
+// cheap when nothing changed, statics are only resorted if they actually moved
+inline void broadphase_move(Broadphase& self, uint32_t handle, const AABB& aabb, uint32_t user) {
+	auto& proxy = self.proxies[handle];
+	if (proxy.is_static && (proxy.aabb.min != aabb.min || proxy.aabb.max != aabb.max || proxy.user != user)) {
+		self.statics_unsorted = true;
+	}
+	proxy.aabb = aabb;
+	proxy.user = user;
+}
+
+inline bool _broadphase_overlap_yz(const AABB& a, const AABB& b) {
+	return a.min.y <= b.max.y && b.min.y <= a.max.y && a.min.z <= b.max.z && b.min.z <= a.max.z;
+}
+
+inline void broadphase_update(Broadphase& self) {
+	self.pairs.clear();
+
+	if (self.statics_unsorted) {
+		std::sort(self.statics_order.begin(), self.statics_order.end(), [&](uint32_t a, uint32_t b) {
+			return self.proxies[a].aabb.min.x < self.proxies[b].aabb.min.x;
+		});
+
+		self.statics_sorted.clear();
+		self.statics_max_width = 0;
+		for (uint32_t handle : self.statics_order) {
+			const auto& proxy = self.proxies[handle];
+			self.statics_sorted.push_back(BroadphaseBox { .aabb = proxy.aabb, .user = proxy.user });
+			self.statics_max_width = std::max(self.statics_max_width, proxy.aabb.max.x - proxy.aabb.min.x);
+		}
+
+		self.statics_unsorted = false;
+	}
+
+	// insertion sort, order of last frame is almost right
+	auto& order = self.dynamics_order;
+	for (size_t i = 1; i < order.size(); i++) {
+		const uint32_t handle = order[i];
+		const float min_x = self.proxies[handle].aabb.min.x;
+		size_t j = i;
+		while (j > 0 && self.proxies[order[j-1]].aabb.min.x > min_x) {
+			order[j] = order[j-1];
+			j--;
+		}
+		order[j] = handle;
+	}
+
+	self.dynamics_sorted.clear();
+	for (uint32_t handle : order) {
+		const auto& proxy = self.proxies[handle];
+		self.dynamics_sorted.push_back(BroadphaseBox { .aabb = proxy.aabb, .user = proxy.user });
+	}
+
+	const auto& dynamics = self.dynamics_sorted;
+	const auto& statics = self.statics_sorted;
+	for (size_t i = 0; i < dynamics.size(); i++) {
+		const auto& a = dynamics[i].aabb;
+
+		// dynamics starting inside this one along x
+		for (size_t j = i+1; j < dynamics.size() && dynamics[j].aabb.min.x <= a.max.x; j++) {
+			if (_broadphase_overlap_yz(a, dynamics[j].aabb)) {
+				self.pairs.push_back(BroadphasePair { .a = dynamics[i].user, .b = dynamics[j].user });
+			}
+		}
+
+		// statics starting at most statics_max_width before it, up to its end
+		auto it = std::partition_point(statics.begin(), statics.end(), [&](const BroadphaseBox& s) {
+			return s.aabb.min.x < a.min.x - self.statics_max_width;
+		});
+		for (; it != statics.end() && it->aabb.min.x <= a.max.x; it++) {
+			if (it->aabb.max.x >= a.min.x && _broadphase_overlap_yz(a, it->aabb)) {
+				self.pairs.push_back(BroadphasePair { .a = dynamics[i].user, .b = it->user });
+			}
+		}
+	}
+}
+
+inline void test_broadphase() {
+	mu_test_suite("broadphase");
+
+	// pairs as sorted (min, max) users, to compare with testing every two proxies
+	auto normalized = [](const mu::Vec<BroadphasePair>& pairs) {
+		mu::Vec<uint64_t> keys;
+		for (const auto& pair : pairs) {
+			keys.push_back(uint64_t(std::min(pair.a, pair.b)) << 32 | std::max(pair.a, pair.b));
+		}
+		std::sort(keys.begin(), keys.end());
+		return keys;
+	};
+	auto brute_force = [](const Broadphase& self) {
+		mu::Vec<BroadphasePair> pairs;
+		for (size_t i = 0; i < self.proxies.size(); i++) {
+			for (size_t j = i+1; j < self.proxies.size(); j++) {
+				const auto& a = self.proxies[i];
+				const auto& b = self.proxies[j];
+				if (a.alive && b.alive && (a.is_static == false || b.is_static == false) && aabbs_intersect(a.aabb, b.aabb)) {
+					pairs.push_back(BroadphasePair { .a = a.user, .b = b.user });
+				}
+			}
+		}
+		return pairs;
+	};
+
+	uint32_t random = 7;
+	auto random_float = [&random](float max) {
+		random = random * 1664525u + 1013904223u;
+		return (random >> 8) / float(1 << 24) * max;
+	};
+	auto random_aabb = [&](float extent) {
+		const glm::vec3 min {random_float(100), random_float(100), random_float(100)};
+		return AABB { .min = min, .max = min + glm::vec3{random_float(extent), random_float(extent), random_float(extent)} };
+	};
+
+	Broadphase broadphase {};
+	mu::Vec<uint32_t> handles;
+	for (uint32_t i = 0; i < 300; i++) {
+		// few wide statics, so dynamics start inside them too
+		const bool is_static = i % 3 == 0;
+		handles.push_back(broadphase_add(broadphase, random_aabb(is_static && i % 30 == 0? 60 : 10), i, is_static));
+	}
+
+	{
+		broadphase_update(broadphase);
+		mu_test(broadphase.pairs.empty() == false);
+		mu_test(normalized(broadphase.pairs) == normalized(brute_force(broadphase)));
+	}
+
+	// moving dynamics keeps them sorted, moving a static resorts statics
+	{
+		for (uint32_t i = 0; i < handles.size(); i++) {
+			if (broadphase.proxies[handles[i]].is_static == false || i == 3) {
+				broadphase_move(broadphase, handles[i], random_aabb(10), i);
+			}
+		}
+		broadphase_update(broadphase);
+		mu_test(normalized(broadphase.pairs) == normalized(brute_force(broadphase)));
+	}
+
+	// removed proxies are gone, their handles reused
+	{
+		broadphase_remove(broadphase, handles[0]);
+		broadphase_remove(broadphase, handles[1]);
+		broadphase_update(broadphase);
+		for (const auto& pair : broadphase.pairs) {
+			mu_test(pair.a > 1 && pair.b > 1);
+		}
+		mu_test(normalized(broadphase.pairs) == normalized(brute_force(broadphase)));
+
+		const auto handle = broadphase_add(broadphase, random_aabb(10), 1000, false);
+		mu_test(handle == handles[1]);
+		broadphase_update(broadphase);
+		mu_test(normalized(broadphase.pairs) == normalized(brute_force(broadphase)));
+	}
+
+	// statics never pair with statics
+	{
+		Broadphase statics {};
+		broadphase_add(statics, AABB { .min = {0, 0, 0}, .max = {1, 1, 1} }, 0, true);
+		broadphase_add(statics, AABB { .min = {0, 0, 0}, .max = {1, 1, 1} }, 1, true);
+		broadphase_update(statics);
+		mu_test(statics.pairs.empty());
+	}
+}
@@ -39,13 +39,14 @@ namespace sys {
 		auto dy = self.aircraft->initial_aabb.max.y - self.aircraft->initial_aabb.min.y;
 		auto dist_from_model = self.zoom_multiplier * dy;
 
-		auto model_transformation = local_euler_angles_matrix(aircraft_angles(*self.aircraft), self.aircraft->translation);
+		const auto ang = aircraft_render_angles(*self.aircraft);
+		auto model_transformation = local_euler_angles_matrix(ang, self.aircraft->render_translation);
 		model_transformation = glm::rotate(model_transformation, self.pitch, glm::vec3{0, -1, 0});
 		model_transformation = glm::rotate(model_transformation, self.yaw, glm::vec3{-1, 0, 0});
 		self.position = model_transformation * glm::vec4{0, 0, -dist_from_model, 1};
 
-		self.target_pos = self.aircraft->translation;
-		self.up = aircraft_angles(*self.aircraft).up;
+		self.target_pos = self.aircraft->render_translation;
+		self.up = ang.up;
 	}
 
 	void _camera_update_excamera_mode(World& world) {
@@ -55,8 +56,8 @@ namespace sys {
 		auto& ac = *self.aircraft;
 		auto& excamera = ac.excameras[self.camera_index];
 
-		auto ang = aircraft_angles(ac);
-		self.position = ac.translation + ac.orientation * excamera.pos;
+		auto ang = aircraft_render_angles(ac);
+		self.position = ac.render_translation + ac.render_orientation * excamera.pos;
 		self.front = ang.front;
 		self.target_pos = self.position + self.front;
 		self.up = ang.up;
@@ -66,9 +67,9 @@ namespace sys {
 		DEF_SYSTEM
 
 		auto& ac = *world.camera.aircraft;
-		auto ang = aircraft_angles(ac);
+		auto ang = aircraft_render_angles(ac);
 
-		world.camera.position = ac.translation + ac.orientation * ac.cockpit_pos;
+		world.camera.position = ac.render_translation + ac.render_orientation * ac.cockpit_pos;
 		world.camera.front = ang.front;
 		world.camera.target_pos = world.camera.position + world.camera.front;
 		world.camera.up = ang.up;
@@ -82,8 +83,8 @@ namespace sys {
 		auto& pos = self.tower_viewpoints[self.camera_index];
 
 		self.position = pos;
-		self.front = glm::normalize(ac.translation - pos);
-		self.target_pos = ac.translation;
+		self.front = glm::normalize(ac.render_translation - pos);
+		self.target_pos = ac.render_translation;
 		self.up = self.world_up;
 	}
 
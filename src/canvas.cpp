@@ -8,6 +8,74 @@
 
 #include "world.h"
 
+// uses meshes program variant that has `features`, does nothing if it's already in use
+// other programs may have been used in between, so systems reset `meshes.program` before first call
+// variants are separate programs, so uniforms shared by all draws are set again on switch
+// returns true if program changed, caller must set its per draw uniforms again
+static bool _canvas_meshes_program_use(World& world, uint32_t features) {
+	auto& self = world.canvas.meshes;
+
+	const auto& program = gl_program_variants_get(self.program_variants, features);
+	if (program.id == self.program.id && features == self.program_features) {
+		return false;
+	}
+	self.program = program;
+	self.program_features = features;
+
+	gl_program_use(self.program);
+	gl_program_variants_features_set(self.program_variants, self.program, features);
+
+	// normalize CPU-side once per frame instead of per-fragment
+	auto light_dir = world.settings.rendering.light_dir;
+	float len = glm::length(light_dir);
+	gl_program_uniform_set(self.program, "light_dir",
+		len > 0.0001f ? light_dir / len : light_dir);
+	gl_program_uniform_set(self.program, "ambient_color",
+		world.settings.rendering.ambient_color);
+
+	// fog
+	gl_program_uniform_set(self.program, "fog_density",
+		world.settings.rendering.fog_density);
+	gl_program_uniform_set(self.program, "fog_color",
+		world.settings.rendering.fog_color);
+
+	// texture arrays on unit 1, see _canvas_texture_array_bind
+	gl_program_uniform_set(self.program, "terrain_tex", 1);
+
+	return true;
+}
+
+// same as _canvas_meshes_program_use but for gnd_pics program
+static bool _canvas_gnd_pics_program_use(World& world, uint32_t features) {
+	auto& self = world.canvas.gnd_pics;
+
+	const auto& program = gl_program_variants_get(self.program_variants, features);
+	if (program.id == self.program.id && features == self.program_features) {
+		return false;
+	}
+	self.program = program;
+	self.program_features = features;
+
+	gl_program_use(self.program);
+	gl_program_variants_features_set(self.program_variants, self.program, features);
+
+	// fog
+	gl_program_uniform_set(self.program, "fog_density",
+		world.settings.rendering.fog_density);
+	gl_program_uniform_set(self.program, "fog_color",
+		world.settings.rendering.fog_color);
+
+	gl_program_uniform_set(self.program, "groundtile", 0);
+	gl_program_uniform_set(self.program, "terrain_tex", 1);
+
+	return true;
+}
+
+// terrain textures live on unit 1, so they never replace ground tile or glyphs on unit 0
+static void _canvas_texture_array_bind(GLuint texture_array) {
+	gl_state_bind_texture(1, GL_TEXTURE_2D_ARRAY, texture_array);
+}
+
 namespace sys {
 
 	void canvas_init(World& world) {
@@ -15,16 +83,25 @@ namespace sys {
 
 		auto& self = world.canvas;
 
+		// imgui and asset loading may have touched GL before us
+		gl_state_invalidate();
+
 		signal_listen(world.signals.wnd_configs_changed);
 
-		self.meshes.program = gl_program_new(
+		for (auto& frame : self.frames) {
+			canvas_frame_clear(frame);
+		}
+
+		// HAS_* are defined by program variants, see canvas::MeshFeature
+		self.meshes.program_variants = gl_program_variants_new(
 			// vertex shader
 			R"GLSL(
 				#version 330 core
 				layout (location = 0) in vec3 attr_position;
 				layout (location = 1) in vec4 attr_color;
 				layout (location = 2) in vec3 attr_normal;
-				layout (location = 3) in vec2 attr_uv;
+				// z is layer in texture array, only baked batches set it, others get default 0
+				layout (location = 3) in vec3 attr_uv;
 
 				uniform mat4 projection_view_model;
 				uniform mat3 model_normal;
@@ -33,7 +110,7 @@ namespace sys {
 				out vec4 vs_color;
 				out vec3 vs_normal;
 				out float vs_depth;
-				out vec2 vs_uv;
+				out vec3 vs_uv;
 
 				void main() {
 					gl_Position = projection_view_model * vec4(attr_position, 1.0);
@@ -52,7 +129,7 @@ namespace sys {
 				in vec4 vs_color;
 				in vec3 vs_normal;
 				in float vs_depth;
-				in vec2 vs_uv;
+				in vec3 vs_uv;
 
 				out vec4 out_fragcolor;
 
@@ -69,7 +146,8 @@ namespace sys {
 				uniform vec3 fog_color;
 
 				uniform bool tex_enabled;
-				uniform sampler2D terrain_tex;
+				uniform sampler2DArray terrain_tex;
+				uniform float tex_layer;
 
 				void main() {
 					if (vs_color.a == 0) {
@@ -77,32 +155,39 @@ namespace sys {
 					}
 
 					vec4 base_color;
-					if (gradient_enabled) {
+					if (HAS_GRADIENT) {
 						float alpha = (vs_vertex_y - gradient_bottom_y) / (gradient_top_y - gradient_bottom_y);
 						base_color = vec4(mix(gradient_bottom_color, gradient_top_color, alpha), 1.0f);
 					} else {
 						base_color = vs_color;
 					}
 
-					if (tex_enabled) {
-						base_color *= texture(terrain_tex, vs_uv);
+					if (HAS_TEXTURE) {
+						base_color *= texture(terrain_tex, vec3(vs_uv.xy, vs_uv.z + tex_layer));
 					}
 
 				// dot(light_dir) > 0 avoids normalize(0) undefined when user drags all axes to zero via UI
-				if (lighting_enabled && dot(light_dir, light_dir) > 0.0) {
+				if (HAS_LIGHTING && dot(light_dir, light_dir) > 0.0) {
 					float diff = max(dot(vs_normal, normalize(light_dir)), 0.0);
 					out_fragcolor = base_color * vec4(ambient_color + diff, 1.0);
 				} else {
 					out_fragcolor = base_color;
 				}
 
-				if (fog_enabled) {
+				if (HAS_FOG) {
 					float d = vs_depth * fog_density;
 					float fog_factor = exp(-d * d);
 					out_fragcolor = mix(vec4(fog_color, 1.0), out_fragcolor, fog_factor);
 				}
 				}
-			)GLSL"
+			)GLSL",
+
+			{
+				{"HAS_GRADIENT", "gradient_enabled"},
+				{"HAS_TEXTURE",  "tex_enabled"},
+				{"HAS_LIGHTING", "lighting_enabled"},
+				{"HAS_FOG",      "fog_enabled"},
+			}
 		);
 
 		{
@@ -120,7 +205,8 @@ namespace sys {
 			});
 		}
 
-		self.gnd_pics.program = gl_program_new(
+		// HAS_* are defined by program variants, see canvas::GndPicFeature
+		self.gnd_pics.program_variants = gl_program_variants_new(
 			// vertex shader
 			R"GLSL(
 				#version 330 core
@@ -154,7 +240,8 @@ namespace sys {
 				uniform sampler2D groundtile;
 
 				uniform bool tex_enabled;
-				uniform sampler2D terrain_tex;
+				uniform sampler2DArray terrain_tex;
+				uniform float tex_layer;
 
 				uniform bool fog_enabled;
 				uniform float fog_density;
@@ -173,22 +260,31 @@ namespace sys {
 
 				void main() {
 					int color_index = 0;
-					if (gradient_enabled) {
+					if (HAS_GRADIENT) {
 						color_index = color_indices[int(vs_vertex_id)];
 					}
-					vec2 tc = tex_enabled ? vs_uv : default_tex_coords[int(vs_vertex_id) % 3];
-					vec4 base = texture(groundtile, tc).r * vec4(primitive_color[color_index], 1.0);
-					if (tex_enabled) {
-						base *= texture(terrain_tex, vs_uv);
+					vec4 base;
+					if (HAS_TEXTURE) {
+						// texture used to be bound in ground tile's place too, keep modulating by its red channel
+						vec4 tex = texture(terrain_tex, vec3(vs_uv, tex_layer));
+						base = tex.r * vec4(primitive_color[color_index], 1.0) * tex;
+					} else {
+						base = texture(groundtile, default_tex_coords[int(vs_vertex_id) % 3]).r * vec4(primitive_color[color_index], 1.0);
 					}
 					out_fragcolor = base;
-					if (fog_enabled) {
+					if (HAS_FOG) {
 						float d = vs_depth * fog_density;
 						float fog_factor = exp(-d * d);
 						out_fragcolor = mix(vec4(fog_color, 1.0), out_fragcolor, fog_factor);
 					}
 				}
-			)GLSL"
+			)GLSL",
+
+			{
+				{"HAS_GRADIENT", "gradient_enabled"},
+				{"HAS_TEXTURE",  "tex_enabled"},
+				{"HAS_FOG",      "fog_enabled"},
+			}
 		);
 
 		// https://asliceofrendering.com/scene%20helper/2020/01/05/InfiniteGrid/
@@ -261,7 +357,7 @@ namespace sys {
 			mu::panic("failed to load groundtile.png");
 		}
 		glGenTextures(1, &self.ground.tile_texture);
-		glBindTexture(GL_TEXTURE_2D, self.ground.tile_texture);
+		gl_state_bind_texture(0, GL_TEXTURE_2D, self.ground.tile_texture);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, self.ground.tile_surface->w, self.ground.tile_surface->h, 0, GL_RED, GL_UNSIGNED_BYTE, self.ground.tile_surface->pixels);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -323,7 +419,7 @@ namespace sys {
 			mu::panic("failed to load rwlight.png");
 		}
 		glGenTextures(1, &self.zlpoints.sprite_texture);
-		glBindTexture(GL_TEXTURE_2D, self.zlpoints.sprite_texture);
+		gl_state_bind_texture(0, GL_TEXTURE_2D, self.zlpoints.sprite_texture);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, self.zlpoints.sprite_surface->w, self.zlpoints.sprite_surface->h, 0, GL_RED, GL_UNSIGNED_INT, self.zlpoints.sprite_surface->pixels);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
@@ -399,7 +495,7 @@ namespace sys {
 
 			GLuint text_texture;
 			glGenTextures(1, &text_texture);
-			glBindTexture(GL_TEXTURE_2D, text_texture);
+			gl_state_bind_texture(0, GL_TEXTURE_2D, text_texture);
 			glTexImage2D(
 				GL_TEXTURE_2D,
 				0,
@@ -455,7 +551,9 @@ namespace sys {
 			)GLSL"
 		);
 
-		self.lines.gl_buf = gl_buf_new_dyn<glm::vec4, glm::vec4>(100);
+		self.stream = gl_stream_buf_new(1 << 20);
+
+		self.lines.vao = gl_stream_buf_vao_new<glm::vec4, glm::vec4>(self.stream);
 
 		// hud geoms
 		self.hud_geoms.program = gl_program_new(
@@ -483,7 +581,7 @@ namespace sys {
 				}
 			)GLSL"
 		);
-		self.hud_geoms.gl_buf = gl_buf_new_dyn<glm::vec2, glm::vec4>(512);
+		self.hud_geoms.vao = gl_stream_buf_vao_new<glm::vec2, glm::vec4>(self.stream);
 
 		gl_process_errors();
 	}
@@ -493,9 +591,9 @@ namespace sys {
 
 		auto& self = world.canvas;
 
-		glUseProgram(0);
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		gl_state_use_program(0);
+		gl_state_bind_vertex_array(0);
+		gl_state_bind_texture(0, GL_TEXTURE_2D, 0);
 
 		// text
 		gl_program_free(self.text.program);
@@ -521,14 +619,16 @@ namespace sys {
 
 		// lines
 		gl_program_free(self.lines.program);
-		gl_buf_free(self.lines.gl_buf);
+		glDeleteVertexArrays(1, &self.lines.vao);
 
 		// hud geoms
 		gl_program_free(self.hud_geoms.program);
-		gl_buf_free(self.hud_geoms.gl_buf);
+		glDeleteVertexArrays(1, &self.hud_geoms.vao);
+
+		gl_stream_buf_free(self.stream);
 
-		gl_program_free(self.meshes.program);
-		gl_program_free(self.gnd_pics.program);
+		gl_program_variants_free(self.meshes.program_variants);
+		gl_program_variants_free(self.gnd_pics.program_variants);
 	}
 
 	void canvas_rendering_begin(World& world) {
@@ -536,13 +636,15 @@ namespace sys {
 
 		auto& self = world.canvas;
 
+		gl_state_frame_begin();
+
 		if (signal_handle(world.signals.wnd_configs_changed)) {
 			int w, h;
 			SDL_GL_GetDrawableSize(world.sdl_window, &w, &h);
 			glViewport(0, 0, w, h);
 		}
 
-		glEnable(GL_DEPTH_TEST);
+		gl_state_capability_set(GL_DEPTH_TEST, true);
 		glClearDepth(1);
 		glm::vec3 clear_color = world.scenery.root_fld.sky_color;
 		if (world.settings.rendering.fog_enabled) {
@@ -551,19 +653,27 @@ namespace sys {
 		glClearColor(clear_color.x, clear_color.y, clear_color.z, 0.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		glEnable(GL_BLEND);
+		gl_state_capability_set(GL_BLEND, true);
 		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		if (world.settings.rendering.smooth_lines) {
-			glEnable(GL_LINE_SMOOTH);
+			gl_state_capability_set(GL_LINE_SMOOTH, true);
 			#ifndef OS_MACOS
-			glLineWidth(world.settings.rendering.line_width);
+			gl_state_line_width(world.settings.rendering.line_width);
 			#endif
 		} else {
-			glDisable(GL_LINE_SMOOTH);
+			gl_state_capability_set(GL_LINE_SMOOTH, false);
 		}
-		glPointSize(world.settings.rendering.point_size);
+		gl_state_point_size(world.settings.rendering.point_size);
 		glPolygonMode(GL_FRONT_AND_BACK, world.settings.rendering.polygon_mode);
+
+		gl_stream_buf_frame_begin(self.stream);
+
+		// recorded by simulation, which is already recording the next one, so passes take camera from the frame too
+		canvas_merge(self, canvas_frame_drawing(self));
+
+		self.meshes.program_variants.uber = world.settings.rendering.uber_shaders;
+		self.gnd_pics.program_variants.uber = world.settings.rendering.uber_shaders;
 	}
 
 	void canvas_rendering_end(World& world) {
@@ -571,7 +681,10 @@ namespace sys {
 
 		auto& self = world.canvas;
 
-		SDL_GL_SwapWindow(world.sdl_window);
+		// headless renders into its own framebuffer, there is nothing to present
+		if (world.headless.enabled == false) {
+			SDL_GL_SwapWindow(world.sdl_window);
+		}
 		gl_process_errors();
 
 		self.arena = {};
@@ -581,6 +694,7 @@ namespace sys {
 		self.zlpoints.list         = mu::Vec<canvas::ZLPoint>(&self.arena);
 		self.lines.list            = mu::Vec<canvas::Line>(&self.arena);
 		self.meshes.list_regular   = mu::Vec<canvas::Mesh>(&self.arena);
+		self.meshes.list_batches   = mu::Vec<canvas::MeshBatch>(&self.arena);
 		self.meshes.list_gradient  = mu::Vec<canvas::GradientMesh>(&self.arena);
 		self.meshes.list_cockpit   = mu::Vec<canvas::Cockpit>(&self.arena);
 		self.gnd_pics.list         = mu::Vec<canvas::GndPic>(&self.arena);
@@ -589,160 +703,171 @@ namespace sys {
 		self.hud_geoms.list_line_strips      = mu::Vec<canvas::hud::LineStrip>(&self.arena);
 		self.hud_geoms.list_filled_arcs      = mu::Vec<canvas::hud::FilledArc>(&self.arena);
 		self.hud_geoms.list_filled_triangles = mu::Vec<canvas::hud::FilledTriangle>(&self.arena);
+
+		canvas_frame_clear(canvas_frame_drawing(self));
 	}
 
 	void canvas_render_zlpoints(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
+
+		const auto& frame = canvas_frame_drawing(world.canvas);
 
 		if (world.canvas.zlpoints.list.empty()) {
 			return;
 		}
 
-		auto model_transformation = glm::mat4(glm::mat3(world.mats.view_inverse)) * glm::scale(glm::vec3{ZL_SCALE, ZL_SCALE, 0});
+		auto model_transformation = glm::mat4(glm::mat3(frame.mats.view_inverse)) * glm::scale(glm::vec3{ZL_SCALE, ZL_SCALE, 0});
 
 		gl_program_use(world.canvas.zlpoints.program);
-		glBindTexture(GL_TEXTURE_2D, world.canvas.zlpoints.sprite_texture);
-		glBindVertexArray(world.canvas.zlpoints.gl_buf.vao);
+		gl_state_bind_texture(0, GL_TEXTURE_2D, world.canvas.zlpoints.sprite_texture);
+		gl_state_bind_vertex_array(world.canvas.zlpoints.gl_buf.vao);
 
 		for (const auto& zlpoint : world.canvas.zlpoints.list) {
 			model_transformation[3] = glm::vec4{zlpoint.center.x, zlpoint.center.y, zlpoint.center.z, 1.0f};
 			gl_program_uniform_set(world.canvas.zlpoints.program, "color", zlpoint.color);
-			gl_program_uniform_set(world.canvas.zlpoints.program, "projection_view_model", world.mats.projection_view * model_transformation);
+			gl_program_uniform_set(world.canvas.zlpoints.program, "projection_view_model", frame.mats.projection_view * model_transformation);
 			glDrawArrays(GL_TRIANGLES, 0, world.canvas.zlpoints.gl_buf.len);
 		}
 	}
 
 	void canvas_render_meshes(World& world) {
-		DEF_SYSTEM
-
-		gl_program_use(world.canvas.meshes.program);
+		DEF_GPU_SYSTEM
 
-		// normalize CPU-side once per frame instead of per-fragment
-		auto light_dir = world.settings.rendering.light_dir;
-		float len = glm::length(light_dir);
-		gl_program_uniform_set(world.canvas.meshes.program, "light_dir",
-			len > 0.0001f ? light_dir / len : light_dir);
-		gl_program_uniform_set(world.canvas.meshes.program, "ambient_color",
-			world.settings.rendering.ambient_color);
-		gl_program_uniform_set(world.canvas.meshes.program, "lighting_enabled",
-			world.settings.rendering.lighting);
-
-		// fog
-		gl_program_uniform_set(world.canvas.meshes.program, "fog_enabled",
-			world.settings.rendering.fog_enabled);
-		gl_program_uniform_set(world.canvas.meshes.program, "fog_density",
-			world.settings.rendering.fog_density);
-		gl_program_uniform_set(world.canvas.meshes.program, "fog_color",
-			world.settings.rendering.fog_color);
+		auto& self = world.canvas.meshes;
+		self.program = {};
 
-		// texture sampler on unit 0
-		gl_program_uniform_set(world.canvas.meshes.program, "terrain_tex", 0);
-		gl_program_uniform_set(world.canvas.meshes.program, "tex_enabled", false);
+		uint32_t frame_features = 0;
+		if (world.settings.rendering.lighting) {
+			frame_features |= canvas::MESH_FEATURE_LIGHTING;
+		}
+		if (world.settings.rendering.fog_enabled) {
+			frame_features |= canvas::MESH_FEATURE_FOG;
+		}
 
 		// regular
-		for (const auto& mesh : world.canvas.meshes.list_regular) {
-			gl_program_uniform_set(world.canvas.meshes.program, "projection_view_model", mesh.projection_view_model);
-			gl_program_uniform_set(world.canvas.meshes.program, "model_normal", mesh.model_normal);
+		for (const auto& mesh : self.list_regular) {
+			_canvas_meshes_program_use(world, frame_features | (mesh.tex_enabled? canvas::MESH_FEATURE_TEXTURE : 0));
+
+			gl_program_uniform_set(self.program, "projection_view_model", mesh.projection_view_model);
+			gl_program_uniform_set(self.program, "model_normal", mesh.model_normal);
 
-			gl_program_uniform_set(world.canvas.meshes.program, "tex_enabled", mesh.tex_enabled);
 			if (mesh.tex_enabled) {
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, mesh.texture_id);
+				_canvas_texture_array_bind(mesh.texture_id);
+				gl_program_uniform_set(self.program, "tex_layer", float(mesh.texture_layer));
 			}
 
-			glBindVertexArray(mesh.vao);
+			gl_state_bind_vertex_array(mesh.vao);
 			glDrawArrays(world.settings.rendering.primitives_type, 0, mesh.buf_len);
 		}
 
-		// gradient
-		if (world.canvas.meshes.list_gradient.size() > 0) {
-			gl_program_uniform_set(world.canvas.meshes.program, "gradient_enabled", true);
-			for (const auto& mesh : world.canvas.meshes.list_gradient) {
-				gl_program_uniform_set(world.canvas.meshes.program, "projection_view_model", mesh.projection_view_model);
-				gl_program_uniform_set(world.canvas.meshes.program, "model_normal", mesh.model_normal);
-
-				gl_program_uniform_set(world.canvas.meshes.program, "gradient_bottom_y", mesh.gradient_bottom_y);
-				gl_program_uniform_set(world.canvas.meshes.program, "gradient_top_y", mesh.gradient_top_y);
-				gl_program_uniform_set(world.canvas.meshes.program, "gradient_bottom_color", mesh.gradient_bottom_color);
-				gl_program_uniform_set(world.canvas.meshes.program, "gradient_top_color", mesh.gradient_top_color);
-
-				glBindVertexArray(mesh.vao);
-				glDrawArrays(world.settings.rendering.primitives_type, 0, mesh.buf_len);
+		// batches, vertices are already in world space
+		for (const auto& batch : self.list_batches) {
+			_canvas_meshes_program_use(world, frame_features | (batch.tex_enabled? canvas::MESH_FEATURE_TEXTURE : 0));
+
+			gl_program_uniform_set(self.program, "projection_view_model", batch.projection_view);
+			gl_program_uniform_set(self.program, "model_normal", glm::identity<glm::mat3>());
+
+			// layers are baked in vertices uv.z
+			if (batch.tex_enabled) {
+				_canvas_texture_array_bind(batch.texture_id);
+				gl_program_uniform_set(self.program, "tex_layer", 0.0f);
 			}
-			gl_program_uniform_set(world.canvas.meshes.program, "gradient_enabled", false);
+
+			gl_state_bind_vertex_array(batch.vao);
+			glMultiDrawArrays(world.settings.rendering.primitives_type, batch.firsts.data(), batch.counts.data(), batch.counts.size());
 		}
 
-		glDisable(GL_CULL_FACE);
-		for (const auto& cockpit : world.canvas.meshes.list_cockpit) {
-			gl_program_uniform_set(world.canvas.meshes.program, "projection_view_model", cockpit.projection_view_model);
-			gl_program_uniform_set(world.canvas.meshes.program, "model_normal", cockpit.model_normal);
-			glBindVertexArray(cockpit.vao);
+		// gradient
+		for (const auto& mesh : self.list_gradient) {
+			_canvas_meshes_program_use(world, frame_features | canvas::MESH_FEATURE_GRADIENT);
+
+			gl_program_uniform_set(self.program, "projection_view_model", mesh.projection_view_model);
+			gl_program_uniform_set(self.program, "model_normal", mesh.model_normal);
+
+			gl_program_uniform_set(self.program, "gradient_bottom_y", mesh.gradient_bottom_y);
+			gl_program_uniform_set(self.program, "gradient_top_y", mesh.gradient_top_y);
+			gl_program_uniform_set(self.program, "gradient_bottom_color", mesh.gradient_bottom_color);
+			gl_program_uniform_set(self.program, "gradient_top_color", mesh.gradient_top_color);
+
+			gl_state_bind_vertex_array(mesh.vao);
+			glDrawArrays(world.settings.rendering.primitives_type, 0, mesh.buf_len);
+		}
+
+		gl_state_capability_set(GL_CULL_FACE, false);
+		for (const auto& cockpit : self.list_cockpit) {
+			_canvas_meshes_program_use(world, frame_features);
+
+			gl_program_uniform_set(self.program, "projection_view_model", cockpit.projection_view_model);
+			gl_program_uniform_set(self.program, "model_normal", cockpit.model_normal);
+			gl_state_bind_vertex_array(cockpit.vao);
 			glDrawArrays(world.settings.rendering.primitives_type, 0, cockpit.buf_len);
 		}
-		glEnable(GL_CULL_FACE);
+		gl_state_capability_set(GL_CULL_FACE, true);
 	}
 
 	void canvas_render_axes(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
+
+		const auto& frame = canvas_frame_drawing(world.canvas);
 
 		if (world.canvas.axes.list.empty() == false) {
-			gl_program_use(world.canvas.meshes.program);
-			gl_program_uniform_set(world.canvas.meshes.program, "lighting_enabled", false);
-			gl_program_uniform_set(world.canvas.meshes.program, "fog_enabled", false);
-			glEnable(GL_LINE_SMOOTH);
+			world.canvas.meshes.program = {};
+			_canvas_meshes_program_use(world, 0);
+			gl_state_capability_set(GL_LINE_SMOOTH, true);
 			#ifndef OS_MACOS
-			glLineWidth(world.canvas.axes.line_width);
+			gl_state_line_width(world.canvas.axes.line_width);
 			#endif
-			glBindVertexArray(world.canvas.axes.gl_buf.vao);
+			gl_state_bind_vertex_array(world.canvas.axes.gl_buf.vao);
 
 			if (world.canvas.axes.on_top) {
-				glDisable(GL_DEPTH_TEST);
+				gl_state_capability_set(GL_DEPTH_TEST, false);
 			}
 
 			for (const auto& axis : world.canvas.axes.list) {
-				gl_program_uniform_set(world.canvas.meshes.program, "projection_view_model", world.mats.projection_view * axis.transformation);
+				gl_program_uniform_set(world.canvas.meshes.program, "projection_view_model", frame.mats.projection_view * axis.transformation);
 				glDrawArrays(GL_LINES, 0, world.canvas.axes.gl_buf.len);
 			}
 
-			glEnable(GL_DEPTH_TEST);
+			gl_state_capability_set(GL_DEPTH_TEST, true);
 		}
 
 		if (world.settings.world_axis.enabled) {
-			gl_program_use(world.canvas.meshes.program);
-			gl_program_uniform_set(world.canvas.meshes.program, "lighting_enabled", false);
-			gl_program_uniform_set(world.canvas.meshes.program, "fog_enabled", false);
-			glEnable(GL_LINE_SMOOTH);
+			world.canvas.meshes.program = {};
+			_canvas_meshes_program_use(world, 0);
+			gl_state_capability_set(GL_LINE_SMOOTH, true);
 			#ifndef OS_MACOS
-			glLineWidth(world.canvas.axes.line_width);
+			gl_state_line_width(world.canvas.axes.line_width);
 			#endif
-			glBindVertexArray(world.canvas.axes.gl_buf.vao);
+			gl_state_bind_vertex_array(world.canvas.axes.gl_buf.vao);
 
 			float camera_z = 1 - world.settings.world_axis.scale; // invert scale because it's camera moving away
 			camera_z *= -40; // arbitrary multiplier
 			camera_z -= 1; // keep a fixed distance or axis will vanish
-			auto new_view_mat = world.mats.view;
+			auto new_view_mat = frame.mats.view;
 			new_view_mat[3] = glm::vec4{0, 0, camera_z, 1}; // scale is a camera zoom out in z
 
 			auto translate = glm::translate(glm::identity<glm::mat4>(), glm::vec3{world.settings.world_axis.position.x, world.settings.world_axis.position.y, 0});
 
-			gl_program_uniform_set(world.canvas.meshes.program, "projection_view_model", translate * world.mats.projection * new_view_mat);
+			gl_program_uniform_set(world.canvas.meshes.program, "projection_view_model", translate * frame.mats.projection * new_view_mat);
 			glDrawArrays(GL_LINES, 0, world.canvas.axes.gl_buf.len);
 		}
 	}
 
 	void canvas_render_text(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
+
+		const auto& frame = canvas_frame_drawing(world.canvas);
 
 		gl_program_use(world.canvas.text.program);
-		glBindVertexArray(world.canvas.text.gl_buf.vao);
+		gl_state_bind_vertex_array(world.canvas.text.gl_buf.vao);
 		glBindBuffer(GL_ARRAY_BUFFER, world.canvas.text.gl_buf.vbo);
 
 		for (auto& txt_rndr : world.canvas.text.list_world) {
 			gl_program_uniform_set(world.canvas.text.program, "text_color", txt_rndr.color);
 
-			auto model_transformation = glm::mat4(glm::mat3(world.mats.view_inverse));
+			auto model_transformation = glm::mat4(glm::mat3(frame.mats.view_inverse));
 			model_transformation[3] = glm::vec4{txt_rndr.p.x, txt_rndr.p.y, txt_rndr.p.z, 1.0f};
-			gl_program_uniform_set(world.canvas.text.program, "projection_view", world.mats.projection_view * model_transformation);
+			gl_program_uniform_set(world.canvas.text.program, "projection_view", frame.mats.projection_view * model_transformation);
 			txt_rndr.p = {};
 
 			for (char c : txt_rndr.text) {
@@ -773,7 +898,7 @@ namespace sys {
 				glBufferSubData(GL_ARRAY_BUFFER, 0, buffer.size() * sizeof(Stride), buffer.data());
 
 				// render glyph texture over quad
-				glBindTexture(GL_TEXTURE_2D, glyph.texture);
+				gl_state_bind_texture(0, GL_TEXTURE_2D, glyph.texture);
 				glDrawArrays(GL_TRIANGLES, 0, 6);
 
 				// now advance cursors for next glyph (note that advance is number of 1/64 pixels)
@@ -784,7 +909,7 @@ namespace sys {
 	}
 
 	void canvas_render_hud_text(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
 
 		gl_program_use(world.canvas.text.program);
 
@@ -792,7 +917,7 @@ namespace sys {
 		SDL_GL_GetDrawableSize(world.sdl_window, &wnd_width, &wnd_height);
 		gl_program_uniform_set(world.canvas.text.program, "projection_view", glm::ortho(0.0f, float(wnd_width), 0.0f, float(wnd_height)));
 
-		glBindVertexArray(world.canvas.text.gl_buf.vao);
+		gl_state_bind_vertex_array(world.canvas.text.gl_buf.vao);
 		glBindBuffer(GL_ARRAY_BUFFER, world.canvas.text.gl_buf.vbo);
 
 		for (auto& txt_rndr : world.canvas.text.list_hud) {
@@ -829,7 +954,7 @@ namespace sys {
 				glBufferSubData(GL_ARRAY_BUFFER, 0, buffer.size() * sizeof(Stride), buffer.data());
 
 				// render glyph texture over quad
-				glBindTexture(GL_TEXTURE_2D, glyph.texture);
+				gl_state_bind_texture(0, GL_TEXTURE_2D, glyph.texture);
 				glDrawArrays(GL_TRIANGLES, 0, 6);
 
 				// now advance cursors for next glyph (note that advance is number of 1/64 pixels)
@@ -840,7 +965,7 @@ namespace sys {
 	}
 
 	void canvas_render_hud_geoms(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
 
 		auto& self = world.canvas.hud_geoms;
 
@@ -857,103 +982,85 @@ namespace sys {
 		int wnd_width, wnd_height;
 		SDL_GL_GetDrawableSize(world.sdl_window, &wnd_width, &wnd_height);
 
-		gl_program_use(self.program);
-		gl_program_uniform_set(self.program, "projection_view",
-			glm::ortho(0.0f, float(wnd_width), 0.0f, float(wnd_height)));
-
-		glDisable(GL_CULL_FACE);
-		glBindVertexArray(self.gl_buf.vao);
-		glBindBuffer(GL_ARRAY_BUFFER, self.gl_buf.vbo);
-
 		constexpr float PI = 3.14159265f;
 		constexpr int SEGMENTS = 40;
 
+		// everything goes into two batches, outlines first then filled shapes on top of them
+		mu::Vec<Stride> lines(mu::memory::tmp());
+		mu::Vec<Stride> triangles(mu::memory::tmp());
+
 		for (auto& c : self.list_circles) {
-			mu::Vec<Stride> verts(mu::memory::tmp());
-			float cx = c.center.x * wnd_width;
-			float cy = c.center.y * wnd_height;
-			float r = c.radius * wnd_width;
-			for (int i = 0; i <= SEGMENTS; i++) {
-				float a = (float(i) / SEGMENTS) * 2.0f * PI;
-				verts.push_back(Stride{
-					.pos = glm::vec2{cx + r * cosf(a), cy + r * sinf(a)},
-					.color = c.color
-				});
-			}
-			size_t cnt = verts.size();
-			size_t buf_cap = self.gl_buf.len;
-			for (size_t i = 0; i < cnt; i += buf_cap) {
-				size_t n = std::min(buf_cap, cnt - i);
-				glBufferSubData(GL_ARRAY_BUFFER, 0, n * sizeof(Stride), verts.data() + i);
-				glDrawArrays(GL_LINE_STRIP, 0, n);
+			const float cx = c.center.x * wnd_width;
+			const float cy = c.center.y * wnd_height;
+			const float r = c.radius * wnd_width;
+			glm::vec2 prev {cx + r, cy};
+			for (int i = 1; i <= SEGMENTS; i++) {
+				const float a = (float(i) / SEGMENTS) * 2.0f * PI;
+				const glm::vec2 p {cx + r * cosf(a), cy + r * sinf(a)};
+				lines.push_back(Stride{.pos = prev, .color = c.color});
+				lines.push_back(Stride{.pos = p,    .color = c.color});
+				prev = p;
 			}
 		}
 
 		for (auto& l : self.list_lines) {
-			Stride verts[2] = {
-				{.pos = {l.p0.x * wnd_width, l.p0.y * wnd_height}, .color = l.color},
-				{.pos = {l.p1.x * wnd_width, l.p1.y * wnd_height}, .color = l.color},
-			};
-			glBufferSubData(GL_ARRAY_BUFFER, 0, 2 * sizeof(Stride), verts);
-			glDrawArrays(GL_LINES, 0, 2);
+			lines.push_back(Stride{.pos = {l.p0.x * wnd_width, l.p0.y * wnd_height}, .color = l.color});
+			lines.push_back(Stride{.pos = {l.p1.x * wnd_width, l.p1.y * wnd_height}, .color = l.color});
 		}
 
 		for (auto& l : self.list_line_strips) {
-			mu::Vec<Stride> verts(mu::memory::tmp());
-			for (auto& p : l.points) {
-				verts.push_back(Stride{
-					.pos = {p.x * wnd_width, p.y * wnd_height},
-					.color = l.color
-				});
-			}
-			if (verts.empty()) continue;
-			size_t cnt = verts.size();
-			size_t buf_cap = self.gl_buf.len;
-			for (size_t i = 0; i < cnt; i += buf_cap) {
-				size_t n = std::min(buf_cap, cnt - i);
-				glBufferSubData(GL_ARRAY_BUFFER, 0, n * sizeof(Stride), verts.data() + i);
-				glDrawArrays(GL_LINE_STRIP, 0, n);
+			for (size_t i = 1; i < l.points.size(); i++) {
+				const auto& p0 = l.points[i-1];
+				const auto& p1 = l.points[i];
+				lines.push_back(Stride{.pos = {p0.x * wnd_width, p0.y * wnd_height}, .color = l.color});
+				lines.push_back(Stride{.pos = {p1.x * wnd_width, p1.y * wnd_height}, .color = l.color});
 			}
 		}
 
 		for (auto& a : self.list_filled_arcs) {
-			mu::Vec<Stride> verts(mu::memory::tmp());
-			float cx = a.center.x * wnd_width;
-			float cy = a.center.y * wnd_height;
-			float r = a.radius * wnd_width;
-			verts.push_back(Stride{.pos = {cx, cy}, .color = a.color});
-			int seg = std::max(2, int(SEGMENTS * (a.end_angle - a.start_angle) / (2.0f * PI)));
-			for (int i = 0; i <= seg; i++) {
-				float t = float(i) / seg;
-				float ang = a.start_angle + t * (a.end_angle - a.start_angle);
-				verts.push_back(Stride{
-					.pos = {cx + r * cosf(ang), cy + r * sinf(ang)},
-					.color = a.color
-				});
-			}
-			size_t cnt = verts.size();
-			size_t buf_cap = self.gl_buf.len;
-			for (size_t i = 0; i < cnt; i += buf_cap) {
-				size_t chunk = std::min(buf_cap, cnt - i);
-				glBufferSubData(GL_ARRAY_BUFFER, 0, chunk * sizeof(Stride), verts.data() + i);
-				glDrawArrays(GL_TRIANGLE_FAN, 0, chunk);
+			const glm::vec2 center {a.center.x * wnd_width, a.center.y * wnd_height};
+			const float r = a.radius * wnd_width;
+			const int seg = std::max(2, int(SEGMENTS * (a.end_angle - a.start_angle) / (2.0f * PI)));
+			glm::vec2 prev = center + r * glm::vec2{cosf(a.start_angle), sinf(a.start_angle)};
+			for (int i = 1; i <= seg; i++) {
+				const float t = float(i) / seg;
+				const float ang = a.start_angle + t * (a.end_angle - a.start_angle);
+				const glm::vec2 p = center + r * glm::vec2{cosf(ang), sinf(ang)};
+				triangles.push_back(Stride{.pos = center, .color = a.color});
+				triangles.push_back(Stride{.pos = prev,   .color = a.color});
+				triangles.push_back(Stride{.pos = p,      .color = a.color});
+				prev = p;
 			}
 		}
 
 		for (auto& t : self.list_filled_triangles) {
-			Stride verts[3] = {
-				{.pos = {t.p0.x * wnd_width, t.p0.y * wnd_height}, .color = t.color},
-				{.pos = {t.p1.x * wnd_width, t.p1.y * wnd_height}, .color = t.color},
-				{.pos = {t.p2.x * wnd_width, t.p2.y * wnd_height}, .color = t.color},
-			};
-			glBufferSubData(GL_ARRAY_BUFFER, 0, 3 * sizeof(Stride), verts);
-			glDrawArrays(GL_TRIANGLES, 0, 3);
+			triangles.push_back(Stride{.pos = {t.p0.x * wnd_width, t.p0.y * wnd_height}, .color = t.color});
+			triangles.push_back(Stride{.pos = {t.p1.x * wnd_width, t.p1.y * wnd_height}, .color = t.color});
+			triangles.push_back(Stride{.pos = {t.p2.x * wnd_width, t.p2.y * wnd_height}, .color = t.color});
+		}
+
+		gl_program_use(self.program);
+		gl_program_uniform_set(self.program, "projection_view",
+			glm::ortho(0.0f, float(wnd_width), 0.0f, float(wnd_height)));
+
+		gl_state_capability_set(GL_CULL_FACE, false);
+		gl_state_bind_vertex_array(self.vao);
+		// each batch is drawn right after its push, a push that doesn't fit orphans what earlier ones pushed
+		if (lines.empty() == false) {
+			const GLint lines_first = gl_stream_buf_push(world.canvas.stream, lines);
+			glDrawArrays(GL_LINES, lines_first, lines.size());
+		}
+		if (triangles.empty() == false) {
+			const GLint triangles_first = gl_stream_buf_push(world.canvas.stream, triangles);
+			glDrawArrays(GL_TRIANGLES, triangles_first, triangles.size());
 		}
-		glEnable(GL_CULL_FACE);
+		gl_state_capability_set(GL_CULL_FACE, true);
 	}
 
 	void canvas_render_lines(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
+
+		const auto& frame = canvas_frame_drawing(world.canvas);
 
 		auto& self = world.canvas.lines;
 
@@ -971,39 +1078,38 @@ namespace sys {
 
 		for (const auto& line : self.list) {
 			strides.push_back(Stride {
-				.vertex = world.mats.projection_view * glm::vec4(line.p0, 1.0f),
+				.vertex = frame.mats.projection_view * glm::vec4(line.p0, 1.0f),
 				.color = line.color
 			});
 			strides.push_back(Stride {
-				.vertex = world.mats.projection_view * glm::vec4(line.p1, 1.0f),
+				.vertex = frame.mats.projection_view * glm::vec4(line.p1, 1.0f),
 				.color = line.color
 			});
 		}
 
+		const GLint first = gl_stream_buf_push(world.canvas.stream, strides);
+
 		gl_program_use(self.program);
-		glBindVertexArray(self.gl_buf.vao);
-		glBindBuffer(GL_ARRAY_BUFFER, self.gl_buf.vbo);
+		gl_state_bind_vertex_array(self.vao);
 
-		glEnable(GL_LINE_SMOOTH);
+		gl_state_capability_set(GL_LINE_SMOOTH, true);
 		#ifndef OS_MACOS
-		glLineWidth(self.line_width);
+		gl_state_line_width(self.line_width);
 		#endif
 
-		for (int i = 0; i < strides.size(); i += self.gl_buf.len) {
-			const size_t count = std::min(self.gl_buf.len, strides.size()-i);
-			glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Stride), strides.data()+i);
-			glDrawArrays(GL_LINES, 0, count);
-		}
+		glDrawArrays(GL_LINES, first, strides.size());
 	}
 
 	void canvas_render_ground(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
+
+		const auto& frame = canvas_frame_drawing(world.canvas);
 
 		auto& self = world.canvas;
 
 		gl_program_use(self.ground.program);
-		gl_program_uniform_set(self.ground.program, "projection_inverse", world.mats.projection_inverse);
-		gl_program_uniform_set(self.ground.program, "view_inverse", world.mats.view_inverse);
+		gl_program_uniform_set(self.ground.program, "projection_inverse", frame.mats.projection_inverse);
+		gl_program_uniform_set(self.ground.program, "view_inverse", frame.mats.view_inverse);
 		gl_program_uniform_set(self.ground.program, "color", self.ground.last_gnd.color);
 
 		// fog
@@ -1014,19 +1120,19 @@ namespace sys {
 		gl_program_uniform_set(self.ground.program, "fog_color",
 			world.settings.rendering.fog_color);
 		gl_program_uniform_set(self.ground.program, "camera_pos",
-			world.camera.position);
+			frame.camera_position);
 
-		glDisable(GL_DEPTH_TEST);
+		gl_state_capability_set(GL_DEPTH_TEST, false);
 
-		glBindTexture(GL_TEXTURE_2D, self.ground.tile_texture);
-		glBindVertexArray(self.ground.gl_buf.vao);
+		gl_state_bind_texture(0, GL_TEXTURE_2D, self.ground.tile_texture);
+		gl_state_bind_vertex_array(self.ground.gl_buf.vao);
 		glDrawArrays(GL_TRIANGLES, 0, self.ground.gl_buf.len);
 
-		glEnable(GL_DEPTH_TEST);
+		gl_state_capability_set(GL_DEPTH_TEST, true);
 	}
 
 	void canvas_render_gnd_pictures(World& world) {
-		DEF_SYSTEM
+		DEF_GPU_SYSTEM
 
 		auto& self = world.canvas;
 
@@ -1034,41 +1140,43 @@ namespace sys {
 			return;
 		}
 
-		glDisable(GL_DEPTH_TEST);
-		gl_program_use(world.canvas.gnd_pics.program);
+		gl_state_capability_set(GL_DEPTH_TEST, false);
 
-		// fog
-		gl_program_uniform_set(self.gnd_pics.program, "fog_enabled",
-			world.settings.rendering.fog_enabled);
-		gl_program_uniform_set(self.gnd_pics.program, "fog_density",
-			world.settings.rendering.fog_density);
-		gl_program_uniform_set(self.gnd_pics.program, "fog_color",
-			world.settings.rendering.fog_color);
+		self.gnd_pics.program = {};
+		const uint32_t frame_features = world.settings.rendering.fog_enabled? canvas::GND_PIC_FEATURE_FOG : 0;
 
 		for (const auto& gnd_pic : self.gnd_pics.list) {
-			gl_program_uniform_set(self.gnd_pics.program, "projection_view_model", gnd_pic.projection_view_model);
+			bool projection_view_model_set = false;
 
 			for (const auto& primitives : gnd_pic.list_primitives) {
-				gl_program_uniform_set(self.gnd_pics.program, "primitive_color[0]", primitives.color);
+				uint32_t features = frame_features;
+				if (primitives.gradient_enabled) {
+					features |= canvas::GND_PIC_FEATURE_GRADIENT;
+				}
+				if (primitives.tex_enabled) {
+					features |= canvas::GND_PIC_FEATURE_TEXTURE;
+				}
+				if (_canvas_gnd_pics_program_use(world, features) || projection_view_model_set == false) {
+					gl_program_uniform_set(self.gnd_pics.program, "projection_view_model", gnd_pic.projection_view_model);
+					projection_view_model_set = true;
+				}
 
-				gl_program_uniform_set(self.gnd_pics.program, "gradient_enabled", primitives.gradient_enabled);
+				gl_program_uniform_set(self.gnd_pics.program, "primitive_color[0]", primitives.color);
 				if (primitives.gradient_enabled) {
 					gl_program_uniform_set(self.gnd_pics.program, "primitive_color[1]", primitives.gradient_color2);
 				}
 
-				gl_program_uniform_set(self.gnd_pics.program, "tex_enabled", primitives.tex_enabled);
 				if (primitives.tex_enabled) {
-					glActiveTexture(GL_TEXTURE0);
-					glBindTexture(GL_TEXTURE_2D, primitives.texture_id);
-					gl_program_uniform_set(self.gnd_pics.program, "terrain_tex", 0);
+					_canvas_texture_array_bind(primitives.texture_id);
+					gl_program_uniform_set(self.gnd_pics.program, "tex_layer", float(primitives.texture_layer));
 				}
 
-				glBindVertexArray(primitives.vao);
+				gl_state_bind_vertex_array(primitives.vao);
 				glDrawArrays(primitives.gl_primitive_type, 0, primitives.buf_len);
 			}
 		}
 
-		glEnable(GL_DEPTH_TEST);
+		gl_state_capability_set(GL_DEPTH_TEST, true);
 	}
 
 } // namespace sys
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 #include <glad/glad.h>
 #include <SDL.h>
@@ -13,8 +14,25 @@
 #include <mu/utils.h>
 
 #include "graphics.h"
+#include "workers.h"
+#include "camera.h"
 
 namespace canvas {
+	// bits of meshes program variants, same order as features given to its GLProgramVariants
+	enum MeshFeature : uint32_t {
+		MESH_FEATURE_GRADIENT = 1 << 0,
+		MESH_FEATURE_TEXTURE  = 1 << 1,
+		MESH_FEATURE_LIGHTING = 1 << 2,
+		MESH_FEATURE_FOG      = 1 << 3,
+	};
+
+	// bits of gnd_pics program variants
+	enum GndPicFeature : uint32_t {
+		GND_PIC_FEATURE_GRADIENT = 1 << 0,
+		GND_PIC_FEATURE_TEXTURE  = 1 << 1,
+		GND_PIC_FEATURE_FOG      = 1 << 2,
+	};
+
 	// all state of loaded glyph using FreeType
 	// https://learnopengl.com/img/in-practice/glyph_offset.png
 	struct Glyph {
@@ -63,6 +81,22 @@ namespace canvas {
 		glm::mat4 projection_view_model;
 		glm::mat3 model_normal;
 
+		// GL_TEXTURE_2D_ARRAY
+		GLuint texture_id = 0;
+		GLint texture_layer = 0;
+		bool tex_enabled = false;
+	};
+
+	// many meshes already transformed to world space that share one buffer and one texture
+	// drawn with a single glMultiDrawArrays, each range keeps its own primitive assembly
+	struct MeshBatch {
+		GLuint vao;
+		// not owned, whoever adds the batch keeps ranges alive until the frame is rendered
+		std::span<const GLint> firsts;
+		std::span<const GLsizei> counts;
+		glm::mat4 projection_view;
+
+		// GL_TEXTURE_2D_ARRAY, each vertex has its layer in uv.z
 		GLuint texture_id = 0;
 		bool tex_enabled = false;
 	};
@@ -102,11 +136,14 @@ namespace canvas {
 			bool gradient_enabled;
 			glm::vec3 gradient_color2;
 
+			// GL_TEXTURE_2D_ARRAY
 			GLuint texture_id = 0;
+			GLint texture_layer = 0;
 			bool tex_enabled = false;
 		};
 
-		mu::Vec<Primitive> list_primitives;
+		// not owned, whoever adds the GndPic keeps primitives alive until the frame is rendered
+		std::span<const Primitive> list_primitives;
 	};
 
 	// heads up display, 2d shapes that sticks to window
@@ -156,13 +193,112 @@ namespace canvas {
 	};
 }
 
+// canvas primitives recorded by one worker slot, see `canvas_frame_merge`
+struct CanvasCmdList {
+	// owns everything recorded, lives until canvas_rendering_end
+	mu::memory::Arena arena;
+
+	mu::Vec<canvas::Mesh> meshes;
+	mu::Vec<canvas::MeshBatch> mesh_batches;
+	mu::Vec<canvas::GradientMesh> gradient_meshes;
+	mu::Vec<canvas::Cockpit> cockpits;
+	mu::Vec<canvas::GndPic> gnd_pics;
+	mu::Vec<canvas::ZLPoint> zlpoints;
+	mu::Vec<canvas::Axis> axes;
+	mu::Vec<canvas::Line> lines;
+	mu::Vec<canvas::Text> texts;
+	mu::Vec<canvas::hud::Text> hud_texts;
+	mu::Vec<canvas::hud::Circle> hud_circles;
+	mu::Vec<canvas::hud::Line> hud_lines;
+	mu::Vec<canvas::hud::LineStrip> hud_line_strips;
+	mu::Vec<canvas::hud::FilledArc> hud_filled_arcs;
+	mu::Vec<canvas::hud::FilledTriangle> hud_filled_triangles;
+
+	bool has_ground;
+	canvas::Ground ground;
+};
+
+// empties the lists, memory of what was already merged stays valid till arena is reset
+inline void canvas_cmd_list_clear(CanvasCmdList& self) {
+	self.meshes               = mu::Vec<canvas::Mesh>(&self.arena);
+	self.mesh_batches         = mu::Vec<canvas::MeshBatch>(&self.arena);
+	self.gradient_meshes      = mu::Vec<canvas::GradientMesh>(&self.arena);
+	self.cockpits             = mu::Vec<canvas::Cockpit>(&self.arena);
+	self.gnd_pics             = mu::Vec<canvas::GndPic>(&self.arena);
+	self.zlpoints             = mu::Vec<canvas::ZLPoint>(&self.arena);
+	self.axes                 = mu::Vec<canvas::Axis>(&self.arena);
+	self.lines                = mu::Vec<canvas::Line>(&self.arena);
+	self.texts                = mu::Vec<canvas::Text>(&self.arena);
+	self.hud_texts            = mu::Vec<canvas::hud::Text>(&self.arena);
+	self.hud_circles          = mu::Vec<canvas::hud::Circle>(&self.arena);
+	self.hud_lines            = mu::Vec<canvas::hud::Line>(&self.arena);
+	self.hud_line_strips      = mu::Vec<canvas::hud::LineStrip>(&self.arena);
+	self.hud_filled_arcs      = mu::Vec<canvas::hud::FilledArc>(&self.arena);
+	self.hud_filled_triangles = mu::Vec<canvas::hud::FilledTriangle>(&self.arena);
+	self.has_ground = false;
+}
+
+// systems that record at the same time each have a lane of their own, lanes are merged in this order
+enum CanvasLane : uint32_t {
+	CANVAS_LANE_SCENERY,
+	CANVAS_LANE_AIRCRAFTS,
+	CANVAS_LANE_GROUND_OBJS,
+	CANVAS_LANE_TRAFFIC,
+	CANVAS_LANE_COLLISION,
+	CANVAS_LANES_COUNT,
+};
+
+// what simulation records for one frame, it's drawn while the next one is recorded, see `SimThread`
+struct CanvasFrame {
+	// one per lane and worker slot, prepare_render systems record into them in parallel
+	mu::Arr<mu::Arr<CanvasCmdList, WORKERS_MAX>, CANVAS_LANES_COUNT> cmd_lists;
+
+	// lanes then their slots in order once all systems recorded, see `canvas_frame_merge`
+	CanvasCmdList merged;
+
+	// camera the frame was recorded with
+	CachedMatrices mats;
+	glm::vec3 camera_position;
+
+	mu::memory::Arena arena;
+	mu::Vec<mu::Str> text_overlay_list;
+};
+
+// frees everything recorded, lists are ready to record again
+inline void canvas_frame_clear(CanvasFrame& self) {
+	for (auto& lane : self.cmd_lists) {
+		for (auto& cmds : lane) {
+			cmds.arena = {};
+			canvas_cmd_list_clear(cmds);
+		}
+	}
+	self.merged.arena = {};
+	canvas_cmd_list_clear(self.merged);
+
+	self.arena = {};
+	self.text_overlay_list = mu::Vec<mu::Str>(&self.arena);
+}
+
 struct Canvas {
 	mu::memory::Arena arena;
 
+	// simulation records into one while the other is drawn, see `canvas_frames_swap`
+	mu::Arr<CanvasFrame, 2> frames;
+	size_t frame_recording;
+	// GL objects or scenery cache the drawn frame references were freed after it was recorded
+	bool frame_drawing_stale;
+
+	// all immediate-mode geometry (lines, hud geoms) is streamed here every frame
+	GLStreamBuf stream;
+
 	struct {
+		GLProgramVariants program_variants;
+		// variant in use, reset each frame
 		GLProgram program;
+		uint32_t program_features;
 
 		mu::Vec<canvas::Mesh> list_regular;
+		mu::Vec<canvas::MeshBatch> list_batches;
 		mu::Vec<canvas::GradientMesh> list_gradient;
 		mu::Vec<canvas::Cockpit> list_cockpit;
 	} meshes;
@@ -178,7 +314,10 @@ struct Canvas {
 	} ground;
 
 	struct {
+		GLProgramVariants program_variants;
+		// variant in use, reset each frame
 		GLProgram program;
+		uint32_t program_features;
 
 		mu::Vec<canvas::GndPic> list;
 	} gnd_pics;
@@ -213,7 +352,7 @@ struct Canvas {
 
 	struct {
 		GLProgram program;
-		GLBuf gl_buf;
+		GLuint vao; // over canvas stream
 		GLfloat line_width = 1.0f;
 
 		mu::Vec<canvas::Line> list;
@@ -221,7 +360,7 @@ struct Canvas {
 
 	struct {
 		GLProgram program;
-		GLBuf gl_buf;
+		GLuint vao; // over canvas stream
 
 		mu::Vec<canvas::hud::Circle> list_circles;
 		mu::Vec<canvas::hud::Line> list_lines;
@@ -271,7 +410,9 @@ inline void canvas_add(Canvas& self, canvas::Line&& l) {
 	self.lines.list.push_back(std::move(l));
 }
 
-inline void canvas_add(Canvas& self, canvas::Box&& b) {
+// works for both Canvas and CanvasCmdList
+template<typename CanvasT>
+inline void canvas_add(CanvasT& self, canvas::Box&& b) {
 	const auto min = b.translation;
 	const auto max = b.translation + b.scale;
 	const glm::vec4 color{b.color, 1.0f};
@@ -305,6 +446,10 @@ inline void canvas_add(Canvas& self, canvas::Mesh&& m) {
 	self.meshes.list_regular.push_back(std::move(m));
 }
 
+inline void canvas_add(Canvas& self, canvas::MeshBatch&& b) {
+	self.meshes.list_batches.push_back(std::move(b));
+}
+
 inline void canvas_add(Canvas& self, canvas::Cockpit&& c) {
 	self.meshes.list_cockpit.push_back(std::move(c));
 }
@@ -321,7 +466,8 @@ inline void canvas_add(Canvas& self, canvas::GndPic&& p) {
 	self.gnd_pics.list.push_back(std::move(p));
 }
 
-inline void canvas_add(Canvas& self, const canvas::Vector& v) {
+template<typename CanvasT>
+inline void canvas_add(CanvasT& self, const canvas::Vector& v) {
 	canvas_add(self, canvas::Line {
 		.p0 = v.p,
 		.p1 = v.p + v.dir * v.len,
@@ -334,3 +480,146 @@ inline void canvas_add(Canvas& self, const canvas::Vector& v) {
 		.color = v.color
 	});
 }
+
+inline void canvas_add(CanvasCmdList& self, canvas::Text&& t) {
+	self.texts.push_back(std::move(t));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::hud::Text&& t) {
+	self.hud_texts.push_back(std::move(t));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::hud::Circle&& c) {
+	self.hud_circles.push_back(std::move(c));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::hud::Line&& l) {
+	self.hud_lines.push_back(std::move(l));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::hud::LineStrip&& l) {
+	self.hud_line_strips.push_back(std::move(l));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::hud::FilledArc&& a) {
+	self.hud_filled_arcs.push_back(std::move(a));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::hud::FilledTriangle&& t) {
+	self.hud_filled_triangles.push_back(std::move(t));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::Axis&& a) {
+	self.axes.push_back(std::move(a));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::ZLPoint&& z) {
+	self.zlpoints.push_back(std::move(z));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::Line&& l) {
+	self.lines.push_back(std::move(l));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::Mesh&& m) {
+	self.meshes.push_back(std::move(m));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::MeshBatch&& b) {
+	self.mesh_batches.push_back(std::move(b));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::Cockpit&& c) {
+	self.cockpits.push_back(std::move(c));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::GradientMesh&& m) {
+	self.gradient_meshes.push_back(std::move(m));
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::Ground&& g) {
+	self.has_ground = true;
+	self.ground = g;
+}
+
+inline void canvas_add(CanvasCmdList& self, canvas::GndPic&& p) {
+	self.gnd_pics.push_back(std::move(p));
+}
+
+template<typename T>
+inline void _canvas_append(mu::Vec<T>& dst, mu::Vec<T>& src) {
+	for (auto& x : src) {
+		dst.push_back(std::move(x));
+	}
+}
+
+inline CanvasFrame& canvas_frame_recording(Canvas& self) {
+	return self.frames[self.frame_recording];
+}
+
+inline CanvasFrame& canvas_frame_drawing(Canvas& self) {
+	return self.frames[1 - self.frame_recording];
+}
+
+// recorded frame becomes the drawn one, and the drawn one (cleared by canvas_rendering_end) is recorded next
+inline void canvas_frames_swap(Canvas& self) {
+	self.frame_recording = 1 - self.frame_recording;
+	self.frame_drawing_stale = false;
+}
+
+// appends first `count` command lists of every lane of frame to its merged list in lane then slot order, then clears them
+// result is the same as if everything was recorded from a single thread
+inline void canvas_frame_merge(CanvasFrame& self, size_t count) {
+	auto& dst = self.merged;
+	for (size_t i = 0; i < CANVAS_LANES_COUNT * count; i++) {
+		auto& cmds = self.cmd_lists[i / count][i % count];
+
+		_canvas_append(dst.meshes, cmds.meshes);
+		_canvas_append(dst.mesh_batches, cmds.mesh_batches);
+		_canvas_append(dst.gradient_meshes, cmds.gradient_meshes);
+		_canvas_append(dst.cockpits, cmds.cockpits);
+		_canvas_append(dst.gnd_pics, cmds.gnd_pics);
+		_canvas_append(dst.zlpoints, cmds.zlpoints);
+		_canvas_append(dst.axes, cmds.axes);
+		_canvas_append(dst.lines, cmds.lines);
+		_canvas_append(dst.texts, cmds.texts);
+		_canvas_append(dst.hud_texts, cmds.hud_texts);
+		_canvas_append(dst.hud_circles, cmds.hud_circles);
+		_canvas_append(dst.hud_lines, cmds.hud_lines);
+		_canvas_append(dst.hud_line_strips, cmds.hud_line_strips);
+		_canvas_append(dst.hud_filled_arcs, cmds.hud_filled_arcs);
+		_canvas_append(dst.hud_filled_triangles, cmds.hud_filled_triangles);
+		if (cmds.has_ground) {
+			dst.has_ground = true;
+			dst.ground = cmds.ground;
+		}
+
+		canvas_cmd_list_clear(cmds);
+	}
+}
+
+// appends what the drawn frame recorded to canvas, memory stays owned by the frame
+inline void canvas_merge(Canvas& self, CanvasFrame& frame) {
+	auto& src = frame.merged;
+
+	_canvas_append(self.meshes.list_regular, src.meshes);
+	_canvas_append(self.meshes.list_batches, src.mesh_batches);
+	_canvas_append(self.meshes.list_gradient, src.gradient_meshes);
+	_canvas_append(self.meshes.list_cockpit, src.cockpits);
+	_canvas_append(self.gnd_pics.list, src.gnd_pics);
+	_canvas_append(self.zlpoints.list, src.zlpoints);
+	_canvas_append(self.axes.list, src.axes);
+	_canvas_append(self.lines.list, src.lines);
+	_canvas_append(self.text.list_world, src.texts);
+	_canvas_append(self.text.list_hud, src.hud_texts);
+	_canvas_append(self.hud_geoms.list_circles, src.hud_circles);
+	_canvas_append(self.hud_geoms.list_lines, src.hud_lines);
+	_canvas_append(self.hud_geoms.list_line_strips, src.hud_line_strips);
+	_canvas_append(self.hud_geoms.list_filled_arcs, src.hud_filled_arcs);
+	_canvas_append(self.hud_geoms.list_filled_triangles, src.hud_filled_triangles);
+	if (src.has_ground) {
+		self.ground.last_gnd = src.ground;
+	}
+
+	canvas_cmd_list_clear(src);
+}
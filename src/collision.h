@@ -0,0 +1,557 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <filesystem> // std::filesystem
+
+#include <glm/glm.hpp>
+
+#include <mu/utils.h>
+
+#include "math.h"
+#include "assets.h"
+
+// leaves split until they have at most this many triangles
+constexpr uint32_t COLLISION_LEAF_TRIANGLES_MAX = 4;
+
+struct CollisionTriangle {
+	glm::vec3 v[3];
+};
+
+// 32 bytes, leaf (count > 0) has triangles [first, first+count),
+// inner node has its children at nodes[first] and nodes[first+1]
+struct CollisionNode {
+	glm::vec3 min;
+	uint32_t first;
+	glm::vec3 max;
+	uint32_t count;
+};
+
+// triangles of coll.srf/coll.dnm in model space (rest pose), nodes[0] is the root
+// empty if the model has none, then its OBB is all there is to test
+struct CollisionMesh {
+	mu::Vec<CollisionTriangle> triangles;
+	mu::Vec<CollisionNode> nodes;
+};
+
+// box of center ± half_extents along axes (columns, unit length)
+struct OBB {
+	glm::vec3 center;
+	glm::mat3 axes;
+	glm::vec3 half_extents;
+};
+
+inline void _collision_node_split(CollisionMesh& self, uint32_t node_index) {
+	const uint32_t first = self.nodes[node_index].first;
+	const uint32_t count = self.nodes[node_index].count;
+
+	glm::vec3 min {+FLT_MAX}, max {-FLT_MAX};
+	glm::vec3 centroids_min {+FLT_MAX}, centroids_max {-FLT_MAX};
+	for (uint32_t i = first; i < first + count; i++) {
+		const auto& t = self.triangles[i];
+		for (const auto& v : t.v) {
+			min = glm::min(min, v);
+			max = glm::max(max, v);
+		}
+		const auto centroid = (t.v[0] + t.v[1] + t.v[2]) / 3.0f;
+		centroids_min = glm::min(centroids_min, centroid);
+		centroids_max = glm::max(centroids_max, centroid);
+	}
+	self.nodes[node_index].min = min;
+	self.nodes[node_index].max = max;
+
+	if (count <= COLLISION_LEAF_TRIANGLES_MAX) {
+		return;
+	}
+
+	// median along longest axis of centroids, always halves so depth stays log2(triangles)
+	const auto extent = centroids_max - centroids_min;
+	const int axis = extent.x > extent.y? (extent.x > extent.z? 0 : 2) : (extent.y > extent.z? 1 : 2);
+	const uint32_t half = count / 2;
+	std::nth_element(self.triangles.begin() + first, self.triangles.begin() + first + half, self.triangles.begin() + first + count,
+		[axis](const CollisionTriangle& a, const CollisionTriangle& b) {
+			return a.v[0][axis] + a.v[1][axis] + a.v[2][axis] < b.v[0][axis] + b.v[1][axis] + b.v[2][axis];
+		}
+	);
+
+	const auto children = (uint32_t) self.nodes.size();
+	self.nodes.push_back(CollisionNode { .first = first, .count = half });
+	self.nodes.push_back(CollisionNode { .first = first + half, .count = count - half });
+	self.nodes[node_index].first = children;
+	self.nodes[node_index].count = 0;
+
+	_collision_node_split(self, children);
+	_collision_node_split(self, children + 1);
+}
+
+// builds nodes over self.triangles, reorders them
+inline void collision_mesh_build(CollisionMesh& self) {
+	self.nodes.clear();
+	if (self.triangles.empty()) {
+		return;
+	}
+
+	self.nodes.push_back(CollisionNode { .first = 0, .count = (uint32_t) self.triangles.size() });
+	_collision_node_split(self, 0);
+}
+
+// faces of all meshes as fans, at their transformation from loading (same as initial AABB)
+inline CollisionMesh collision_mesh_from_model(const Model& model) {
+	CollisionMesh self {};
+
+	meshes_foreach(model.meshes, [&self](const Mesh& mesh) {
+		for (const auto& face : mesh.faces) {
+			if (face.vertices_ids.size() < 3) {
+				continue;
+			}
+
+			const auto v0 = glm::vec3(mesh.transformation * glm::vec4(mesh.vertices[face.vertices_ids[0]], 1.0f));
+			auto v1 = glm::vec3(mesh.transformation * glm::vec4(mesh.vertices[face.vertices_ids[1]], 1.0f));
+			for (size_t i = 2; i < face.vertices_ids.size(); i++) {
+				const auto v2 = glm::vec3(mesh.transformation * glm::vec4(mesh.vertices[face.vertices_ids[i]], 1.0f));
+				// lines and points drawn as faces can't be hit
+				const auto normal = glm::cross(v1 - v0, v2 - v0);
+				if (glm::dot(normal, normal) > 1e-12f) {
+					self.triangles.push_back(CollisionTriangle { .v = {v0, v1, v2} });
+				}
+				v1 = v2;
+			}
+		}
+		return true;
+	});
+
+	collision_mesh_build(self);
+	return self;
+}
+
+// coll.srf/coll.dnm, empty mesh if model has no such file
+inline CollisionMesh collision_mesh_from_file(mu::StrView file_abs_path) {
+	if (file_abs_path.empty() || std::filesystem::is_regular_file(file_abs_path) == false) {
+		return CollisionMesh {};
+	}
+
+	const auto model = file_abs_path.ends_with(".dnm")? model_from_dnm_file(file_abs_path) : model_from_srf_file(file_abs_path);
+	return collision_mesh_from_model(model);
+}
+
+// model space box under model_transformation (rotation and translation only)
+inline OBB obb_from_aabb(const AABB& aabb, const glm::mat4& model_transformation) {
+	return OBB {
+		.center = glm::vec3(model_transformation * glm::vec4((aabb.min + aabb.max) * 0.5f, 1.0f)),
+		.axes = glm::mat3(model_transformation),
+		.half_extents = (aabb.max - aabb.min) * 0.5f,
+	};
+}
+
+// separating axis test over 3+3 face normals and 9 edge pairs
+// see Real-Time Collision Detection (Christer Ericson) 4.4.1
+inline bool obbs_intersect(const OBB& a, const OBB& b) {
+	glm::mat3 r, abs_r;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			r[i][j] = glm::dot(a.axes[i], b.axes[j]);
+			// epsilon keeps near parallel edges (their cross product is about zero) from separating
+			abs_r[i][j] = std::abs(r[i][j]) + 1e-6f;
+		}
+	}
+
+	const auto d = b.center - a.center;
+	const glm::vec3 t {glm::dot(d, a.axes[0]), glm::dot(d, a.axes[1]), glm::dot(d, a.axes[2])};
+	const auto& ea = a.half_extents;
+	const auto& eb = b.half_extents;
+
+	for (int i = 0; i < 3; i++) {
+		if (std::abs(t[i]) > ea[i] + eb[0] * abs_r[i][0] + eb[1] * abs_r[i][1] + eb[2] * abs_r[i][2]) {
+			return false;
+		}
+	}
+	for (int j = 0; j < 3; j++) {
+		if (std::abs(t[0] * r[0][j] + t[1] * r[1][j] + t[2] * r[2][j]) > ea[0] * abs_r[0][j] + ea[1] * abs_r[1][j] + ea[2] * abs_r[2][j] + eb[j]) {
+			return false;
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		const int i1 = (i+1) % 3, i2 = (i+2) % 3;
+		for (int j = 0; j < 3; j++) {
+			const int j1 = (j+1) % 3, j2 = (j+2) % 3;
+			const float ra = ea[i1] * abs_r[i2][j] + ea[i2] * abs_r[i1][j];
+			const float rb = eb[j1] * abs_r[i][j2] + eb[j2] * abs_r[i][j1];
+			if (std::abs(t[i2] * r[i1][j] - t[i1] * r[i2][j]) > ra + rb) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+inline bool _triangles_separated_on(const glm::vec3& axis, const CollisionTriangle& a, const CollisionTriangle& b) {
+	// parallel edges, axis says nothing
+	if (glm::dot(axis, axis) < 1e-12f) {
+		return false;
+	}
+
+	const float a0 = glm::dot(axis, a.v[0]), a1 = glm::dot(axis, a.v[1]), a2 = glm::dot(axis, a.v[2]);
+	const float b0 = glm::dot(axis, b.v[0]), b1 = glm::dot(axis, b.v[1]), b2 = glm::dot(axis, b.v[2]);
+	return std::max({a0, a1, a2}) < std::min({b0, b1, b2}) || std::max({b0, b1, b2}) < std::min({a0, a1, a2});
+}
+
+// separating axis test over both normals, 9 edge pairs and 6 in plane edge normals (for coplanar triangles)
+inline bool triangles_intersect(const CollisionTriangle& a, const CollisionTriangle& b) {
+	const glm::vec3 ea[3] {a.v[1] - a.v[0], a.v[2] - a.v[1], a.v[0] - a.v[2]};
+	const glm::vec3 eb[3] {b.v[1] - b.v[0], b.v[2] - b.v[1], b.v[0] - b.v[2]};
+	const auto na = glm::cross(ea[0], ea[1]);
+	const auto nb = glm::cross(eb[0], eb[1]);
+
+	if (_triangles_separated_on(na, a, b) || _triangles_separated_on(nb, a, b)) {
+		return false;
+	}
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			if (_triangles_separated_on(glm::cross(ea[i], eb[j]), a, b)) {
+				return false;
+			}
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		if (_triangles_separated_on(glm::cross(na, ea[i]), a, b) || _triangles_separated_on(glm::cross(nb, eb[i]), a, b)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// walks both BVHs together in a's model space, b's nodes become OBBs there
+inline bool collision_meshes_intersect(const CollisionMesh& a, const glm::mat4& a_transformation, const CollisionMesh& b, const glm::mat4& b_transformation) {
+	if (a.nodes.empty() || b.nodes.empty()) {
+		return false;
+	}
+
+	const auto b_to_a = glm::inverse(a_transformation) * b_transformation;
+	const auto node_obb = [](const CollisionNode& node, const glm::mat4& transformation) {
+		return obb_from_aabb(AABB { .min = node.min, .max = node.max }, transformation);
+	};
+
+	// descending one side per pop keeps stack under depth(a) + depth(b)
+	struct NodePair { uint32_t a, b; };
+	NodePair stack[128];
+	int stack_size = 0;
+	stack[stack_size++] = NodePair { 0, 0 };
+
+	while (stack_size > 0) {
+		const auto [ia, ib] = stack[--stack_size];
+		const auto& na = a.nodes[ia];
+		const auto& nb = b.nodes[ib];
+
+		if (obbs_intersect(node_obb(na, glm::mat4{1.0f}), node_obb(nb, b_to_a)) == false) {
+			continue;
+		}
+
+		if (na.count > 0 && nb.count > 0) {
+			for (uint32_t j = nb.first; j < nb.first + nb.count; j++) {
+				CollisionTriangle tb;
+				for (int k = 0; k < 3; k++) {
+					tb.v[k] = glm::vec3(b_to_a * glm::vec4(b.triangles[j].v[k], 1.0f));
+				}
+				for (uint32_t i = na.first; i < na.first + na.count; i++) {
+					if (triangles_intersect(a.triangles[i], tb)) {
+						return true;
+					}
+				}
+			}
+			continue;
+		}
+
+		// split the bigger node, or the only one that isn't a leaf
+		const auto size_a = na.max - na.min;
+		const auto size_b = nb.max - nb.min;
+		const bool descend_a = nb.count > 0 || (na.count == 0 && glm::dot(size_a, size_a) >= glm::dot(size_b, size_b));
+		mu_assert(stack_size + 2 <= 128);
+		if (descend_a) {
+			stack[stack_size++] = NodePair { na.first, ib };
+			stack[stack_size++] = NodePair { na.first + 1, ib };
+		} else {
+			stack[stack_size++] = NodePair { ia, nb.first };
+			stack[stack_size++] = NodePair { ia, nb.first + 1 };
+		}
+	}
+
+	return false;
+}
+
+// what narrowphase needs of an entity, initial_aabb is used when mesh has no triangles
+struct CollisionBody {
+	const CollisionMesh* mesh;
+	AABB initial_aabb;
+	glm::mat4 transformation;
+};
+
+// after broadphase, OBBs of both then their triangles, only the OBBs if either has no collision mesh
+inline bool collision_bodies_intersect(const CollisionBody& a, const CollisionBody& b) {
+	const bool a_has_mesh = a.mesh && a.mesh->nodes.empty() == false;
+	const bool b_has_mesh = b.mesh && b.mesh->nodes.empty() == false;
+
+	const auto a_box = a_has_mesh? AABB { .min = a.mesh->nodes[0].min, .max = a.mesh->nodes[0].max } : a.initial_aabb;
+	const auto b_box = b_has_mesh? AABB { .min = b.mesh->nodes[0].min, .max = b.mesh->nodes[0].max } : b.initial_aabb;
+	if (obbs_intersect(obb_from_aabb(a_box, a.transformation), obb_from_aabb(b_box, b.transformation)) == false) {
+		return false;
+	}
+
+	if (a_has_mesh == false || b_has_mesh == false) {
+		return true;
+	}
+	return collision_meshes_intersect(*a.mesh, a.transformation, *b.mesh, b.transformation);
+}
+
+// interval [t_first, t_last] of [0,1] where OBB `a` moved by t * `displacement` touches still OBB `b`, false if it never does
+// same axes as obbs_intersect, on each the overlap is an interval of t, box touches while all of them do
+// moving AABB against AABB of Real-Time Collision Detection (Christer Ericson) 5.5.8, on OBB axes
+inline bool obbs_time_of_impact(const OBB& a, const glm::vec3& displacement, const OBB& b, float& t_first, float& t_last) {
+	glm::vec3 axes[15];
+	int axes_count = 0;
+	for (int i = 0; i < 3; i++) {
+		axes[axes_count++] = a.axes[i];
+		axes[axes_count++] = b.axes[i];
+	}
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			// parallel edges, face axes already cover them
+			const auto axis = glm::cross(a.axes[i], b.axes[j]);
+			if (glm::dot(axis, axis) > 1e-6f) {
+				axes[axes_count++] = axis;
+			}
+		}
+	}
+
+	const auto d = b.center - a.center;
+	t_first = 0;
+	t_last = 1;
+	for (int k = 0; k < axes_count; k++) {
+		const auto& axis = axes[k];
+		float r = 0;
+		for (int i = 0; i < 3; i++) {
+			r += a.half_extents[i] * std::abs(glm::dot(a.axes[i], axis)) + b.half_extents[i] * std::abs(glm::dot(b.axes[i], axis));
+		}
+
+		// centers are |s - v*t| apart on axis
+		const float s = glm::dot(d, axis);
+		const float v = glm::dot(displacement, axis);
+		if (std::abs(v) < 1e-9f) {
+			if (std::abs(s) > r) {
+				return false;
+			}
+			continue;
+		}
+
+		float enter = (s - r) / v;
+		float leave = (s + r) / v;
+		if (enter > leave) {
+			std::swap(enter, leave);
+		}
+		t_first = std::max(t_first, enter);
+		t_last = std::min(t_last, leave);
+		if (t_first > t_last) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// first fraction `t` of `displacement` where body `a` moved by it touches still body `b`, false if it never does
+// orientations stay as they are, OBBs give when they may touch then meshes are tested at steps no longer than
+// `a` is along the way, so it can't pass through anything thinner, and the first step that touches is bisected
+inline bool collision_bodies_time_of_impact(const CollisionBody& a, const glm::vec3& displacement, const CollisionBody& b, float& t) {
+	const bool a_has_mesh = a.mesh && a.mesh->nodes.empty() == false;
+	const bool b_has_mesh = b.mesh && b.mesh->nodes.empty() == false;
+
+	const auto a_box = a_has_mesh? AABB { .min = a.mesh->nodes[0].min, .max = a.mesh->nodes[0].max } : a.initial_aabb;
+	const auto b_box = b_has_mesh? AABB { .min = b.mesh->nodes[0].min, .max = b.mesh->nodes[0].max } : b.initial_aabb;
+	const auto a_obb = obb_from_aabb(a_box, a.transformation);
+	float t_first, t_last;
+	if (obbs_time_of_impact(a_obb, displacement, obb_from_aabb(b_box, b.transformation), t_first, t_last) == false) {
+		return false;
+	}
+
+	if (a_has_mesh == false || b_has_mesh == false) {
+		t = t_first;
+		return true;
+	}
+
+	auto touches = [&](float s) {
+		const auto moved = glm::translate(glm::mat4{1.0f}, displacement * s) * a.transformation;
+		return collision_meshes_intersect(*a.mesh, moved, *b.mesh, b.transformation);
+	};
+
+	const float distance = glm::length(displacement);
+	float length = 0;
+	if (distance > 0) {
+		for (int i = 0; i < 3; i++) {
+			length += 2 * a_obb.half_extents[i] * std::abs(glm::dot(a_obb.axes[i], displacement / distance));
+		}
+	}
+	const float steps = std::clamp(std::ceil((t_last - t_first) * distance / std::max(length, 1e-3f)), 1.0f, 64.0f);
+
+	float apart = t_first;
+	for (uint32_t i = 0; i <= (uint32_t) steps; i++) {
+		float touching = t_first + (t_last - t_first) * (i / steps);
+		if (touches(touching) == false) {
+			apart = touching;
+			continue;
+		}
+		if (i == 0) {
+			t = touching;
+			return true;
+		}
+
+		for (int j = 0; j < 8; j++) {
+			const float mid = (apart + touching) * 0.5f;
+			if (touches(mid)) {
+				touching = mid;
+			} else {
+				apart = mid;
+			}
+		}
+		t = touching;
+		return true;
+	}
+	return false;
+}
+
+inline void test_collision() {
+	mu_test_suite("collision");
+
+	auto rotation_y = [](float angle, glm::vec3 translation) {
+		return glm::rotate(glm::translate(glm::mat4{1.0f}, translation), angle, glm::vec3{0, 1, 0});
+	};
+
+	// rotated boxes whose world AABBs overlap but don't touch
+	{
+		const AABB unit {.min = {-1, -1, -1}, .max = {1, 1, 1}};
+		const auto a = obb_from_aabb(unit, rotation_y(glm::pi<float>() / 4, {0, 0, 0}));
+		const auto b = obb_from_aabb(unit, rotation_y(glm::pi<float>() / 4, {2.2f, 0, 2.2f}));
+		mu_test(obbs_intersect(a, b) == false);
+
+		const auto c = obb_from_aabb(unit, rotation_y(glm::pi<float>() / 4, {1.2f, 0, 1.2f}));
+		mu_test(obbs_intersect(a, c));
+		mu_test(obbs_intersect(a, obb_from_aabb(unit, rotation_y(0.3f, {2.2f, 0, 0}))));
+		mu_test(obbs_intersect(a, obb_from_aabb(unit, rotation_y(0.0f, {3.5f, 0, 0}))) == false);
+	}
+
+	{
+		const CollisionTriangle a {.v = {{0, 0, 0}, {2, 0, 0}, {0, 2, 0}}};
+		// piercing a
+		mu_test(triangles_intersect(a, CollisionTriangle {.v = {{0.5f, 0.5f, -1}, {0.5f, 0.5f, 1}, {1.5f, 0.2f, 0}}}));
+		// parallel, 1m away
+		mu_test(triangles_intersect(a, CollisionTriangle {.v = {{0, 0, 1}, {2, 0, 1}, {0, 2, 1}}}) == false);
+		// coplanar, overlapping then apart
+		mu_test(triangles_intersect(a, CollisionTriangle {.v = {{1, 1, 0}, {3, 1, 0}, {1, 3, 0}}}));
+		mu_test(triangles_intersect(a, CollisionTriangle {.v = {{1.1f, 1.1f, 0}, {3, 1.1f, 0}, {1.1f, 3, 0}}}) == false);
+		// same plane extended, edge of b passes by a's hypotenuse
+		mu_test(triangles_intersect(a, CollisionTriangle {.v = {{2, 2, -1}, {2, 2, 1}, {3, 3, 0}}}) == false);
+	}
+
+	// BVH against testing every two triangles, 20x20 grid of quads on xz and small tetrahedrons moving over it
+	{
+		CollisionMesh ground {};
+		auto grid_point = [](int x, int z) {
+			return glm::vec3{float(x), 0.1f * ((x * 7 + z * 3) % 5), float(z)};
+		};
+		for (int x = 0; x < 20; x++) {
+			for (int z = 0; z < 20; z++) {
+				ground.triangles.push_back(CollisionTriangle {.v = {grid_point(x, z), grid_point(x+1, z), grid_point(x, z+1)}});
+				ground.triangles.push_back(CollisionTriangle {.v = {grid_point(x+1, z), grid_point(x+1, z+1), grid_point(x, z+1)}});
+			}
+		}
+		auto ground_triangles = ground.triangles;
+		collision_mesh_build(ground);
+		mu_test(ground.nodes.size() > 1);
+		mu_test(ground.triangles.size() == ground_triangles.size());
+
+		CollisionMesh tetrahedron {};
+		const glm::vec3 p[4] {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[0], p[1], p[2]}});
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[0], p[1], p[3]}});
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[0], p[2], p[3]}});
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[1], p[2], p[3]}});
+		collision_mesh_build(tetrahedron);
+
+		const auto ground_transformation = rotation_y(0.4f, {-3, 2, 1});
+		int hits = 0, mismatches = 0;
+		for (int i = 0; i < 200; i++) {
+			const auto t = rotation_y(i * 0.37f, glm::vec3{-3, 2, 1} + glm::vec3{float((i * 13) % 19), -0.6f + (i % 9) * 0.15f, float((i * 7) % 17)});
+
+			bool expected = false;
+			for (const auto& tg : ground_triangles) {
+				for (const auto& tt : tetrahedron.triangles) {
+					CollisionTriangle wg, wt;
+					for (int k = 0; k < 3; k++) {
+						wg.v[k] = glm::vec3(ground_transformation * glm::vec4(tg.v[k], 1.0f));
+						wt.v[k] = glm::vec3(t * glm::vec4(tt.v[k], 1.0f));
+					}
+					expected = expected || triangles_intersect(wg, wt);
+				}
+			}
+
+			const CollisionBody body_ground {.mesh = &ground, .transformation = ground_transformation};
+			const CollisionBody body_tetrahedron {.mesh = &tetrahedron, .transformation = t};
+			hits += expected;
+			mismatches += collision_bodies_intersect(body_tetrahedron, body_ground) != expected;
+		}
+		mu_test(hits > 10 && hits < 190);
+		mu_test(mismatches == 0);
+	}
+
+	// without collision mesh, OBB of initial AABB decides
+	{
+		const CollisionBody a {.mesh = nullptr, .initial_aabb = {.min = {-1, -1, -1}, .max = {1, 1, 1}}, .transformation = rotation_y(0.7f, {0, 0, 0})};
+		const CollisionBody b {.mesh = nullptr, .initial_aabb = {.min = {-1, -1, -1}, .max = {1, 1, 1}}, .transformation = rotation_y(0.7f, {1.9f, 0, 0})};
+		const CollisionBody c {.mesh = nullptr, .initial_aabb = {.min = {-1, -1, -1}, .max = {1, 1, 1}}, .transformation = rotation_y(0.0f, {3.5f, 0, 0})};
+		mu_test(collision_bodies_intersect(a, b));
+		mu_test(collision_bodies_intersect(a, c) == false);
+	}
+
+	// thin wall between where a box starts and ends, both ends clear of it
+	{
+		const AABB unit {.min = {-1, -1, -1}, .max = {1, 1, 1}};
+		const auto box = obb_from_aabb(unit, rotation_y(0.0f, {-10, 0, 0}));
+		const auto wall = obb_from_aabb(AABB {.min = {-0.05f, -5, -5}, .max = {0.05f, 5, 5}}, rotation_y(0.2f, {0, 0, 0}));
+		mu_test(obbs_intersect(box, wall) == false);
+		mu_test(obbs_intersect(obb_from_aabb(unit, rotation_y(0.0f, {10, 0, 0})), wall) == false);
+
+		float t_first, t_last;
+		mu_test(obbs_time_of_impact(box, {20, 0, 0}, wall, t_first, t_last));
+		mu_test(t_first > 0.4f && t_first < 0.45f && t_last > 0.55f && t_last < 0.6f);
+		mu_test(obbs_intersect(obb_from_aabb(unit, rotation_y(0.0f, {-10 + 20 * (t_first + 1e-3f), 0, 0})), wall));
+		mu_test(obbs_intersect(obb_from_aabb(unit, rotation_y(0.0f, {-10 + 20 * (t_first - 1e-3f), 0, 0})), wall) == false);
+
+		// passing above it, and stopping short of it
+		mu_test(obbs_time_of_impact(box, {20, -14, 0}, wall, t_first, t_last) == false);
+		mu_test(obbs_time_of_impact(box, {8, 0, 0}, wall, t_first, t_last) == false);
+	}
+
+	// tetrahedron through a one quad wall, tip first
+	{
+		CollisionMesh wall {};
+		wall.triangles.push_back(CollisionTriangle {.v = {{0, -5, -5}, {0, 5, -5}, {0, -5, 5}}});
+		wall.triangles.push_back(CollisionTriangle {.v = {{0, 5, -5}, {0, 5, 5}, {0, -5, 5}}});
+		collision_mesh_build(wall);
+
+		CollisionMesh tetrahedron {};
+		const glm::vec3 p[4] {{0, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[0], p[1], p[2]}});
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[0], p[1], p[3]}});
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[0], p[2], p[3]}});
+		tetrahedron.triangles.push_back(CollisionTriangle {.v = {p[1], p[2], p[3]}});
+		collision_mesh_build(tetrahedron);
+
+		const CollisionBody body_wall {.mesh = &wall, .transformation = glm::mat4{1.0f}};
+		const CollisionBody body_tetrahedron {.mesh = &tetrahedron, .transformation = rotation_y(glm::pi<float>(), {-20, 0, 0})};
+
+		// rotated by pi, its tip at x = -19 leads, touches at x = 0
+		float t = -1;
+		mu_test(collision_bodies_time_of_impact(body_tetrahedron, {40, 0, 0}, body_wall, t));
+		mu_test(std::abs(t - 19.0f / 40) < 0.01f);
+		mu_test(collision_bodies_time_of_impact(body_tetrahedron, {40, 0, 20}, body_wall, t) == false);
+	}
+}
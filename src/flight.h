@@ -0,0 +1,474 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include <mu/utils.h>
+
+#include "settings.h"
+#include "sim.h"
+#include "simd.h"
+
+// Cl and Cd of an aircraft every FLIGHT_AERO_STEP degrees of AoA over [-180, 180], baked from its DAT at load
+// last sample is repeated so interpolating at 180 doesn't read past the end
+constexpr int FLIGHT_AERO_SAMPLES = 361;
+constexpr float FLIGHT_AERO_STEP = 360.0f / (FLIGHT_AERO_SAMPLES - 1);
+
+struct FlightAeroTable {
+	float cl[FLIGHT_AERO_SAMPLES + 1];
+	float cd[FLIGHT_AERO_SAMPLES + 1];
+};
+
+// all zeros, lanes without an aircraft point to it
+inline const FlightAeroTable FLIGHT_AERO_TABLE_ZERO {};
+
+template<typename F>
+inline void flight_aero_table_bake(FlightAeroTable& self, F&& cl_cd) {
+	for (int i = 0; i < FLIGHT_AERO_SAMPLES; i++) {
+		const auto [cl, cd] = cl_cd(-180.0f + i * FLIGHT_AERO_STEP);
+		self.cl[i] = cl;
+		self.cd[i] = cd;
+	}
+	self.cl[FLIGHT_AERO_SAMPLES] = self.cl[FLIGHT_AERO_SAMPLES - 1];
+	self.cd[FLIGHT_AERO_SAMPLES] = self.cd[FLIGHT_AERO_SAMPLES - 1];
+}
+
+// air density every FLIGHT_ATMOSPHERE_STEP meters of altitude, constant above the last sample
+constexpr int FLIGHT_ATMOSPHERE_SAMPLES = 81;
+constexpr float FLIGHT_ATMOSPHERE_STEP = 250.0f; // m, up to 20km
+
+// kg/m^3, International Standard Atmosphere troposphere (lapse rate) then lower stratosphere (isothermal)
+// https://en.wikipedia.org/wiki/International_Standard_Atmosphere, https://en.wikipedia.org/wiki/Barometric_formula
+inline float flight_air_density_isa(float altitude) {
+	constexpr float SEA_PRESSURE = 101325.0f;  // Pa
+	constexpr float SEA_TEMP = 288.15f;        // kelvin
+	constexpr float LAPSE_RATE = 0.0065f;      // kelvin/m
+	constexpr float TROPOPAUSE_ALT = 11000.0f; // m
+	constexpr float GAS_CONSTANT = 287.05f;    // J/(kg·K), dry air
+	constexpr float GRAVITY = 9.80665f;
+
+	const float troposphere_alt = std::min(altitude, TROPOPAUSE_ALT);
+	const float temp = SEA_TEMP - LAPSE_RATE * troposphere_alt;
+	float pressure = SEA_PRESSURE * std::pow(temp / SEA_TEMP, GRAVITY / (GAS_CONSTANT * LAPSE_RATE));
+	if (altitude > TROPOPAUSE_ALT) {
+		pressure *= std::exp(-GRAVITY * (altitude - TROPOPAUSE_ALT) / (GAS_CONSTANT * temp));
+	}
+	return pressure / (GAS_CONSTANT * temp);
+}
+
+struct FlightAtmosphere {
+	float density[FLIGHT_ATMOSPHERE_SAMPLES + 1];
+};
+
+inline FlightAtmosphere flight_atmosphere_new() {
+	FlightAtmosphere self {};
+	for (int i = 0; i < FLIGHT_ATMOSPHERE_SAMPLES; i++) {
+		self.density[i] = flight_air_density_isa(i * FLIGHT_ATMOSPHERE_STEP);
+	}
+	self.density[FLIGHT_ATMOSPHERE_SAMPLES] = self.density[FLIGHT_ATMOSPHERE_SAMPLES - 1];
+	return self;
+}
+
+inline const FlightAtmosphere FLIGHT_ATMOSPHERE = flight_atmosphere_new();
+
+// lane i interpolates `rows[i]` at fractional index `t[i]`, t must be in [0, samples-1] and rows padded by one,
+// only the loads are per lane, SSE2 has no gather
+inline Float4 _flight_lut_lerp(const float* const rows[4], Float4 t) {
+	const Float4 index = float4_trunc(t);
+	const Float4 frac = t - index;
+
+	float indices[4], lo[4], hi[4];
+	float4_store(indices, index);
+	for (int i = 0; i < 4; i++) {
+		const int j = int(indices[i]);
+		lo[i] = rows[i][j];
+		hi[i] = rows[i][j+1];
+	}
+
+	const Float4 a = float4_load(lo);
+	return a + (float4_load(hi) - a) * frac;
+}
+
+// kg/m^3 at world `y` (negative above ground)
+inline Float4 flight_air_density(Float4 y) {
+	const float* const rows[4] = {FLIGHT_ATMOSPHERE.density, FLIGHT_ATMOSPHERE.density, FLIGHT_ATMOSPHERE.density, FLIGHT_ATMOSPHERE.density};
+	const Float4 t = float4_min(float4_abs(y) * (1.0f / FLIGHT_ATMOSPHERE_STEP), FLIGHT_ATMOSPHERE_SAMPLES - 1);
+	return _flight_lut_lerp(rows, t);
+}
+
+// AoA in degrees, in [-180, 180]
+inline void flight_aero_lookup(const FlightAeroTable* const tables[4], Float4 aoa, Float4& cl, Float4& cd) {
+	const Float4 t = float4_clamp((aoa + 180.0f) * (1.0f / FLIGHT_AERO_STEP), 0.0f, FLIGHT_AERO_SAMPLES - 1);
+	const float* const cl_rows[4] = {tables[0]->cl, tables[1]->cl, tables[2]->cl, tables[3]->cl};
+	const float* const cd_rows[4] = {tables[0]->cd, tables[1]->cd, tables[2]->cd, tables[3]->cd};
+	cl = _flight_lut_lerp(cl_rows, t);
+	cd = _flight_lut_lerp(cd_rows, t);
+}
+
+// velocity changes in flight_block_step don't multiply by dt, they were tuned per frame at the default 60 fps limit,
+// so they are scaled to keep the same change per second at SIM_STEP
+constexpr float FLIGHT_DT_FREE_TUNING_SCALE = SIM_STEP * 60;
+constexpr float FLIGHT_GRAVITY = 9.86f;
+constexpr float FLIGHT_WATTS_PER_HP = 745.69f;
+
+// N, of an engine at `engine_speed` in [0, 1], same as flight_block_step
+inline float flight_thrust(float engine_speed, float max_power, float idle_power, float thrust_multiplier) {
+	return (engine_speed * max_power + (1.0f - engine_speed) * idle_power) * FLIGHT_WATTS_PER_HP * thrust_multiplier;
+}
+
+// aircrafts per block, kernel steps them 4 (a Float4) at a time
+constexpr int FLIGHT_LANES = 8;
+
+// hot flight state of FLIGHT_LANES aircrafts, a field holds it for all of them so the kernel loads
+// a field of 4 aircrafts with one instruction, unused lanes are zeros and kernel keeps them finite
+struct FlightBlock {
+	// state, stepped by the kernel
+	float px[FLIGHT_LANES], py[FLIGHT_LANES], pz[FLIGHT_LANES];
+	float vx[FLIGHT_LANES], vy[FLIGHT_LANES], vz[FLIGHT_LANES];
+	float qw[FLIGHT_LANES], qx[FLIGHT_LANES], qy[FLIGHT_LANES], qz[FLIGHT_LANES];
+	float wx[FLIGHT_LANES], wy[FLIGHT_LANES], wz[FLIGHT_LANES]; // angular velocity, local
+
+	// engine and controls
+	float engine_speed[FLIGHT_LANES]; // [0, 1]
+	float engine_on[FLIGHT_LANES];    // 0 when cutoff, float so it blends instead of branching
+	float elevator[FLIGHT_LANES], rudder[FLIGHT_LANES], aileron[FLIGHT_LANES];
+	float braking[FLIGHT_LANES];      // 0 or 1
+
+	// world y of terrain under the aircraft (terrain_sample), 0 where there's none
+	float ground_y[FLIGHT_LANES];
+
+	// constants, mostly from DAT
+	float mass[FLIGHT_LANES]; // same units as aircraft_mass_total, fuel included
+	float max_power[FLIGHT_LANES], idle_power[FLIGHT_LANES]; // HP
+	float thrust_multiplier[FLIGHT_LANES];
+	float max_velocity[FLIGHT_LANES], wing_area[FLIGHT_LANES], friction_coeff[FLIGHT_LANES], wheelbase[FLIGHT_LANES];
+	float inertia_inv_x[FLIGHT_LANES], inertia_inv_y[FLIGHT_LANES], inertia_inv_z[FLIGHT_LANES]; // diagonal, kg·m²
+	float thrust_offset_x[FLIGHT_LANES], thrust_offset_y[FLIGHT_LANES];
+	const FlightAeroTable* aero[FLIGHT_LANES]; // owned by the aircraft, never null
+
+	// written by the kernel, for HUD and debug UI
+	float ax[FLIGHT_LANES], ay[FLIGHT_LANES], az[FLIGHT_LANES];
+	float tx[FLIGHT_LANES], ty[FLIGHT_LANES], tz[FLIGHT_LANES];
+	float thrust[FLIGHT_LANES], drag[FLIGHT_LANES], airlift[FLIGHT_LANES], weight[FLIGHT_LANES];
+};
+
+// aircraft `i` is lane `i % FLIGHT_LANES` of block `i / FLIGHT_LANES`
+struct FlightStates {
+	mu::Vec<FlightBlock> blocks;
+	size_t count;
+};
+
+inline void flight_states_clear(FlightStates& self) {
+	self.blocks.clear();
+	self.count = 0;
+}
+
+// adds a zeroed aircraft, returns its index
+inline size_t flight_states_push(FlightStates& self) {
+	if (self.count % FLIGHT_LANES == 0) {
+		FlightBlock block {};
+		for (auto& aero : block.aero) {
+			aero = &FLIGHT_AERO_TABLE_ZERO;
+		}
+		self.blocks.push_back(block);
+	}
+	return self.count++;
+}
+
+// Abramowitz & Stegun 4.4.45, error below 7e-5 radians
+inline Float4 _flight_acos(Float4 x) {
+	const Float4 ax = float4_abs(x);
+	const Float4 r = float4_sqrt(float4_max(1.0f - ax, 0.0f)) * (1.5707288f + ax*(-0.2121144f + ax*(0.0742610f - 0.0187293f*ax)));
+	return float4_select(x < 0.0f, RADIANS_MAX/2 - r, r);
+}
+
+// taylor series, good to 1e-5 for nose wheel angles (|x| <= MAX_WHEEL_STEER_ANGLE)
+inline Float4 _flight_tan(Float4 x) {
+	const Float4 x2 = x*x;
+	return x * (1.0f + x2*(1.0f/3 + x2*(2.0f/15 + x2*(17.0f/315 + x2*(62.0f/2835)))));
+}
+
+// one SIM_STEP of forces, rotation and translation of all lanes of a block
+inline void flight_block_step(FlightBlock& b, float brake_coeff) {
+	constexpr float DT_FREE_TUNING_SCALE = FLIGHT_DT_FREE_TUNING_SCALE;
+	constexpr float DT = SIM_STEP;
+	constexpr float GRAVITY = FLIGHT_GRAVITY;
+
+	for (int l = 0; l < FLIGHT_LANES; l += 4) {
+		const auto load = [l](const float (&field)[FLIGHT_LANES]) { return float4_load(field + l); };
+		const auto store = [l](float (&field)[FLIGHT_LANES], Float4 value) { float4_store(field + l, value); };
+
+		const Float4 px = load(b.px), py = load(b.py), pz = load(b.pz);
+		const Float4 vx = load(b.vx), vy = load(b.vy), vz = load(b.vz);
+		const Float4 qw = load(b.qw), qx = load(b.qx), qy = load(b.qy), qz = load(b.qz);
+		const Float4 elevator = load(b.elevator), rudder = load(b.rudder), aileron = load(b.aileron);
+		const Float4 raw_mass = load(b.mass);
+		const Float4 max_velocity = load(b.max_velocity);
+		const Float4 wing_area = load(b.wing_area);
+
+		// front = q*(0,0,1), up = -q*(0,1,0), as in local_euler_angles_from_quat
+		const Float4 front_y = 2.0f*(qy*qz - qw*qx);
+		const Float4 up_y = -(1.0f - 2.0f*(qx*qx + qz*qz));
+
+		const Float4 air_density = flight_air_density(py);
+
+		const Float4 vel_sq = vx*vx + vy*vy + vz*vz;
+		const Float4 vel = float4_sqrt(vel_sq);
+
+		// forces
+		const Float4 engine_speed = load(b.engine_speed);
+		const Float4 engine_power_hp = load(b.engine_on) * (engine_speed * load(b.max_power) + (1.0f - engine_speed) * load(b.idle_power));
+		const Float4 thrust = engine_power_hp * FLIGHT_WATTS_PER_HP * load(b.thrust_multiplier);
+
+		// same as aircraft_angle_of_attack
+		Float4 aoa = 90.0f + float4_select(up_y > 0.0f, 1.0f, -1.0f) * _flight_acos(-front_y) * (DEGREES_MAX / RADIANS_MAX);
+		aoa = aoa - float4_select(aoa > 180.0f, 360.0f, 0.0f);
+
+		Float4 cl, cd;
+		flight_aero_lookup(b.aero + l, aoa, cl, cd);
+
+		// https://www.grc.nasa.gov/www/k-12/VirtualAero/BottleRocket/airplane/drageq.html
+		const Float4 drag = cd * air_density * vel_sq * (0.05f * wing_area);
+
+		// https://www.grc.nasa.gov/www/k-12/VirtualAero/BottleRocket/airplane/lifteq.html
+
+		// elevator deflection → lift contribution (tail downforce)
+		const Float4 airlift = cl * air_density * vel_sq * wing_area + elevator * ELEVATOR_LIFT_SCALE * air_density * vel_sq;
+
+		// ground proximity factor: 1 on ground (1m above terrain), 0 at 1m above that
+		const Float4 ground_rest_y = load(b.ground_y) - 1.0f;
+		const Float4 ground_factor = float4_clamp(py - ground_rest_y + 1.0f, 0.0f, 1.0f);
+		const Bool4 near_ground = ground_factor > 0.0f;
+		const Bool4 on_ground = py >= ground_rest_y;
+
+		const Float4 mass = float4_max(raw_mass, 1.0f);
+		const Float4 weight = float4_select(near_ground, 0.0f, raw_mass * GRAVITY);
+
+		// rotation — proportional tracking controller, torque = I · K · (ω_desired - ω)
+		// → α = I⁻¹ · torque = K · error (inertia cancels, pure first-order response)
+		Float4 nqw, nqx, nqy, nqz; {
+			constexpr float CTRL_BANDWIDTH = 6.0f; // ~0.17s time constant
+
+			const Float4 wx = load(b.wx), wy = load(b.wy), wz = load(b.wz);
+			const Float4 v_ratio = float4_clamp(vel_sq / float4_max(max_velocity * max_velocity, 1e-6f), 0.0f, 1.0f);
+
+			// desired angular velocity from control surfaces
+			const Float4 desired_x = -elevator * ELEVATOR_EFFICIENCY * v_ratio;
+			const Float4 desired_y = rudder * RUDDER_EFFICIENCY * v_ratio + aileron * ADVERSE_YAW_COEFF * v_ratio;
+			const Float4 desired_z = aileron * ROLL_EFFICIENCY * v_ratio;
+
+			const Float4 ix = load(b.inertia_inv_x), iy = load(b.inertia_inv_y), iz = load(b.inertia_inv_z);
+			const Float4 ctrl_x = (desired_x - wx) * CTRL_BANDWIDTH / float4_max(ix, 1e-30f);
+			const Float4 ctrl_y = (desired_y - wy) * CTRL_BANDWIDTH / float4_max(iy, 1e-30f);
+			const Float4 ctrl_z = (desired_z - wz) * CTRL_BANDWIDTH / float4_max(iz, 1e-30f);
+
+			// thrust arm torque, cross(thrust_offset, {0,0,thrust}), thrust_multiplier fudges thrust ~5700× so scaled by 1e-4
+			const Float4 tx = float4_select(ix > 0.0f, ctrl_x, 0.0f) + load(b.thrust_offset_y) * thrust * 1e-4f;
+			const Float4 ty = float4_select(iy > 0.0f, ctrl_y, 0.0f) - load(b.thrust_offset_x) * thrust * 1e-4f;
+			const Float4 tz = float4_select(iz > 0.0f, ctrl_z, 0.0f);
+
+			// ground override, nose wheel steers
+			const Float4 ground_yaw = vel * _flight_tan(rudder * MAX_WHEEL_STEER_ANGLE) / float4_max(load(b.wheelbase), 0.01f);
+			const Float4 nwx = float4_select(on_ground, 0.0f, wx + ix * tx * DT);
+			const Float4 nwy = float4_select(on_ground, ground_yaw, wy + iy * ty * DT);
+			const Float4 nwz = float4_select(on_ground, 0.0f, wz + iz * tz * DT);
+
+			// q = q * angleAxis(|ω|·dt, ω/|ω|), sin/cos of the small half angle by taylor series
+			const Float4 h_sq = (nwx*nwx + nwy*nwy + nwz*nwz) * (DT*DT/4);
+			const Float4 dw = 1.0f - h_sq/2.0f + h_sq*h_sq/24.0f;
+			const Float4 ds = (DT/2) * (1.0f - h_sq/6.0f + h_sq*h_sq/120.0f);
+			const Float4 dx = nwx * ds, dy = nwy * ds, dz = nwz * ds;
+
+			nqw = qw*dw - qx*dx - qy*dy - qz*dz;
+			nqx = qw*dx + qx*dw + qy*dz - qz*dy;
+			nqy = qw*dy - qx*dz + qy*dw + qz*dx;
+			nqz = qw*dz + qx*dy - qy*dx + qz*dw;
+			const Float4 inv_len = 1.0f / float4_sqrt(float4_max(nqw*nqw + nqx*nqx + nqy*nqy + nqz*nqz, 1e-12f));
+			nqw = nqw * inv_len; nqx = nqx * inv_len; nqy = nqy * inv_len; nqz = nqz * inv_len;
+
+			store(b.wx, nwx); store(b.wy, nwy); store(b.wz, nwz);
+			store(b.tx, tx); store(b.ty, ty); store(b.tz, tz);
+		}
+
+		// translation, forces act along the new orientation
+		{
+			const Float4 front_x = 2.0f*(nqx*nqz + nqw*nqy);
+			const Float4 front_y = 2.0f*(nqy*nqz - nqw*nqx);
+			const Float4 front_z = 1.0f - 2.0f*(nqx*nqx + nqy*nqy);
+			const Float4 up_x = -2.0f*(nqx*nqy - nqw*nqz);
+			const Float4 up_y = -(1.0f - 2.0f*(nqx*nqx + nqz*nqz));
+			const Float4 up_z = -2.0f*(nqy*nqz + nqw*nqx);
+
+			const Float4 forward = thrust - drag;
+			const Float4 ax = (up_x*airlift + front_x*forward) / mass;
+			const Float4 ay = (weight + up_y*airlift + front_y*forward) / mass;
+			const Float4 az = (up_z*airlift + front_z*forward) / mass;
+
+			Float4 nvx = vx + ax * DT_FREE_TUNING_SCALE;
+			Float4 nvy = vy + ay * DT_FREE_TUNING_SCALE;
+			Float4 nvz = vz + az * DT_FREE_TUNING_SCALE;
+
+			const Float4 vel_mag = float4_sqrt(nvx*nvx + nvy*nvy + nvz*nvz);
+			const Float4 vel_scale = float4_select(vel_mag > max_velocity, max_velocity / float4_max(vel_mag, 1e-8f), 1.0f);
+			nvx = nvx * vel_scale; nvy = nvy * vel_scale; nvz = nvz * vel_scale;
+
+			// ground effects: friction + brake as velocity damping
+			const Bool4 ground_effects = near_ground & (vel_mag > 0.01f);
+			// airlift is in Newtons; weight is zeroed on ground, so recompute full weight here
+			const Float4 normal_force = float4_max(raw_mass * GRAVITY - airlift, 0.0f);
+
+			// rolling friction opposes horizontal velocity
+			const Float4 hor_vel_sq = nvx*nvx + nvz*nvz;
+			const Float4 hor_vel = float4_sqrt(float4_max(hor_vel_sq, 1e-8f));
+			const Float4 friction_dv = float4_min(load(b.friction_coeff) * normal_force / mass * ground_factor * DT_FREE_TUNING_SCALE, hor_vel);
+			const Float4 friction_scale = float4_select(ground_effects & (hor_vel_sq > 0.0001f), friction_dv / hor_vel, 0.0f);
+			nvx = nvx - nvx * friction_scale;
+			nvz = nvz - nvz * friction_scale;
+
+			// brake opposes total velocity
+			const Float4 braked_vel = float4_sqrt(float4_max(nvx*nvx + nvy*nvy + nvz*nvz, 1e-8f));
+			const Float4 brake_dv = float4_min(brake_coeff * normal_force / mass * ground_factor * DT_FREE_TUNING_SCALE, vel_mag);
+			const Float4 brake_scale = float4_select(ground_effects & (load(b.braking) > 0.0f), brake_dv / braked_vel, 0.0f);
+			nvx = nvx - nvx * brake_scale;
+			nvy = nvy - nvy * brake_scale;
+			nvz = nvz - nvz * brake_scale;
+
+			// soft push toward ground when proximity active
+			Float4 npy = py + DT * nvy;
+			npy = npy + (ground_rest_y - npy) * ground_factor * (DT * 5.0f);
+
+			store(b.px, px + DT * nvx);
+			store(b.py, float4_min(npy, ground_rest_y));
+			store(b.pz, pz + DT * nvz);
+			store(b.vx, nvx); store(b.vy, nvy); store(b.vz, nvz);
+			store(b.ax, ax); store(b.ay, ay); store(b.az, az);
+		}
+
+		store(b.qw, nqw); store(b.qx, nqx); store(b.qy, nqy); store(b.qz, nqz);
+		store(b.thrust, thrust);
+		store(b.drag, drag);
+		store(b.airlift, airlift);
+		store(b.weight, weight);
+	}
+}
+
+inline void flight_states_step(FlightStates& self, float brake_coeff) {
+	for (auto& block : self.blocks) {
+		flight_block_step(block, brake_coeff);
+	}
+}
+
+inline void test_flight_states() {
+	mu_test_suite("test_flight_states");
+
+	// free fall from rest, engine off, only weight acts
+	{
+		FlightStates states {};
+		const size_t i = flight_states_push(states);
+		auto& b = states.blocks[0];
+		b.py[i] = -1000;
+		b.qw[i] = 1;
+		b.mass[i] = 2e6;
+		b.max_velocity[i] = 100;
+
+		flight_states_step(states, 1);
+		mu_test(std::abs(b.vy[i] - 9.86f * SIM_STEP * 60) < 1e-4f);
+		mu_test(std::abs(b.py[i] - (-1000 + b.vy[i] * SIM_STEP)) < 1e-3f);
+		mu_test(b.vx[i] == 0 && b.vz[i] == 0);
+		mu_test(b.weight[i] == 2e6f * 9.86f);
+	}
+
+	// constant angular velocity (no inertia, so it isn't controlled) turns 1 radian in one second
+	{
+		FlightStates states {};
+		flight_states_push(states);
+		const size_t i = flight_states_push(states);
+		auto& b = states.blocks[0];
+		b.py[i] = -1000;
+		b.qw[i] = 1;
+		b.wx[i] = 1;
+
+		for (int step = 0; step < 120; step++) {
+			flight_states_step(states, 1);
+		}
+		mu_test(std::abs(b.qw[i] - std::cos(0.5f)) < 1e-4f);
+		mu_test(std::abs(b.qx[i] - std::sin(0.5f)) < 1e-4f);
+		mu_test(std::abs(b.qy[i]) < 1e-6f && std::abs(b.qz[i]) < 1e-6f);
+	}
+
+	// rests 1m above terrain under it, not above y=0
+	{
+		FlightStates states {};
+		const size_t i = flight_states_push(states);
+		auto& b = states.blocks[0];
+		b.py[i] = -101;
+		b.ground_y[i] = -100;
+		b.qw[i] = 1;
+		b.mass[i] = 2e6;
+		b.max_velocity[i] = 100;
+
+		for (int step = 0; step < 120; step++) {
+			flight_states_step(states, 1);
+		}
+		mu_test(std::abs(b.py[i] - (-101)) < 1e-3f);
+		mu_test(b.weight[i] == 0);
+	}
+
+	// unused lanes stay finite
+	{
+		FlightStates states {};
+		flight_states_push(states);
+		flight_states_step(states, 1);
+		for (int l = 0; l < FLIGHT_LANES; l++) {
+			const auto& b = states.blocks[0];
+			mu_test(std::isfinite(b.px[l]) && std::isfinite(b.vy[l]) && std::isfinite(b.qw[l]) && std::isfinite(b.ay[l]));
+		}
+	}
+
+	// atmosphere table against the formula it's baked from
+	{
+		mu_test(std::abs(flight_air_density_isa(0) - 1.225f) < 1e-3f);
+		mu_test(std::abs(flight_air_density_isa(11000) - 0.3639f) < 1e-3f);
+		mu_test(std::abs(flight_air_density_isa(20000) - 0.0880f) < 1e-3f);
+
+		float max_error = 0;
+		for (float altitude = 0; altitude < 25000; altitude += 10) {
+			const float table = float4_first(flight_air_density(-altitude));
+			const float isa = flight_air_density_isa(std::min(altitude, (FLIGHT_ATMOSPHERE_SAMPLES - 1) * FLIGHT_ATMOSPHERE_STEP));
+			max_error = std::max(max_error, std::abs(table - isa) / isa);
+		}
+		mu_test(max_error < 1e-3f);
+	}
+
+	// aero table interpolates exactly between samples of a piecewise linear curve, and per lane
+	{
+		FlightAeroTable table {};
+		flight_aero_table_bake(table, [](float aoa) { return std::pair{0.1f * aoa, aoa < 0? 0.5f : 1.0f}; });
+
+		const FlightAeroTable* const tables[4] = {&table, &table, &FLIGHT_AERO_TABLE_ZERO, &table};
+		const float aoas[4] = {-180, 12.25f, 30, 180};
+		float cl[4], cd[4];
+		Float4 cl4, cd4;
+		flight_aero_lookup(tables, float4_load(aoas), cl4, cd4);
+		float4_store(cl, cl4);
+		float4_store(cd, cd4);
+		mu_test(std::abs(cl[0] - -18.0f) < 1e-4f && cd[0] == 0.5f);
+		mu_test(std::abs(cl[1] - 1.225f) < 1e-4f && cd[1] == 1.0f);
+		mu_test(cl[2] == 0 && cd[2] == 0);
+		mu_test(std::abs(cl[3] - 18.0f) < 1e-4f && cd[3] == 1.0f);
+	}
+
+	// approximations against std
+	{
+		const float xs[4] = {-1, -0.3f, 0.3f, MAX_WHEEL_STEER_ANGLE};
+		float acos_x[4], tan_x[4];
+		float4_store(acos_x, _flight_acos(float4_load(xs)));
+		float4_store(tan_x, _flight_tan(float4_load(xs)));
+		for (int i = 0; i < 4; i++) {
+			mu_test(std::abs(acos_x[i] - std::acos(xs[i])) < 1e-4f);
+		}
+		mu_test(std::abs(tan_x[3] - std::tan(MAX_WHEEL_STEER_ANGLE)) < 1e-5f);
+	}
+}
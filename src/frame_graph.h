@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <atomic>
+#include <functional>
+
+#include <mu/utils.h>
+
+#include "workers.h"
+
+// parts of World systems in a frame graph read or write
+enum FrameResource : uint32_t {
+	FRAME_RESOURCE_AIRCRAFTS     = 1 << 0,
+	FRAME_RESOURCE_GROUND_OBJS   = 1 << 1,
+	FRAME_RESOURCE_SCENERY       = 1 << 2,
+	FRAME_RESOURCE_BROADPHASE    = 1 << 3,
+	FRAME_RESOURCE_CAMERA        = 1 << 4,
+	FRAME_RESOURCE_MATS          = 1 << 5,
+	FRAME_RESOURCE_EVENTS        = 1 << 6,
+	FRAME_RESOURCE_AUDIO         = 1 << 7,
+	FRAME_RESOURCE_RECORDER      = 1 << 8,
+	FRAME_RESOURCE_REPLAY        = 1 << 9,
+	// SimThread::arena, it isn't thread safe
+	FRAME_RESOURCE_SIM_ARENA     = 1 << 10,
+	// CanvasFrame::text_overlay_list, see TEXT_OVERLAY
+	FRAME_RESOURCE_TEXT_OVERLAY  = 1 << 11,
+	// one bit per CanvasLane, see `frame_resource_canvas_lane`, then list they're merged into
+	FRAME_RESOURCE_CANVAS_LANES  = 0xff << 12,
+	FRAME_RESOURCE_CANVAS_MERGED = 1 << 20,
+	FRAME_RESOURCE_TRAFFIC       = 1 << 21,
+};
+
+constexpr uint32_t frame_resource_canvas_lane(uint32_t lane) {
+	return (1 << 12) << lane;
+}
+
+struct FrameGraphNode {
+	const char* name;
+	std::function<void()> system;
+	uint32_t reads, writes;
+
+	mu::Vec<uint32_t> successors;
+	uint32_t predecessors_count;
+};
+
+// systems in the order a serial frame calls them, each states which FrameResource it reads and writes
+// a system runs after every earlier one that writes what it reads or writes, or reads what it writes,
+// so results are the same as calling them one after another and the rest run in parallel on workers
+struct FrameGraph {
+	mu::Vec<FrameGraphNode> nodes;
+
+	// predecessors of each node not done yet while running
+	std::unique_ptr<std::atomic<uint32_t>[]> pending;
+};
+
+inline void frame_graph_add(FrameGraph& self, const char* name, std::function<void()>&& system, uint32_t reads, uint32_t writes) {
+	const uint32_t index = self.nodes.size();
+	uint32_t predecessors_count = 0;
+	for (uint32_t i = 0; i < index; i++) {
+		auto& earlier = self.nodes[i];
+		if ((writes & (earlier.reads | earlier.writes)) || (reads & earlier.writes)) {
+			earlier.successors.push_back(index);
+			predecessors_count++;
+		}
+	}
+
+	self.nodes.push_back(FrameGraphNode {
+		.name = name,
+		.system = std::move(system),
+		.reads = reads,
+		.writes = writes,
+		.predecessors_count = predecessors_count,
+	});
+	self.pending = std::make_unique<std::atomic<uint32_t>[]>(self.nodes.size());
+}
+
+inline void _frame_graph_node_run(FrameGraph& self, Workers& workers, WorkersCounter& counter, uint32_t index) {
+	self.nodes[index].system();
+
+	// spawned before this job's counter is decremented, so counter can't reach 0 in between
+	for (uint32_t successor : self.nodes[index].successors) {
+		if (self.pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			workers_spawn(workers, counter, self.nodes[successor].name, [&self, &workers, &counter, successor] {
+				_frame_graph_node_run(self, workers, counter, successor);
+			});
+		}
+	}
+}
+
+// runs all systems, returns when they're done, not reentrant
+inline void frame_graph_run(FrameGraph& self, Workers& workers) {
+	WorkersCounter counter {};
+	for (uint32_t i = 0; i < self.nodes.size(); i++) {
+		self.pending[i].store(self.nodes[i].predecessors_count, std::memory_order_relaxed);
+	}
+	for (uint32_t i = 0; i < self.nodes.size(); i++) {
+		if (self.nodes[i].predecessors_count == 0) {
+			workers_spawn(workers, counter, self.nodes[i].name, [&self, &workers, &counter, i] {
+				_frame_graph_node_run(self, workers, counter, i);
+			});
+		}
+	}
+	workers_wait(workers, counter);
+}
+
+inline void test_frame_graph() {
+	mu_test_suite("frame_graph");
+
+	// edges only between conflicting systems
+	{
+		FrameGraph graph {};
+		frame_graph_add(graph, "a", [] {}, 0, FRAME_RESOURCE_AIRCRAFTS);
+		frame_graph_add(graph, "b", [] {}, FRAME_RESOURCE_SCENERY, FRAME_RESOURCE_GROUND_OBJS);
+		frame_graph_add(graph, "c", [] {}, FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_GROUND_OBJS, FRAME_RESOURCE_CAMERA);
+		frame_graph_add(graph, "d", [] {}, FRAME_RESOURCE_SCENERY, 0);
+		frame_graph_add(graph, "e", [] {}, 0, FRAME_RESOURCE_SCENERY);
+
+		mu_test(graph.nodes[0].predecessors_count == 0);
+		mu_test(graph.nodes[1].predecessors_count == 0);
+		mu_test(graph.nodes[2].predecessors_count == 2);
+		mu_test(graph.nodes[3].predecessors_count == 0);
+		// writer after readers
+		mu_test(graph.nodes[4].predecessors_count == 2);
+	}
+
+	// order kept between conflicting systems, on a pool and inline, with systems splitting work over slots
+	for (size_t count : {1, 4}) {
+		Workers workers {};
+		workers_init(workers, count);
+
+		std::atomic<uint32_t> clock {};
+		uint32_t done_at[4] {};
+		std::atomic<uint32_t> slots_done {};
+
+		FrameGraph graph {};
+		frame_graph_add(graph, "a", [&] { done_at[0] = ++clock; }, 0, FRAME_RESOURCE_AIRCRAFTS);
+		frame_graph_add(graph, "b", [&] {
+			workers_run(workers, [&](size_t) { slots_done++; });
+			done_at[1] = ++clock;
+		}, 0, FRAME_RESOURCE_GROUND_OBJS);
+		frame_graph_add(graph, "c", [&] { done_at[2] = ++clock; }, FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_GROUND_OBJS, 0);
+		frame_graph_add(graph, "d", [&] { done_at[3] = ++clock; }, 0, FRAME_RESOURCE_AIRCRAFTS);
+
+		bool ordered = true;
+		for (int i = 0; i < 100; i++) {
+			frame_graph_run(graph, workers);
+			ordered = ordered && done_at[2] > done_at[0] && done_at[2] > done_at[1] && done_at[3] > done_at[2];
+		}
+		mu_test(ordered);
+		mu_test(slots_done == 100 * workers_count(workers));
+
+		workers_timeline_begin(workers);
+		size_t spans = 0;
+		for (const auto& timeline : workers.timelines) {
+			spans += timeline.size();
+		}
+		mu_test(spans == 100 * (4 + workers_count(workers) - 1));
+
+		workers_free(workers);
+	}
+}
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <cstdio>
+#include <cstring> // memcpy
+#include <cmath> // NAN
+#include <iterator> // std::size
+#include <initializer_list>
+#include <filesystem>
+
 #include <glad/glad.h>
 #include <mu/utils.h>
 
@@ -31,11 +38,321 @@ inline GLfloat gl_get_float(GLenum e) {
 	return out;
 }
 
+// kinds of calls that go through GLState
+enum GLStateCall {
+	GL_STATE_CALL_USE_PROGRAM,
+	GL_STATE_CALL_BIND_VERTEX_ARRAY,
+	GL_STATE_CALL_BIND_TEXTURE,
+	GL_STATE_CALL_CAPABILITY,
+	GL_STATE_CALL_LINE_WIDTH,
+	GL_STATE_CALL_POINT_SIZE,
+
+	GL_STATE_CALL_COUNT
+};
+
+constexpr const char* GL_STATE_CALL_NAMES[GL_STATE_CALL_COUNT] = {
+	"glUseProgram",
+	"glBindVertexArray",
+	"glBindTexture",
+	"glEnable/glDisable",
+	"glLineWidth",
+	"glPointSize",
+};
+
+constexpr int GL_STATE_TEXTURE_UNITS = 2;
+
+// capabilities canvas toggles, index in GLState::capabilities
+constexpr GLenum GL_STATE_CAPABILITIES[] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_LINE_SMOOTH };
+
+// last state set through it, calls that wouldn't change it never reach the driver
+// anything changing GL state behind its back (e.g. imgui) must be followed by `gl_state_invalidate`
+struct GLState {
+	// -1 is unknown
+	int64_t program, vertex_array;
+	int64_t textures[GL_STATE_TEXTURE_UNITS][2]; // [unit][GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY]
+	int64_t active_texture_unit;
+	int8_t capabilities[std::size(GL_STATE_CAPABILITIES)];
+	float line_width, point_size; // NaN is unknown
+
+	struct Stats {
+		size_t issued[GL_STATE_CALL_COUNT];
+		size_t elided[GL_STATE_CALL_COUNT];
+	} frame, last_frame;
+};
+
+// like GL itself, it's global to the context
+inline GLState gl_state;
+
+inline void gl_state_invalidate() {
+	auto& self = gl_state;
+	self.program = -1;
+	self.vertex_array = -1;
+	for (auto& unit : self.textures) {
+		unit[0] = unit[1] = -1;
+	}
+	self.active_texture_unit = -1;
+	for (auto& c : self.capabilities) {
+		c = -1;
+	}
+	self.line_width = self.point_size = NAN;
+}
+
+// keeps counts of ended frame in `last_frame`, state is invalidated since it's unknown what ran between frames
+inline void gl_state_frame_begin() {
+	gl_state.last_frame = gl_state.frame;
+	gl_state.frame = {};
+	gl_state_invalidate();
+}
+
+// returns whether the call should be issued
+inline bool _gl_state_update(GLStateCall call, auto& current, auto value) {
+	if (current == value) {
+		gl_state.frame.elided[call]++;
+		return false;
+	}
+	current = value;
+	gl_state.frame.issued[call]++;
+	return true;
+}
+
+inline void gl_state_use_program(GLuint program) {
+	if (_gl_state_update(GL_STATE_CALL_USE_PROGRAM, gl_state.program, int64_t(program))) {
+		glUseProgram(program);
+	}
+}
+
+inline void gl_state_bind_vertex_array(GLuint vertex_array) {
+	if (_gl_state_update(GL_STATE_CALL_BIND_VERTEX_ARRAY, gl_state.vertex_array, int64_t(vertex_array))) {
+		glBindVertexArray(vertex_array);
+	}
+}
+
+// `target` is GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+inline void gl_state_bind_texture(int unit, GLenum target, GLuint texture) {
+	mu_assert(unit >= 0 && unit < GL_STATE_TEXTURE_UNITS);
+	mu_assert(target == GL_TEXTURE_2D || target == GL_TEXTURE_2D_ARRAY);
+
+	auto& current = gl_state.textures[unit][target == GL_TEXTURE_2D ? 0 : 1];
+	if (_gl_state_update(GL_STATE_CALL_BIND_TEXTURE, current, int64_t(texture))) {
+		// only switched when a bind needs it, counted with binds
+		if (gl_state.active_texture_unit != unit) {
+			gl_state.active_texture_unit = unit;
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+		glBindTexture(target, texture);
+	}
+}
+
+// `cap` must be one of GL_STATE_CAPABILITIES
+inline void gl_state_capability_set(GLenum cap, bool enabled) {
+	size_t i = 0;
+	while (GL_STATE_CAPABILITIES[i] != cap) {
+		i++;
+		mu_assert(i < std::size(GL_STATE_CAPABILITIES));
+	}
+
+	if (_gl_state_update(GL_STATE_CALL_CAPABILITY, gl_state.capabilities[i], int8_t(enabled))) {
+		if (enabled) {
+			glEnable(cap);
+		} else {
+			glDisable(cap);
+		}
+	}
+}
+
+inline void gl_state_line_width(float width) {
+	if (_gl_state_update(GL_STATE_CALL_LINE_WIDTH, gl_state.line_width, width)) {
+		glLineWidth(width);
+	}
+}
+
+inline void gl_state_point_size(float size) {
+	if (_gl_state_update(GL_STATE_CALL_POINT_SIZE, gl_state.point_size, size)) {
+		glPointSize(size);
+	}
+}
+
 struct GLProgram {
 	GLuint id;
 };
 
-inline GLProgram gl_program_new(const char* vertex_shader_src, const char* fragment_shader_src) {
+// GL 3.3 core doesn't have program binaries, they come from GL_ARB_get_program_binary (core in 4.1)
+// which glad wasn't generated with, so its functions are loaded by `gl_program_cache_init`
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// linked programs saved to disk, so next launches skip compiling and linking
+// a binary is only valid for the driver that made it, so files are keyed by sources and driver strings
+struct GLProgramCache {
+	bool enabled;
+	mu::Str dir;
+	uint64_t driver_hash;
+
+	void (APIENTRYP get_program_binary)(GLuint program, GLsizei buf_size, GLsizei* length, GLenum* binary_format, void* binary);
+	void (APIENTRYP program_binary)(GLuint program, GLenum binary_format, const void* binary, GLsizei length);
+	void (APIENTRYP program_parameteri)(GLuint program, GLenum pname, GLint value);
+
+	size_t hits, misses;
+};
+
+// gl_program_new is called from everywhere without a context, like GL itself
+inline GLProgramCache gl_program_cache;
+
+constexpr uint32_t GL_PROGRAM_CACHE_MAGIC = 0x59534642; // "YSFB"
+
+inline uint64_t _gl_program_cache_hash(mu::StrView str, uint64_t hash = 0xcbf29ce484222325) {
+	// FNV-1a
+	for (char c : str) {
+		hash ^= uint8_t(c);
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+inline bool _gl_extension_supported(const char* name) {
+	GLint num_extensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+	for (GLint i = 0; i < num_extensions; i++) {
+		if (mu::StrView((const char*) glGetStringi(GL_EXTENSIONS, i)) == name) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// leaves cache disabled if driver can't give program binaries, `load_proc` is same loader given to glad
+inline void gl_program_cache_init(GLADloadproc load_proc, mu::StrView dir) {
+	auto& self = gl_program_cache;
+
+	const bool has_binaries = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1)
+		|| _gl_extension_supported("GL_ARB_get_program_binary");
+	GLint num_formats = 0;
+	if (has_binaries) {
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+	}
+	if (num_formats == 0) {
+		mu::log_info("shader cache: driver has no program binary formats, disabled");
+		return;
+	}
+
+	self.get_program_binary = (decltype(self.get_program_binary)) load_proc("glGetProgramBinary");
+	self.program_binary = (decltype(self.program_binary)) load_proc("glProgramBinary");
+	self.program_parameteri = (decltype(self.program_parameteri)) load_proc("glProgramParameteri");
+	if (!self.get_program_binary || !self.program_binary || !self.program_parameteri) {
+		mu::log_info("shader cache: failed to load program binary functions, disabled");
+		return;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(std::filesystem::path(dir.begin(), dir.end()), ec);
+	if (ec) {
+		mu::log_warning("shader cache: failed to create '{}', {}", dir, ec.message());
+		return;
+	}
+
+	self.dir = mu::Str(dir);
+	self.driver_hash = _gl_program_cache_hash((const char*) glGetString(GL_VENDOR));
+	self.driver_hash = _gl_program_cache_hash((const char*) glGetString(GL_RENDERER), self.driver_hash);
+	self.driver_hash = _gl_program_cache_hash((const char*) glGetString(GL_VERSION), self.driver_hash);
+	self.enabled = true;
+}
+
+inline mu::Str _gl_program_cache_file_path(const char* vertex_shader_src, const char* fragment_shader_src) {
+	auto& self = gl_program_cache;
+	auto hash = _gl_program_cache_hash(vertex_shader_src, self.driver_hash);
+	hash = _gl_program_cache_hash(fragment_shader_src, hash);
+	return mu::str_tmpf("{}/{:016x}.bin", self.dir, hash);
+}
+
+// returns 0 if there is no binary or the driver rejected it, e.g. after a driver update with same version string
+inline GLuint _gl_program_cache_load(mu::StrView file_path) {
+	auto& self = gl_program_cache;
+
+	FILE* f = fopen(mu::Str(file_path, mu::memory::tmp()).c_str(), "rb");
+	if (f == nullptr) {
+		return 0;
+	}
+	mu_defer(fclose(f));
+
+	if (fseek(f, 0, SEEK_END) != 0) {
+		return 0;
+	}
+	const long file_size = ftell(f);
+	rewind(f);
+
+	uint32_t magic = 0;
+	GLenum format = 0;
+	uint32_t length = 0;
+	if (fread(&magic, sizeof(magic), 1, f) != 1 || magic != GL_PROGRAM_CACHE_MAGIC
+		|| fread(&format, sizeof(format), 1, f) != 1 || fread(&length, sizeof(length), 1, f) != 1) {
+		return 0;
+	}
+	// binary is the rest of the file, a corrupt length must not size the allocation
+	const long header_size = sizeof(magic) + sizeof(format) + sizeof(length);
+	if (file_size < header_size || length != uint64_t(file_size - header_size)) {
+		return 0;
+	}
+	auto binary = mu::Vec<uint8_t>(length, mu::memory::tmp());
+	if (fread(binary.data(), 1, length, f) != length) {
+		return 0;
+	}
+
+	const GLuint program = glCreateProgram();
+	self.program_binary(program, format, binary.data(), length);
+
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glDeleteProgram(program);
+		// a rejected binary raises GL_INVALID_ENUM/GL_INVALID_VALUE, it's handled by compiling from source
+		// so it must not reach the next gl_process_errors
+		while (glGetError() != GL_NO_ERROR) {}
+		return 0;
+	}
+	return program;
+}
+
+inline void _gl_program_cache_save(mu::StrView file_path, GLuint program) {
+	auto& self = gl_program_cache;
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+	auto binary = mu::Vec<uint8_t>(length, mu::memory::tmp());
+	GLenum format = 0;
+	self.get_program_binary(program, length, nullptr, &format, binary.data());
+
+	// written next to it then renamed over it, so a crash mid-write never leaves a torn binary at `file_path`
+	const auto tmp_path = mu::str_tmpf("{}.tmp", file_path);
+	FILE* f = fopen(tmp_path.c_str(), "wb");
+	if (f == nullptr) {
+		mu::log_warning("shader cache: failed to open '{}'", tmp_path);
+		return;
+	}
+
+	const uint32_t u32_length = length;
+	bool written = fwrite(&GL_PROGRAM_CACHE_MAGIC, sizeof(GL_PROGRAM_CACHE_MAGIC), 1, f) == 1
+		&& fwrite(&format, sizeof(format), 1, f) == 1
+		&& fwrite(&u32_length, sizeof(u32_length), 1, f) == 1
+		&& fwrite(binary.data(), 1, length, f) == size_t(length);
+	written = fclose(f) == 0 && written;
+
+	std::error_code ec;
+	if (written) {
+		std::filesystem::rename(tmp_path.c_str(), std::filesystem::path(file_path.begin(), file_path.end()), ec);
+	}
+	if (written == false || ec) {
+		mu::log_warning("shader cache: failed to write '{}'", file_path);
+		std::filesystem::remove(tmp_path.c_str(), ec);
+	}
+}
+
+inline GLuint _gl_program_compile_and_link(const char* vertex_shader_src, const char* fragment_shader_src) {
 	// vertex shader
     const GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertex_shader, 1, &vertex_shader_src, NULL);
@@ -66,6 +383,9 @@ inline GLProgram gl_program_new(const char* vertex_shader_src, const char* fragm
     const GLuint gpu_program = glCreateProgram();
     glAttachShader(gpu_program, vertex_shader);
     glAttachShader(gpu_program, fragment_shader);
+    if (gl_program_cache.enabled) {
+    	gl_program_cache.program_parameteri(gpu_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(gpu_program);
 
 	GLint shader_program_success;
@@ -78,16 +398,39 @@ inline GLProgram gl_program_new(const char* vertex_shader_src, const char* fragm
     glDeleteShader(vertex_shader);
     glDeleteShader(fragment_shader);
 
-	return GLProgram { .id = gpu_program };
+	return gpu_program;
+}
+
+// loads program binary from gl_program_cache if it has it, otherwise compiles from source and saves its binary
+inline GLProgram gl_program_new(const char* vertex_shader_src, const char* fragment_shader_src) {
+	auto& cache = gl_program_cache;
+	if (cache.enabled == false) {
+		return GLProgram { .id = _gl_program_compile_and_link(vertex_shader_src, fragment_shader_src) };
+	}
+
+	const auto file_path = _gl_program_cache_file_path(vertex_shader_src, fragment_shader_src);
+	if (GLuint program = _gl_program_cache_load(file_path)) {
+		cache.hits++;
+		return GLProgram { .id = program };
+	}
+
+	cache.misses++;
+	const GLuint program = _gl_program_compile_and_link(vertex_shader_src, fragment_shader_src);
+	_gl_program_cache_save(file_path, program);
+	return GLProgram { .id = program };
 }
 
 inline void gl_program_free(GLProgram& self) {
+	// name may be reused by a new program, which then must not be skipped as already in use
+	if (gl_state.program == self.id) {
+		gl_state.program = -1;
+	}
 	glDeleteProgram(self.id);
 	self.id = 0;
 }
 
 inline void gl_program_use(GLProgram& self) {
-	glUseProgram(self.id);
+	gl_state_use_program(self.id);
 }
 
 inline void gl_program_uniform_set(GLProgram& self, const char* uniform, bool b) {
@@ -122,6 +465,87 @@ inline void gl_program_uniform_set(GLProgram& self, const char* uniform, const g
 	glUniformMatrix4fv(glGetUniformLocation(self.id, uniform), 1, transpose, glm::value_ptr(f));
 }
 
+// feature of a GLSL source that can be toggled per variant, source tests it with `if (macro)`
+struct GLProgramFeature {
+	const char* macro;
+	// bool uniform that replaces macro in uber program
+	const char* uniform;
+};
+
+// one GLSL source compiled into a program per used combination of features (bitmask), on first request
+// variants get `#define <macro> true/false` so the compiler drops branches of disabled features
+// `uber` compiles one program where each macro is its bool uniform, paying runtime branches
+// for all features on every fragment, kept to compare against variants
+struct GLProgramVariants {
+	mu::Str vertex_shader_src, fragment_shader_src;
+	mu::Vec<GLProgramFeature> features;
+	mu::Map<uint32_t, GLProgram> programs;
+	bool uber;
+};
+
+constexpr uint32_t GL_PROGRAM_VARIANTS_UBER_KEY = UINT32_MAX;
+
+inline GLProgramVariants gl_program_variants_new(const char* vertex_shader_src, const char* fragment_shader_src, std::initializer_list<GLProgramFeature> features) {
+	mu_assert(features.size() < 32);
+	return GLProgramVariants {
+		.vertex_shader_src = vertex_shader_src,
+		.fragment_shader_src = fragment_shader_src,
+		.features = features,
+	};
+}
+
+inline void gl_program_variants_free(GLProgramVariants& self) {
+	for (auto& [_, program] : self.programs) {
+		gl_program_free(program);
+	}
+	self.programs.clear();
+}
+
+// defines go right after #version line, it must be the first line of the source
+inline mu::Str _gl_program_variant_src(const GLProgramVariants& self, mu::StrView src, uint32_t key) {
+	const size_t version_begin = src.find("#version");
+	mu_assert_msg(version_begin != mu::StrView::npos, "shader source has no #version line");
+	const size_t version_end = src.find('\n', version_begin) + 1;
+
+	mu::Str out(src.substr(0, version_end), mu::memory::tmp());
+	for (size_t i = 0; i < self.features.size(); i++) {
+		const char* value;
+		if (key == GL_PROGRAM_VARIANTS_UBER_KEY) {
+			value = self.features[i].uniform;
+		} else {
+			value = (key & (1 << i)) ? "true" : "false";
+		}
+		out += mu::str_tmpf("#define {} {}\n", self.features[i].macro, value);
+	}
+	out += src.substr(version_end);
+	return out;
+}
+
+// compiles variant on first use, bits of `features` follow order of features given to gl_program_variants_new
+inline GLProgram& gl_program_variants_get(GLProgramVariants& self, uint32_t features) {
+	const uint32_t key = self.uber ? GL_PROGRAM_VARIANTS_UBER_KEY : features;
+
+	auto it = self.programs.find(key);
+	if (it != self.programs.end()) {
+		return it->second;
+	}
+
+	const auto vertex_shader_src = _gl_program_variant_src(self, self.vertex_shader_src, key);
+	const auto fragment_shader_src = _gl_program_variant_src(self, self.fragment_shader_src, key);
+	mu::log_debug("compiling program variant {:#x}", key);
+	return self.programs[key] = gl_program_new(vertex_shader_src.c_str(), fragment_shader_src.c_str());
+}
+
+// uber program reads features from uniforms, variants have them baked so this does nothing for them
+inline void gl_program_variants_features_set(GLProgramVariants& self, GLProgram& program, uint32_t features) {
+	if (self.uber == false) {
+		return;
+	}
+	for (size_t i = 0; i < self.features.size(); i++) {
+		gl_program_uniform_set(program, self.features[i].uniform, (features & (1 << i)) != 0);
+	}
+}
+
 struct GLVertexAttrib {
 	GLenum type;
 	size_t num_components;
@@ -171,7 +595,7 @@ GLBuf gl_buf_new(const mu::Vec<T>& buffer) {
 	};
 
 	glGenVertexArrays(1, &self.vao);
-	glBindVertexArray(self.vao);
+	gl_state_bind_vertex_array(self.vao);
 		glGenBuffers(1, &self.vbo);
 		glBindBuffer(GL_ARRAY_BUFFER, self.vbo);
 		glBufferData(GL_ARRAY_BUFFER, buffer.size() * stride_size, buffer.data(), GL_STATIC_DRAW);
@@ -190,7 +614,7 @@ GLBuf gl_buf_new(const mu::Vec<T>& buffer) {
 			);
 			offset += attributes[i].size;
 		}
-	glBindVertexArray(0);
+	gl_state_bind_vertex_array(0);
 
 	return self;
 }
@@ -210,7 +634,7 @@ GLBuf gl_buf_new_dyn(size_t len) {
 	};
 
 	glGenVertexArrays(1, &self.vao);
-	glBindVertexArray(self.vao);
+	gl_state_bind_vertex_array(self.vao);
 		glGenBuffers(1, &self.vbo);
 		glBindBuffer(GL_ARRAY_BUFFER, self.vbo);
 		glBufferData(GL_ARRAY_BUFFER, len * stride_size, NULL, GL_DYNAMIC_DRAW);
@@ -229,14 +653,129 @@ GLBuf gl_buf_new_dyn(size_t len) {
 			);
 			offset += attributes[i].size;
 		}
-	glBindVertexArray(0);
+	gl_state_bind_vertex_array(0);
 
 	return self;
 }
 
 inline void gl_buf_free(GLBuf& self) {
 	glDeleteBuffers(1, &self.vbo);
-	glBindVertexArray(0);
+	gl_state_bind_vertex_array(0);
 	glDeleteVertexArrays(1, &self.vao);
 	self = {};
 }
+
+// streaming vertex buffer for immediate-mode geometry that is rewritten every frame
+// vertices are appended to a ring, when it wraps the storage gets orphaned so the driver
+// hands a fresh block instead of waiting on draws still reading the old one
+// (GL 3.3 has no glBufferStorage, so no persistent mapping)
+struct GLStreamBuf {
+	GLuint vbo;
+	size_t capacity; // in bytes
+	size_t head; // offset of next free byte
+
+	struct Stats {
+		size_t bytes_uploaded;
+		size_t uploads;
+		size_t orphans;
+	};
+	Stats frame, last_frame;
+};
+
+inline GLStreamBuf gl_stream_buf_new(size_t capacity) {
+	GLStreamBuf self {
+		.capacity = capacity
+	};
+
+	glGenBuffers(1, &self.vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, self.vbo);
+	glBufferData(GL_ARRAY_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+
+	return self;
+}
+
+inline void gl_stream_buf_free(GLStreamBuf& self) {
+	glDeleteBuffers(1, &self.vbo);
+	self = {};
+}
+
+// vertex array that reads given attributes from the stream, attributes are tightly packed
+template<typename... AttribType>
+GLuint gl_stream_buf_vao_new(const GLStreamBuf& stream) {
+	constexpr size_t attributes_size = sizeof...(AttribType);
+	constexpr GLVertexAttrib attributes[attributes_size] = { _gl_vertex_attrib<AttribType>()... };
+
+	size_t stride_size = 0;
+	for (int i = 0; i < attributes_size; i++) {
+		stride_size += attributes[i].size;
+	}
+
+	GLuint vao;
+	glGenVertexArrays(1, &vao);
+	gl_state_bind_vertex_array(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, stream.vbo);
+
+		size_t offset = 0;
+		bool normalize = false;
+		for (int i = 0; i < attributes_size; i++) {
+			glEnableVertexAttribArray(i);
+			glVertexAttribPointer(
+				i,
+				attributes[i].num_components,
+				attributes[i].type,
+				normalize,
+				stride_size,
+				(void*)offset
+			);
+			offset += attributes[i].size;
+		}
+	gl_state_bind_vertex_array(0);
+
+	return vao;
+}
+
+// call once per frame before pushing, keeps stats of previous frame in `last_frame`
+inline void gl_stream_buf_frame_begin(GLStreamBuf& self) {
+	self.last_frame = self.frame;
+	self.frame = {};
+}
+
+// copies vertices to the stream and returns index of the first one, to be passed as `first` to glDrawArrays
+// offset is aligned to sizeof(T) so each vertex array over the stream can address it with its own stride
+template<typename T>
+GLint gl_stream_buf_push(GLStreamBuf& self, const T* vertices, size_t count) {
+	if (count == 0) {
+		return 0;
+	}
+
+	const size_t size = count * sizeof(T);
+	size_t offset = (self.head + sizeof(T) - 1) / sizeof(T) * sizeof(T);
+
+	glBindBuffer(GL_ARRAY_BUFFER, self.vbo);
+	if (offset + size > self.capacity) {
+		while (size > self.capacity) {
+			self.capacity *= 2;
+		}
+		glBufferData(GL_ARRAY_BUFFER, self.capacity, NULL, GL_STREAM_DRAW);
+		offset = 0;
+		self.frame.orphans++;
+	}
+
+	void* dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (dst == nullptr) {
+		mu::panic("failed to map stream buffer range [{}, {})", offset, offset + size);
+	}
+	::memcpy(dst, vertices, size);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+
+	self.head = offset + size;
+	self.frame.bytes_uploaded += size;
+	self.frame.uploads++;
+
+	return GLint(offset / sizeof(T));
+}
+
+template<typename T>
+GLint gl_stream_buf_push(GLStreamBuf& self, const mu::Vec<T>& vertices) {
+	return gl_stream_buf_push(self, vertices.data(), vertices.size());
+}
@@ -25,6 +25,8 @@ namespace sys {
 			if (gobj.should_be_loaded) {
 				ground_obj_unload(gobj);
 				ground_obj_load(gobj);
+				world.canvas.frame_drawing_stale = true;
+				world.scenery.should_rebuild_raycast = true;
 				mu::log_debug("loaded '{}'", gobj.ground_obj_template.main);
 			}
 		}
@@ -36,6 +38,7 @@ namespace sys {
 		for (int i = 0; i < world.ground_objs.size(); i++) {
 			if (world.ground_objs[i].should_be_removed) {
 				world.ground_objs.erase(world.ground_objs.begin()+i);
+				world.scenery.should_rebuild_raycast = true;
 				i--;
 			}
 		}
@@ -54,7 +57,7 @@ namespace sys {
 			// apply model transformation
 			const auto model_transformation = local_euler_angles_matrix(gro.angles, gro.translation);
 
-			gro.translation += ((float)world.loop_timer.delta_time * gro.speed) * gro.angles.front;
+			gro.translation += ((float)SIM_STEP * gro.speed) * gro.angles.front;
 
 			// transform AABB (estimate new AABB after rotation)
 			{
@@ -87,30 +90,16 @@ namespace sys {
 				}
 			}
 
-			for (auto& mesh : gro.model.meshes) {
-				mesh.transformation = model_transformation;
-			}
-
-			meshes_foreach(gro.model.meshes, [&](Mesh& mesh) {
-				if (mesh.visible == false) {
-					return false;
-				}
+			auto& animation = gro.animation;
+			animation_table_update(animation, gro.model.meshes, AnimationModel::GROUND);
 
-				// apply mesh transformation
-				mesh.transformation = glm::translate(mesh.transformation, mesh.translation);
-				mesh.transformation = glm::rotate(mesh.transformation, mesh.rotation[2], glm::vec3{0, 0, 1});
-				mesh.transformation = glm::rotate(mesh.transformation, mesh.rotation[1], glm::vec3{1, 0, 0});
-				mesh.transformation = glm::rotate(mesh.transformation, mesh.rotation[0], glm::vec3{0, -1, 0});
+			animation_table_radars_spin(animation, SIM_STEP);
 
-				for (auto& child : mesh.children) {
-					child.transformation = mesh.transformation;
-				}
-
-				return true;
-			});
+			animation_table_transform(animation, model_transformation);
 		}
 	}
 
+	// spawning, loading and removing, on main thread
 	void ground_objs_update(World& world) {
 		DEF_SYSTEM
 
@@ -141,43 +130,64 @@ namespace sys {
 		_ground_objs_reload(world);
 		_ground_objs_autoremove(world);
 
+		if (world.scenery.should_rebuild_raycast) {
+			// meshes where they're drawn, loading leaves them at model space till next simulation step
+			for (auto& gro : world.ground_objs) {
+				animation_table_update(gro.animation, gro.model.meshes, AnimationModel::GROUND);
+				animation_table_transform(gro.animation, local_euler_angles_matrix(gro.angles, gro.translation));
+			}
+			scenery_raycast_rebuild(world.scenery, world.ground_objs, world.settings.bvh_cache_dir);
+		}
+	}
+
+	// one simulation step, on simulation thread
+	void ground_objs_step(World& world) {
+		DEF_SYSTEM
+
 		_ground_objs_apply_physics(world);
 	}
 
 	void ground_objs_prepare_render(World& world) {
 		DEF_SYSTEM
 
-		for (int i = 0; i < world.ground_objs.size(); i++) {
-			GroundObj& gro = world.ground_objs[i];
+		workers_run(world.workers, [&](size_t slot) {
+			auto& cmds = canvas_frame_recording(world.canvas).cmd_lists[CANVAS_LANE_GROUND_OBJS][slot];
+			const auto [begin, end] = workers_slot_range(world.workers, slot, world.ground_objs.size());
 
-			if (!gro.visible) {
-				continue;
-			}
+			for (size_t i = begin; i < end; i++) {
+				const GroundObj& gro = world.ground_objs[i];
 
-
-			meshes_foreach(gro.model.meshes, [&](const Mesh& mesh) {
-				if (!mesh.visible) {
-					return false;
+				if (!gro.visible) {
+					continue;
 				}
 
-				if (mesh.render_cnt_axis) {
-					canvas_add(world.canvas, canvas::Axis { glm::translate(glm::identity<glm::mat4>(), mesh.cnt) });
-				}
 
-				if (mesh.render_pos_axis) {
-					canvas_add(world.canvas, canvas::Axis { mesh.transformation });
-				}
+				meshes_foreach(gro.model.meshes, [&](const Mesh& mesh) {
+					if (!mesh.visible) {
+						return false;
+					}
 
-				canvas_add(world.canvas, canvas::Mesh {
-					.vao = mesh.gl_buf.vao,
-					.buf_len = mesh.gl_buf.len,
-					.projection_view_model = world.mats.projection_view * mesh.transformation,
-					.model_normal = glm::transpose(glm::inverse(glm::mat3(mesh.transformation)))
-				});
+					if (mesh.render_cnt_axis) {
+						canvas_add(cmds, canvas::Axis { glm::translate(glm::identity<glm::mat4>(), mesh.cnt) });
+					}
 
-				return true;
-			});
-		}
+					const auto transformation = gro.render_offset * mesh.transformation;
+
+					if (mesh.render_pos_axis) {
+						canvas_add(cmds, canvas::Axis { transformation });
+					}
+
+					canvas_add(cmds, canvas::Mesh {
+						.vao = mesh.gl_buf.vao,
+						.buf_len = mesh.gl_buf.len,
+						.projection_view_model = world.mats.projection_view * transformation,
+						.model_normal = glm::transpose(glm::inverse(glm::mat3(transformation)))
+					});
+
+					return true;
+				}, &cmds.arena);
+			}
+		});
 	}
 
 } // namespace sys
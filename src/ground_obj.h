@@ -4,21 +4,37 @@
 
 #include "math.h"
 #include "assets.h"
+#include "animation.h"
+#include "broadphase.h"
+#include "collision.h"
 
 struct GroundObj {
 	GroundObjTemplate ground_obj_template;
 	Model model;
 	DATMap dat;
 
+	// nodes of model radars spin, set dirty after editing any mesh translation/rotation
+	AnimationTable animation;
+
 	AABB initial_aabb;
 	AABB current_aabb;
 	bool render_aabb;
+	// in World::broadphase, static while speed is 0
+	uint32_t broadphase_proxy = BROADPHASE_NONE;
+	// coll.srf, tested after broadphase finds its AABB intersecting another
+	CollisionMesh collision;
 
 	glm::vec3 translation;
 	LocalEulerAngles angles;
 	bool visible = true;
 	float speed;
 
+	// translation before the last simulation step, ground objects never turn so only translation is interpolated
+	glm::vec3 prev_translation;
+	bool has_prev_state;
+	glm::vec3 render_translation;
+	glm::mat4 render_offset{1.0f};
+
 	bool should_be_loaded;
 	bool should_be_removed;
 };
@@ -45,6 +61,9 @@ inline void ground_obj_load(GroundObj& self) {
 	}
 
 	self.current_aabb = self.initial_aabb = aabb_from_meshes(self.model.meshes);
+	self.collision = collision_mesh_from_file(self.ground_obj_template.coll_srf);
+
+	animation_table_build(self.animation, self.model.meshes, AnimationModel::GROUND);
 
 	self.dat = datmap_from_dat_file(self.ground_obj_template.dat);
 
@@ -0,0 +1,211 @@
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include "world.h"
+
+namespace sys {
+
+	void headless_init(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.headless;
+
+		// color+depth renderbuffers, we never sample them, only read the last frame back
+		glGenFramebuffers(1, &self.fbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, self.fbo);
+
+		glGenRenderbuffers(1, &self.color_rbo);
+		glBindRenderbuffer(GL_RENDERBUFFER, self.color_rbo);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, self.size.x, self.size.y);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, self.color_rbo);
+
+		glGenRenderbuffers(1, &self.depth_rbo);
+		glBindRenderbuffer(GL_RENDERBUFFER, self.depth_rbo);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, self.size.x, self.size.y);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, self.depth_rbo);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			mu::panic("headless framebuffer is incomplete");
+		}
+		glViewport(0, 0, self.size.x, self.size.y);
+
+		self.timestamp_queries = mu::Vec<GLuint>(self.frames * 2);
+		glGenQueries(self.timestamp_queries.size(), self.timestamp_queries.data());
+
+		// scenery and aircrafts are only loaded on first update, so replacing them here is cheap
+		auto scenery_template = world.scenery_templates.find(self.scenery_name);
+		if (scenery_template == world.scenery_templates.end()) {
+			mu::panic("scenery '{}' not found", self.scenery_name);
+		}
+		world.scenery = scenery_new(scenery_template->second);
+
+		world.aircrafts.clear();
+		for (const auto& name : self.aircraft_names) {
+			auto aircraft_template = world.aircraft_templates.find(name);
+			if (aircraft_template == world.aircraft_templates.end()) {
+				mu::panic("aircraft '{}' not found", name);
+			}
+			world.aircrafts.push_back(aircraft_new(aircraft_template->second));
+		}
+		world.camera.aircraft = &world.aircrafts[0];
+
+		world.settings.rendering.uber_shaders = self.uber_shaders;
+
+		// no window events will come, so projection aspect is never set otherwise
+		signal_fire(world.signals.wnd_configs_changed);
+
+		mu::log_info("headless: rendering {} frames ({} warmup) of '{}' at {}x{}",
+			self.frames, self.warmup_frames, self.scenery_name, self.size.x, self.size.y);
+	}
+
+	void headless_free(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.headless;
+
+		glDeleteQueries(self.timestamp_queries.size(), self.timestamp_queries.data());
+		glDeleteRenderbuffers(1, &self.depth_rbo);
+		glDeleteRenderbuffers(1, &self.color_rbo);
+		glDeleteFramebuffers(1, &self.fbo);
+	}
+
+	// replaces loop_timer_update and events_collect in headless mode
+	void headless_frame_begin(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.headless;
+
+		self._frame_start = std::chrono::high_resolution_clock::now();
+		glQueryCounter(self.timestamp_queries[self.frame * 2], GL_TIMESTAMP);
+
+		world.loop_timer.delta_time = HEADLESS_DELTA_TIME;
+		world.loop_timer.ready = true;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, self.fbo);
+	}
+
+	void _headless_save_png(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.headless;
+
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, self.size.x, self.size.y, 32, SDL_PIXELFORMAT_RGBA32);
+		if (surface == nullptr) {
+			mu::log_error("headless: failed to create surface, {}", SDL_GetError());
+			return;
+		}
+		mu_defer(SDL_FreeSurface(surface));
+
+		const size_t row_size = self.size.x * 4;
+		auto pixels = mu::Vec<uint8_t>(row_size * self.size.y, mu::memory::tmp());
+
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, self.size.x, self.size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		// GL rows are bottom to top
+		for (int y = 0; y < self.size.y; y++) {
+			memcpy(
+				(uint8_t*) surface->pixels + y * surface->pitch,
+				pixels.data() + (self.size.y - 1 - y) * row_size,
+				row_size
+			);
+		}
+
+		if (IMG_SavePNG(surface, self.png_path.c_str())) {
+			mu::log_error("headless: failed to save '{}', {}", self.png_path, IMG_GetError());
+			return;
+		}
+		mu::log_info("headless: saved last frame to '{}'", self.png_path);
+	}
+
+	void headless_frame_end(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.headless;
+
+		glQueryCounter(self.timestamp_queries[self.frame * 2 + 1], GL_TIMESTAMP);
+		gl_process_errors();
+
+		self.cpu_frame_millis.push_back(std::chrono::duration<double, std::milli>(
+			std::chrono::high_resolution_clock::now() - self._frame_start
+		).count());
+
+		self.frame++;
+		if (self.frame == self.frames) {
+			if (self.png_path.empty() == false) {
+				_headless_save_png(world);
+			}
+			signal_fire(world.signals.quit);
+		}
+	}
+
+	void headless_report(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.headless;
+
+		// blocks until the GPU is done with all frames, fine since we are done rendering
+		auto gpu_frame_millis = mu::Vec<double>(mu::memory::tmp());
+		for (int i = 0; i < self.frame; i++) {
+			GLuint64 begin_nanos = 0, end_nanos = 0;
+			glGetQueryObjectui64v(self.timestamp_queries[i*2],   GL_QUERY_RESULT, &begin_nanos);
+			glGetQueryObjectui64v(self.timestamp_queries[i*2+1], GL_QUERY_RESULT, &end_nanos);
+			gpu_frame_millis.push_back(double(end_nanos - begin_nanos) / 1e6);
+		}
+
+		if (self.csv_path.empty() == false) {
+			FILE* f = fopen(self.csv_path.c_str(), "w");
+			if (f == nullptr) {
+				mu::log_error("headless: failed to open '{}'", self.csv_path);
+			} else {
+				mu_defer(fclose(f));
+				fmt::print(f, "frame,warmup,cpu_millis,gpu_millis\n");
+				for (int i = 0; i < self.frame; i++) {
+					fmt::print(f, "{},{},{:.4f},{:.4f}\n", i, i < self.warmup_frames, self.cpu_frame_millis[i], gpu_frame_millis[i]);
+				}
+			}
+		}
+
+		if (self.frame <= self.warmup_frames) {
+			fmt::print("headless: no frames measured\n");
+			return;
+		}
+
+		auto cpu_samples = mu::Vec<double>(self.cpu_frame_millis.begin() + self.warmup_frames, self.cpu_frame_millis.end(), mu::memory::tmp());
+		auto gpu_samples = mu::Vec<double>(gpu_frame_millis.begin() + self.warmup_frames, gpu_frame_millis.end(), mu::memory::tmp());
+		const auto cpu = headless_stats_calc(cpu_samples);
+		const auto gpu = headless_stats_calc(gpu_samples);
+
+		fmt::print("headless: {} frames of '{}' at {}x{}\n", cpu_samples.size(), self.scenery_name, self.size.x, self.size.y);
+		fmt::print("GL_RENDERER: {}\n", (const char*) glGetString(GL_RENDERER));
+		if (self.uber_shaders) {
+			fmt::print("shaders: uber\n");
+		} else {
+			fmt::print("shaders: variants (meshes {}, gnd pics {})\n",
+				world.canvas.meshes.program_variants.programs.size(), world.canvas.gnd_pics.program_variants.programs.size());
+		}
+		size_t gl_calls_issued = 0, gl_calls_elided = 0;
+		for (int i = 0; i < GL_STATE_CALL_COUNT; i++) {
+			gl_calls_issued += gl_state.last_frame.issued[i];
+			gl_calls_elided += gl_state.last_frame.elided[i];
+		}
+		fmt::print("gl state calls (last frame): issued {}, elided {}\n", gl_calls_issued, gl_calls_elided);
+		fmt::print("         {:>9} {:>9} {:>9} {:>9}\n", "min", "avg", "p95", "max");
+		fmt::print("cpu (ms) {:9.3f} {:9.3f} {:9.3f} {:9.3f}\n", cpu.min, cpu.avg, cpu.p95, cpu.max);
+		fmt::print("gpu (ms) {:9.3f} {:9.3f} {:9.3f} {:9.3f}\n", gpu.min, gpu.avg, gpu.p95, gpu.max);
+
+		// per render pass, warmup frames included, last frames left out since their queries are read two calls later
+		for (const auto& sysinfo : world.sysmon.systems) {
+			if (sysinfo.gpu_timed && sysinfo.gpu_num_samples > 0) {
+				fmt::print("  {:<28} gpu avg {:.3f}ms, max {:.3f}ms\n", sysinfo.name,
+					sysinfo.gpu_latency_micros_avg / 1000.0, sysinfo.gpu_latency_micros_max / 1000.0);
+			}
+		}
+
+		if (self.systems_csv_path.empty() == false && sysmon_export_csv(world.sysmon, self.systems_csv_path.c_str()) == false) {
+			mu::log_error("headless: failed to open '{}'", self.systems_csv_path);
+		}
+	}
+
+}
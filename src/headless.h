@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <glm/vec2.hpp>
+
+#include <mu/utils.h>
+
+// fixed timestep of headless frames, so runs are reproducible regardless of how fast the machine is
+constexpr double HEADLESS_DELTA_TIME = 1.0 / 60;
+
+// `--headless` runs a fixed number of frames into an offscreen framebuffer,
+// without a display or input, then reports cpu/gpu frame times
+struct Headless {
+	bool enabled;
+
+	mu::Str scenery_name = "SMALL_MAP";
+	mu::Vec<mu::Str> aircraft_names;
+	int frames = 600;
+	// first frames load assets, they are rendered but not counted in stats
+	int warmup_frames = 10;
+	glm::ivec2 size {1280, 720};
+	// render with uber shaders instead of variants, to compare their cost
+	bool uber_shaders;
+
+	// optional outputs, empty means don't write
+	mu::Str png_path;
+	mu::Str csv_path;
+	// per system, with GPU time of each render pass, see `sysmon_export_csv`
+	mu::Str systems_csv_path;
+
+	GLuint fbo, color_rbo, depth_rbo;
+
+	// 2 GL_TIMESTAMP queries per frame (begin, end), only read after the last frame so we never stall
+	mu::Vec<GLuint> timestamp_queries;
+	mu::Vec<double> cpu_frame_millis;
+	int frame;
+	std::chrono::high_resolution_clock::time_point _frame_start;
+};
+
+// parses `--headless` and its options, returns false and logs on invalid arguments
+inline bool headless_parse_args(Headless& self, int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		const auto arg = mu::StrView(argv[i]);
+		const bool has_value = i+1 < argc;
+
+		if (arg == "--headless") {
+			self.enabled = true;
+		} else if (arg == "--scenery" && has_value) {
+			self.scenery_name = argv[++i];
+		} else if (arg == "--aircraft" && has_value) {
+			self.aircraft_names.push_back(mu::Str(argv[++i]));
+		} else if (arg == "--frames" && has_value) {
+			self.frames = atoi(argv[++i]);
+		} else if (arg == "--warmup" && has_value) {
+			self.warmup_frames = atoi(argv[++i]);
+		} else if (arg == "--size" && has_value) {
+			if (sscanf(argv[++i], "%dx%d", &self.size.x, &self.size.y) != 2) {
+				mu::log_error("--size expects WIDTHxHEIGHT, got '{}'", argv[i]);
+				return false;
+			}
+		} else if (arg == "--uber-shaders") {
+			self.uber_shaders = true;
+		} else if (arg == "--png" && has_value) {
+			self.png_path = argv[++i];
+		} else if (arg == "--csv" && has_value) {
+			self.csv_path = argv[++i];
+		} else if (arg == "--systems-csv" && has_value) {
+			self.systems_csv_path = argv[++i];
+		}
+	}
+
+	if (self.aircraft_names.empty()) {
+		self.aircraft_names.push_back(mu::Str("YS-11"));
+	}
+
+	if (self.frames <= 0 || self.warmup_frames < 0 || self.size.x <= 0 || self.size.y <= 0) {
+		mu::log_error("invalid headless options, frames={} warmup={} size={}x{}",
+			self.frames, self.warmup_frames, self.size.x, self.size.y);
+		return false;
+	}
+	if (self.warmup_frames >= self.frames) {
+		self.warmup_frames = 0;
+	}
+
+	return true;
+}
+
+struct HeadlessStats {
+	double min, avg, p95, max;
+};
+
+// sorts samples in place
+inline HeadlessStats headless_stats_calc(mu::Vec<double>& samples) {
+	if (samples.empty()) {
+		return {};
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	double sum = 0;
+	for (double s : samples) {
+		sum += s;
+	}
+
+	return HeadlessStats {
+		.min = samples.front(),
+		.avg = sum / samples.size(),
+		.p95 = samples[std::min(samples.size()-1, size_t(samples.size() * 0.95))],
+		.max = samples.back(),
+	};
+}
+
+inline void test_headless_stats() {
+	mu_test_suite("test_headless_stats");
+
+	{
+		mu::Vec<double> samples;
+		const auto stats = headless_stats_calc(samples);
+		mu_test(stats.min == 0 && stats.avg == 0 && stats.p95 == 0 && stats.max == 0);
+	}
+
+	{
+		mu::Vec<double> samples;
+		for (int i = 100; i >= 1; i--) {
+			samples.push_back(i);
+		}
+		const auto stats = headless_stats_calc(samples);
+		mu_test(stats.min == 1);
+		mu_test(stats.max == 100);
+		mu_test(stats.avg == 50.5);
+		mu_test(stats.p95 == 96);
+	}
+}
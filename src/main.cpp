@@ -42,16 +42,36 @@ namespace sys {
 		DEF_SYSTEM
 
 		SDL_SetMainReady();
+
+		if (world.headless.enabled) {
+			// no display: SDL's offscreen driver makes the GL context through EGL, and mesa's surfaceless
+			// platform doesn't need a window system (set LIBGL_ALWAYS_SOFTWARE=1 to force llvmpipe)
+			// env vars SDL_VIDEODRIVER/EGL_PLATFORM still win, e.g. to use Xvfb instead
+			SDL_SetHintWithPriority(SDL_HINT_VIDEODRIVER, "offscreen", SDL_HINT_DEFAULT);
+			SDL_SetHintWithPriority(SDL_HINT_AUDIODRIVER, "dummy", SDL_HINT_DEFAULT);
+			SDL_setenv("EGL_PLATFORM", "surfaceless", 0);
+		}
+
 		if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
 			mu::panic(SDL_GetError());
 		}
 
-		world.sdl_window = SDL_CreateWindow(
-			WND_TITLE,
-			SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
-			WND_INIT_WIDTH, WND_INIT_HEIGHT,
-			SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | WND_FLAGS
-		);
+		if (world.headless.enabled) {
+			// rendering goes to headless framebuffer, window only holds the context
+			world.sdl_window = SDL_CreateWindow(
+				WND_TITLE,
+				SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+				world.headless.size.x, world.headless.size.y,
+				SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+			);
+		} else {
+			world.sdl_window = SDL_CreateWindow(
+				WND_TITLE,
+				SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+				WND_INIT_WIDTH, WND_INIT_HEIGHT,
+				SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | WND_FLAGS
+			);
+		}
 		if (!world.sdl_window) {
 			mu::panic(SDL_GetError());
 		}
@@ -67,6 +87,7 @@ namespace sys {
 		if (!world.sdl_gl_context) {
 			mu::panic(SDL_GetError());
 		}
+		SDL_GL_SetSwapInterval(world.settings.vsync? 1 : 0);
 
 		// glad: load all OpenGL function pointers
 		if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
@@ -139,6 +160,8 @@ namespace sys {
 	void imgui_logs_window(World& world) {
 		DEF_SYSTEM
 
+		std::lock_guard lock(world.imgui_window_logger.mutex);
+
 		ImGui::SetNextWindowBgAlpha(IMGUI_WNDS_BG_ALPHA);
 		if (ImGui::Begin("Logs")) {
 			ImGui::Checkbox("Auto-Scroll", &world.imgui_window_logger.auto_scrolling);
@@ -146,7 +169,9 @@ namespace sys {
 			ImGui::Checkbox("Wrapped", &world.imgui_window_logger.wrapped);
 			ImGui::SameLine();
 			if (ImGui::Button("Clear")) {
-				world.imgui_window_logger = {};
+				world.imgui_window_logger.logs.clear();
+				world.imgui_window_logger._arena = {};
+				world.imgui_window_logger.last_scrolled_line = 0;
 			}
 
 			if (ImGui::BeginChild("logs child", {}, false, world.imgui_window_logger.wrapped? 0:ImGuiWindowFlags_HorizontalScrollbar)) {
@@ -197,10 +222,10 @@ namespace sys {
 			| ImGuiWindowFlags_NoFocusOnAppearing
 			| ImGuiWindowFlags_NoNav
 			| ImGuiWindowFlags_NoMove)) {
-			for (const auto& line : world.text_overlay_list) {
+			// cleared with the frame by canvas_rendering_end
+			for (const auto& line : canvas_frame_drawing(world.canvas).text_overlay_list) {
 				ImGui::TextWrapped(mu::str_tmpf("> {}", line).c_str());
 			}
-			world.text_overlay_list = mu::Vec<mu::Str>(mu::memory::tmp());
 		}
 		ImGui::End();
 	}
@@ -217,6 +242,13 @@ namespace sys {
 				}
 				ImGui::EndDisabled();
 
+				if (ImGui::Checkbox("VSync", &world.settings.vsync)) {
+					SDL_GL_SetSwapInterval(world.settings.vsync? 1 : 0);
+				}
+				ImGui::Text("Sim steps last frame: %d", world.sim_clock.steps_last_frame);
+				ImGui::Text("Sim thread: frame %.2f ms, render waited %.2f ms",
+					world.sim_thread.last_frame_millis, world.sim_thread.last_wait_millis);
+
 				int size[2];
 				SDL_GetWindowSize(world.sdl_window, &size[0], &size[1]);
 				const bool width_changed = ImGui::InputInt("Width", &size[0]);
@@ -325,6 +357,10 @@ namespace sys {
 					world.settings.rendering = {};
 				}
 
+				const auto& stream_stats = world.canvas.stream.last_frame;
+				ImGui::Text(mu::str_tmpf("Streamed: {} bytes, {} uploads, {} orphans (capacity {} bytes)",
+					stream_stats.bytes_uploaded, stream_stats.uploads, stream_stats.orphans, world.canvas.stream.capacity).c_str());
+
 				MyImGui::EnumsCombo("Polygon Mode", &world.settings.rendering.polygon_mode, {
 					{GL_POINT, "GL_POINT"},
 					{GL_LINE,  "GL_LINE"},
@@ -341,6 +377,21 @@ namespace sys {
 					{GL_TRIANGLE_FAN,    "GL_TRIANGLE_FAN"},
 				});
 
+				ImGui::Checkbox("Uber Shaders", &world.settings.rendering.uber_shaders);
+				ImGui::Text(mu::str_tmpf("Compiled Variants: meshes {}, gnd pics {}",
+					world.canvas.meshes.program_variants.programs.size(), world.canvas.gnd_pics.program_variants.programs.size()).c_str());
+				ImGui::Text(mu::str_tmpf("Textures: {} in {} arrays, uploaded {}/{} ({} KB last frame)",
+					world.textures.list.size(), world.textures.arrays.size(), world.textures.uploads_cursor, world.textures.uploads.size(),
+					world.textures.last_frame.bytes_uploaded / 1024).c_str());
+
+				if (ImGui::TreeNode("GL State Calls")) {
+					for (int i = 0; i < GL_STATE_CALL_COUNT; i++) {
+						ImGui::Text(mu::str_tmpf("{}: issued {}, elided {}", GL_STATE_CALL_NAMES[i],
+							gl_state.last_frame.issued[i], gl_state.last_frame.elided[i]).c_str());
+					}
+					ImGui::TreePop();
+				}
+
 				ImGui::Checkbox("Smooth Lines", &world.settings.rendering.smooth_lines);
                 #ifndef OS_MACOS
 				ImGui::BeginDisabled(!world.settings.rendering.smooth_lines);
@@ -446,6 +497,25 @@ namespace sys {
 				ImGui::TreePop();
 			}
 
+			if (ImGui::TreeNode("Traffic")) {
+				auto& traffic = world.settings.traffic;
+				ImGui::SliderInt("Count", &traffic.count, 0, 5000);
+				if (ImGui::BeginCombo("Aircraft##traffic", traffic.aircraft.c_str())) {
+					for (const auto& [name, _aircraft] : world.aircraft_templates) {
+						if (ImGui::Selectable(name.c_str(), name == traffic.aircraft)) {
+							traffic.aircraft = name;
+						}
+					}
+					ImGui::EndCombo();
+				}
+				ImGui::DragFloat("Full Radius", &traffic.full_radius, 50, 0, 20000);
+				ImGui::SliderInt("Full Max", &traffic.full_max, 0, 256);
+				ImGui::DragFloat("Mesh Radius", &traffic.mesh_radius, 50, 0, 50000);
+				ImGui::Text(mu::str_tmpf("Routes: {}, Agents: {} ({} full)", world.traffic.routes.size(),
+					world.traffic.agents.size(), world.traffic.full.size()).c_str());
+				ImGui::TreePop();
+			}
+
 			if (ImGui::TreeNode("Audio")) {
 				for (const auto& [_, buf] : world.audio_buffers) {
 					ImGui::PushID(buf.file_path.c_str());
@@ -479,11 +549,15 @@ namespace sys {
 				int enabled_count = 0;
 				uint64_t total_latency = 0;
 				uint64_t max_latency = 0;
+				uint64_t total_gpu_latency = 0;
 				for (auto& sysinfo : world.sysmon.systems) {
 					if (sysinfo.enabled) {
 						enabled_count++;
 						total_latency += sysinfo.latency_micros;
 						max_latency = std::max(max_latency, sysinfo.latency_micros);
+						if (sysinfo.gpu_timed) {
+							total_gpu_latency += sysinfo.gpu_latency_micros;
+						}
 					}
 				}
 
@@ -491,11 +565,57 @@ namespace sys {
 				ImGui::Text(mu::str_tmpf("Enabled: {}", enabled_count).c_str());
 				ImGui::Text(mu::str_tmpf("Total Latency: {}", total_latency).c_str());
 				ImGui::Text(mu::str_tmpf("Max Latest Avg: {}", max_latency).c_str());
+				ImGui::Text(mu::str_tmpf("Total GPU Latency: {}", total_gpu_latency).c_str());
+
+				if (ImGui::Button("Export CSV")) {
+					const auto csv_path = mu::str_tmpf("{}/{}", mu::folder_config(mu::memory::tmp()), "open-ysf-sysmon.csv");
+					if (sysmon_export_csv(world.sysmon, csv_path.c_str())) {
+						mu::log_info("exported systems stats to '{}'", csv_path);
+					} else {
+						mu::log_error("failed to export systems stats to '{}'", csv_path);
+					}
+				}
+
+				if (ImGui::TreeNode("Workers")) {
+					// what each worker ran in last simulation frame, hover a job for its time
+					std::lock_guard lock(world.workers.timelines_mutex);
+					const float frame_millis = std::max(world.workers.timeline_millis, 1e-3f);
+					ImGui::Text(mu::str_tmpf("frame: {:.3f}ms", frame_millis).c_str());
+
+					auto draw_list = ImGui::GetWindowDrawList();
+					const float row_height = ImGui::GetTextLineHeight();
+					for (size_t i = 0; i < workers_count(world.workers); i++) {
+						ImGui::Text(mu::str_tmpf("{:2}", i).c_str());
+						ImGui::SameLine();
+						const auto origin = ImGui::GetCursorScreenPos();
+						const float width = ImGui::GetContentRegionAvail().x;
+						ImGui::Dummy(ImVec2{width, row_height});
+						draw_list->AddRectFilled(origin, ImVec2{origin.x + width, origin.y + row_height}, IM_COL32(40, 40, 40, 255));
+
+						// jobs are added when they end, so ones run while waiting inside another come before it, draw them over it
+						const auto& spans = world.workers.timelines[i];
+						for (auto span = spans.rbegin(); span != spans.rend(); span++) {
+							const ImVec2 min {origin.x + width * span->begin_millis / frame_millis, origin.y};
+							const ImVec2 max {std::max(origin.x + width * span->end_millis / frame_millis, min.x + 1), origin.y + row_height};
+							const float hue = (std::hash<std::string_view>{}(span->name) % 1024) / 1024.0f;
+							draw_list->AddRectFilled(min, max, ImColor::HSV(hue, 0.6f, 0.8f));
+							if (ImGui::IsMouseHoveringRect(min, max)) {
+								ImGui::SetTooltip("%s: %.3fms", span->name, span->end_millis - span->begin_millis);
+							}
+						}
+					}
+
+					ImGui::TreePop();
+				}
 
 				for (auto& sysinfo : world.sysmon.systems) {
 					if (ImGui::TreeNode(sysinfo.name.c_str())) {
 						ImGui::Text(mu::str_tmpf("latency (micros): last {}, avg {}, min {}, max {}",
 							sysinfo.latency_micros, sysinfo.latency_micros_avg, sysinfo.latency_micros_min, sysinfo.latency_micros_max).c_str());
+						if (sysinfo.gpu_timed && sysinfo.gpu_num_samples > 0) {
+							ImGui::Text(mu::str_tmpf("gpu latency (micros): last {}, avg {}, min {}, max {}",
+								sysinfo.gpu_latency_micros, sysinfo.gpu_latency_micros_avg, sysinfo.gpu_latency_micros_min, sysinfo.gpu_latency_micros_max).c_str());
+						}
 						ImGui::Checkbox("enabled", &sysinfo.enabled);
 
 						ImGui::TreePop();
@@ -524,7 +644,7 @@ namespace sys {
 			}
 
 			std::function<void(Field&,bool)> render_field_imgui;
-			render_field_imgui = [&render_field_imgui, current_angle_max=world.settings.current_angle_max](Field& field, bool is_root) {
+			render_field_imgui = [&render_field_imgui, &should_rebuild_render_cache=world.scenery.should_rebuild_render_cache, current_angle_max=world.settings.current_angle_max](Field& field, bool is_root) {
 				if (ImGui::TreeNode(mu::str_tmpf("Field {}", field.name).c_str())) {
 					MyImGui::EnumsCombo("ID", &field.id, {
 						{FieldID::NONE, "NONE"},
@@ -543,10 +663,10 @@ namespace sys {
 						{AreaKind::NOAREA, "NOAREA"},
 					});
 					ImGui::ColorEdit3("Sky Color", glm::value_ptr(field.sky_color));
-					ImGui::ColorEdit3("GND Color", glm::value_ptr(field.ground_color));
+					should_rebuild_render_cache |= ImGui::ColorEdit3("GND Color", glm::value_ptr(field.ground_color));
 					ImGui::Checkbox("GND Specular", &field.ground_specular);
 
-					ImGui::Checkbox("Visible", &field.visible);
+					should_rebuild_render_cache |= ImGui::Checkbox("Visible", &field.visible);
 
 					ImGui::DragFloat3("Translation", glm::value_ptr(field.translation));
 					MyImGui::SliderAngle3("Rotation", &field.rotation, current_angle_max);
@@ -572,10 +692,10 @@ namespace sys {
 								{FieldID::VIEW_POINT, "VIEW_POINT"},
 							});
 
-							ImGui::Checkbox("Visible", &terr_mesh.visible);
+							should_rebuild_render_cache |= ImGui::Checkbox("Visible", &terr_mesh.visible);
 
-							ImGui::DragFloat3("Translation", glm::value_ptr(terr_mesh.translation));
-							MyImGui::SliderAngle3("Rotation", &terr_mesh.rotation, current_angle_max);
+							should_rebuild_render_cache |= ImGui::DragFloat3("Translation", glm::value_ptr(terr_mesh.translation));
+							should_rebuild_render_cache |= MyImGui::SliderAngle3("Rotation", &terr_mesh.rotation, current_angle_max);
 
 							ImGui::TreePop();
 						}
@@ -595,10 +715,10 @@ namespace sys {
 								{FieldID::VIEW_POINT, "VIEW_POINT"},
 							});
 
-							ImGui::Checkbox("Visible", &picture.visible);
+							should_rebuild_render_cache |= ImGui::Checkbox("Visible", &picture.visible);
 
-							ImGui::DragFloat3("Translation", glm::value_ptr(picture.translation));
-							MyImGui::SliderAngle3("Rotation", &picture.rotation, current_angle_max);
+							should_rebuild_render_cache |= ImGui::DragFloat3("Translation", glm::value_ptr(picture.translation));
+							should_rebuild_render_cache |= MyImGui::SliderAngle3("Rotation", &picture.rotation, current_angle_max);
 
 							ImGui::TreePop();
 						}
@@ -699,7 +819,9 @@ namespace sys {
 					}
 
 					ImGui::Checkbox("visible", &aircraft.visible);
-					ImGui::DragFloat3("translation", glm::value_ptr(aircraft.translation));
+					if (ImGui::DragFloat3("translation", glm::value_ptr(aircraft.translation))) {
+						aircraft_kinematics_update(aircraft);
+					}
 
 					{
 						auto current_angles = aircraft_angles(aircraft);
@@ -717,16 +839,19 @@ namespace sys {
 							glm::quat q_pitch = glm::angleAxis(dp, right);
 							glm::quat q_roll = glm::angleAxis(dr, current_angles.front);
 							aircraft.orientation = glm::normalize(q_roll * q_pitch * q_yaw * aircraft.orientation);
+							aircraft_kinematics_update(aircraft);
 						}
 					}
 
 					{
-						auto ang = aircraft_angles(aircraft);
+						auto k = aircraft.kinematics;
 						ImGui::BeginDisabled();
-						auto x = glm::cross(ang.up, ang.front);
+						auto x = glm::cross(k.up, k.front);
 						ImGui::DragFloat3("right", glm::value_ptr(x));
-						ImGui::DragFloat3("up", glm::value_ptr(ang.up));
-						ImGui::DragFloat3("front", glm::value_ptr(ang.front));
+						ImGui::DragFloat3("up", glm::value_ptr(k.up));
+						ImGui::DragFloat3("front", glm::value_ptr(k.front));
+						ImGui::DragFloat("sideslip", &k.sideslip);
+						ImGui::DragFloat("dynamic pressure", &k.dynamic_pressure);
 						ImGui::EndDisabled();
 					}
 
@@ -770,13 +895,12 @@ namespace sys {
 								ImPlot::EndPlot();
 							}
 
-							ImGui::DragFloat("Cd.x", &aircraft.cd_consts.x, 0.0001, 0, 0.08);
-							ImGui::DragFloat("Cd.y", &aircraft.cd_consts.y, 0.1);
-							ImGui::DragFloat("Cd.z", &aircraft.cd_consts.z, 0.1);
+							aircraft.aero_table_dirty |= ImGui::DragFloat("Cd.x", &aircraft.cd_consts.x, 0.0001, 0, 0.08);
+							aircraft.aero_table_dirty |= ImGui::DragFloat("Cd.y", &aircraft.cd_consts.y, 0.1);
+							aircraft.aero_table_dirty |= ImGui::DragFloat("Cd.z", &aircraft.cd_consts.z, 0.1);
 							ImGui::Spacing();
-							aircraft.cl_consts.quad_funcs_dirty = false;
-							aircraft.cl_consts.quad_funcs_dirty |= ImGui::DragFloat("Cl.AoA_crit-", &aircraft.cl_consts.aoa_crit_neg, 5, -100, 0);
-							aircraft.cl_consts.quad_funcs_dirty |= ImGui::DragFloat("Cl.AoA_crit+", &aircraft.cl_consts.aoa_crit_pos, 5, 0, 100);
+							aircraft.aero_table_dirty |= ImGui::DragFloat("Cl.AoA_crit-", &aircraft.cl_consts.aoa_crit_neg, 5, -100, 0);
+							aircraft.aero_table_dirty |= ImGui::DragFloat("Cl.AoA_crit+", &aircraft.cl_consts.aoa_crit_pos, 5, 0, 100);
 
 							ImGui::TreePop();
 						}
@@ -851,8 +975,8 @@ namespace sys {
 								ImGui::DragFloat3("CNT", glm::value_ptr(mesh.cnt), 5, 0, 180);
 							ImGui::EndDisabled();
 
-							ImGui::DragFloat3("translation", glm::value_ptr(mesh.translation));
-							MyImGui::SliderAngle3("rotation", &mesh.rotation, current_angle_max);
+							aircraft.animation.dirty |= ImGui::DragFloat3("translation", glm::value_ptr(mesh.translation));
+							aircraft.animation.dirty |= MyImGui::SliderAngle3("rotation", &mesh.rotation, current_angle_max);
 
 							ImGui::Text(mu::str_tmpf("{}", mesh.animation_type).c_str());
 
@@ -877,6 +1001,7 @@ namespace sys {
 												mesh_unload_from_gpu(mesh);
 												mesh_load_to_gpu(mesh);
 											}
+											world.canvas.frame_drawing_stale = true;
 										}
 
 										ImGui::TreePop();
@@ -1017,8 +1142,8 @@ namespace sys {
 								ImGui::DragFloat3("CNT", glm::value_ptr(mesh.cnt), 5, 0, 180);
 							ImGui::EndDisabled();
 
-							ImGui::DragFloat3("translation", glm::value_ptr(mesh.translation));
-							MyImGui::SliderAngle3("rotation", &mesh.rotation, current_angle_max);
+							gro.animation.dirty |= ImGui::DragFloat3("translation", glm::value_ptr(mesh.translation));
+							gro.animation.dirty |= MyImGui::SliderAngle3("rotation", &mesh.rotation, current_angle_max);
 
 							ImGui::Text(mu::str_tmpf("{}", mesh.animation_type).c_str());
 
@@ -1043,6 +1168,7 @@ namespace sys {
 												mesh_unload_from_gpu(mesh);
 												mesh_load_to_gpu(mesh);
 											}
+											world.canvas.frame_drawing_stale = true;
 										}
 
 										ImGui::TreePop();
@@ -1075,28 +1201,32 @@ namespace sys {
 		auto& self = world.loop_timer;
 		auto& settings = world.settings;
 
-		auto now_millis = time_now_millis();
-		const uint64_t delta_time_millis = now_millis - self._last_time_millis;
-		self._last_time_millis = now_millis;
+		const auto now = time_now();
 
-		if (settings.should_limit_fps) {
-			int millis_diff = (1000 / settings.fps_limit) - delta_time_millis;
-			self._millis_till_render = clamp<int64_t>(self._millis_till_render - millis_diff, 0, 1000);
-			if (self._millis_till_render > 0) {
+		if (settings.should_limit_fps && settings.fps_limit > 0) {
+			if (now < self._next_frame_time) {
+				// SDL_Delay may oversleep by a millisecond or more, only sleep when far from deadline
+				if (self._next_frame_time - now > std::chrono::milliseconds(2)) {
+					time_delay_millis(1);
+				}
 				self.ready = false;
 				return;
-			} else {
-				self._millis_till_render = 1000 / settings.fps_limit;
-				self.delta_time = 1.0f/ settings.fps_limit;
 			}
-		} else {
-			self.delta_time = (double) delta_time_millis / 1000;
-		}
 
-		if (self.delta_time < 0.0001f) {
-			self.delta_time = 0.0001f;
+			const auto frame_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(1.0 / settings.fps_limit));
+			self._next_frame_time += frame_period;
+			if (self._next_frame_time < now) {
+				// fell behind (or first frame), don't render a burst to catch up
+				self._next_frame_time = now + frame_period;
+			}
 		}
 
+		// first frame and long stalls are clamped, SimClock drops what it can't step anyway
+		self.delta_time = std::chrono::duration<double>(now - self._last_time).count();
+		self.delta_time = clamp(self.delta_time, 0.0001, 0.25);
+		self._last_time = now;
+
 		self.ready = true;
 	}
 
@@ -1236,23 +1366,100 @@ int main(int argc, char* argv[]) {
 		test_polygons_to_triangles();
 		test_line_segments_to_lines();
 		test_rotational_physics();
+		test_headless_stats();
+		test_sim_clock();
+		test_simulate_script();
+		test_flight_states();
+		test_animation_table();
+		test_terrain();
+		test_broadphase();
+		test_collision();
+		test_raycast();
+		test_frame_graph();
+		test_recorder();
+		test_traffic();
 		return 0;
 	}
 
+	// measured till end of first frame, as program variants are compiled on first use
+	const auto startup_begin = std::chrono::high_resolution_clock::now();
+	bool startup_logged = false;
+
+	bool shader_cache_enabled = true;
+	bool bvh_cache_enabled = true;
+	for (int i = 1; i < argc; i++) {
+		if (argv[i] == mu::StrView("--no-shader-cache")) {
+			shader_cache_enabled = false;
+		} else if (argv[i] == mu::StrView("--no-bvh-cache")) {
+			bvh_cache_enabled = false;
+		}
+	}
+
 	World world {};
 	mu::log_global_logger = (mu::ILogger*) &world.imgui_window_logger;
+	if (bvh_cache_enabled) {
+		world.settings.bvh_cache_dir = mu::str_format("{}/{}", mu::folder_config(mu::memory::tmp()), "open-ysf-bvh-cache");
+	}
+
+	if (headless_parse_args(world.headless, argc, argv) == false) {
+		return 1;
+	}
+
+	if (simulate_parse_args(world.simulate, argc, argv) == false) {
+		return 1;
+	}
+
+	if (recorder_parse_args(world.recorder, world.replay, argc, argv) == false) {
+		return 1;
+	}
+
+	// no SDL, GL or audio, only the flight model
+	if (world.simulate.enabled) {
+		sys::simulate_init(world);
+		if (world.simulate.bench) {
+			sys::simulate_bench(world);
+			return 0;
+		}
+		if (world.replay.path.empty() == false) {
+			mu::log_error("--replay doesn't step physics, it can't run with --simulate");
+			return 1;
+		}
+		sys::recorder_init(world);
+		sys::simulate_run(world);
+		sys::recorder_free(world);
+		sys::simulate_report(world);
+		return 0;
+	}
+
+	workers_init(world.workers, std::thread::hardware_concurrency());
+	mu_defer(workers_free(world.workers));
+
+	// decoding is slow and bursty, keep most cores free for workers
+	job_queue_init(world.jobs, std::thread::hardware_concurrency() / 4);
+	mu_defer(job_queue_free(world.jobs));
 
 	sys::sdl_init(world);
 	mu_defer(sys::sdl_free(world));
 
+	if (shader_cache_enabled) {
+		gl_program_cache_init((GLADloadproc)SDL_GL_GetProcAddress,
+			mu::str_tmpf("{}/{}", mu::folder_config(mu::memory::tmp()), "open-ysf-shader-cache"));
+	}
+	mu_defer(sysmon_free(world.sysmon));
+
 	sys::projection_init(world);
 
-	sys::imgui_init(world);
-	mu_defer(sys::imgui_free(world));
+	if (world.headless.enabled == false) {
+		sys::imgui_init(world);
+	}
+	mu_defer(if (world.headless.enabled == false) { sys::imgui_free(world); });
 
 	sys::canvas_init(world);
 	mu_defer(sys::canvas_free(world));
 
+	sys::textures_init(world);
+	mu_defer(sys::textures_free(world));
+
 	sys::audio_init(world);
 	mu_defer(sys::audio_free(world));
 
@@ -1264,32 +1471,59 @@ int main(int argc, char* argv[]) {
 
 	sys::ground_objs_init(world);
 	mu_defer(sys::ground_objs_free(world));
+	sys::traffic_init(world);
+	mu_defer(sys::traffic_free(world));
 
 	signal_listen(world.signals.quit);
+
+	if (world.headless.enabled) {
+		sys::headless_init(world);
+	}
+	mu_defer(if (world.headless.enabled) { sys::headless_free(world); });
+
+	// after headless, its scenery and aircrafts are replaced by recorded ones
+	sys::replay_init(world);
+	mu_defer(sys::replay_free(world));
+
+	sys::recorder_init(world);
+	mu_defer(sys::recorder_free(world));
+
+	// last so it's first to be freed, nothing runs on simulation thread after that
+	sys::sim_thread_init(world);
+	mu_defer(sys::sim_thread_free(world));
+
 	while (!signal_handle(world.signals.quit)) {
-		sys::loop_timer_update(world);
-		if (!world.loop_timer.ready) {
-			time_delay_millis(2);
-			continue;
-		}
-		TEXT_OVERLAY("fps: {:.2f}", 1.0f/world.loop_timer.delta_time);
+		// from here till kick, simulation thread is idle and world is ours
+		sys::sim_thread_wait(world);
 
-		sys::events_collect(world);
+		if (world.headless.enabled) {
+			sys::headless_frame_begin(world);
+		} else {
+			sys::loop_timer_update(world);
+			if (!world.loop_timer.ready) {
+				continue;
+			}
+			sys::events_collect(world);
+		}
 
+		// GL objects are only loaded and freed here
 		sys::projection_update(world);
-		sys::camera_update(world);
-		sys::cached_matrices_recalc(world);
-
+		sys::textures_update(world);
 		sys::scenery_update(world);
-		sys::scenery_prepare_render(world);
-
 		sys::aircrafts_update(world);
-		sys::aircrafts_prepare_render(world);
-
 		sys::ground_objs_update(world);
-		sys::ground_objs_prepare_render(world);
+		sys::traffic_update(world);
+
+		// windows edit the world, so they're built now and drawn over canvas later
+		if (world.headless.enabled == false) {
+			sys::imgui_rendering_begin(world);
+			sys::imgui_debug_window(world);
+			sys::imgui_logs_window(world);
+			sys::imgui_overlay_text(world);
+		}
 
-		sys::models_handle_collision(world);
+		// simulation thread steps and records next frame while this one is drawn
+		sys::sim_thread_kick(world);
 
 		sys::canvas_rendering_begin(world); {
 			sys::canvas_render_ground(world);
@@ -1322,17 +1556,29 @@ int main(int argc, char* argv[]) {
 			}
 			sys::canvas_render_hud_geoms(world);
 
-			sys::imgui_rendering_begin(world); {
-				sys::imgui_debug_window(world);
-				sys::imgui_logs_window(world);
-				sys::imgui_overlay_text(world);
+			if (world.headless.enabled == false) {
+				sys::imgui_rendering_end(world);
 			}
-			sys::imgui_rendering_end(world);
 		}
 		sys::canvas_rendering_end(world);
 
+		if (startup_logged == false) {
+			startup_logged = true;
+			mu::log_info("startup: first frame after {:.1f} ms, shader cache {} (hits {}, misses {})",
+				std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startup_begin).count(),
+				gl_program_cache.enabled ? "enabled" : "disabled", gl_program_cache.hits, gl_program_cache.misses);
+		}
+
+		if (world.headless.enabled) {
+			sys::headless_frame_end(world);
+		}
+
 		mu::memory::reset_tmp();
 	}
 
+	if (world.headless.enabled) {
+		sys::headless_report(world);
+	}
+
 	return 0;
 }
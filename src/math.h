@@ -46,6 +46,14 @@ inline bool aabbs_intersect(const AABB& a, const AABB& b) {
 	return glm::all(glm::greaterThanEqual(a.max, b.min)) && glm::all(glm::greaterThanEqual(b.max, a.min));
 }
 
+// covers `aabb` all the way from where it was before moving by `displacement`
+inline AABB aabb_swept(const AABB& aabb, const glm::vec3& displacement) {
+	return AABB {
+		.min = glm::min(aabb.min, aabb.min - displacement),
+		.max = glm::max(aabb.max, aabb.max - displacement),
+	};
+}
+
 inline void test_aabbs_intersection() {
 	mu_test_suite("test_aabbs_intersection");
 
@@ -0,0 +1,738 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include <span>
+#include <algorithm>
+#include <filesystem> // std::filesystem
+
+#include <glm/glm.hpp>
+
+#include <mu/utils.h>
+
+#include "simd.h"
+
+constexpr uint32_t RAYCAST_NONE = UINT32_MAX;
+constexpr uint32_t RAYCAST_LEAF_TRIANGLES_MAX = 4;
+constexpr int RAYCAST_SAH_BINS = 16;
+// deeper nodes become leaves whatever their size, traversal stacks are this big
+constexpr int RAYCAST_DEPTH_MAX = 64;
+
+constexpr uint32_t RAYCAST_CACHE_MAGIC = 0x59534256; // "YSBV"
+constexpr uint32_t RAYCAST_CACHE_VERSION = 1;
+
+// what a triangle came from, e.g. to tell what got picked
+enum class RaycastSource : uint8_t {
+	FIELD_MESH,
+	TERRAIN,
+	GROUND_OBJ,
+};
+
+// first vertex and two edges from it, all the ray triangle test reads
+struct RaycastTriangle {
+	glm::vec3 v0, e1, e2;
+};
+
+// same layout as CollisionNode, leaf (count > 0) has triangles [first, first+count),
+// inner node has its children at nodes[first] and nodes[first+1]
+struct RaycastNode {
+	glm::vec3 min;
+	uint32_t first;
+	glm::vec3 max;
+	uint32_t count;
+};
+
+// triangles of static geometry in world space, queried by many rays each frame
+// add triangles then build, building reorders them
+struct RaycastBVH {
+	mu::Vec<RaycastTriangle> triangles;
+	mu::Vec<RaycastSource> sources; // of each triangle
+	mu::Vec<RaycastNode> nodes;
+};
+
+// hits at origin + t * direction, 0 <= t <= t_max, direction doesn't need to be normalized
+struct Ray {
+	glm::vec3 origin, direction;
+	float t_max = FLT_MAX;
+};
+
+struct RaycastHit {
+	float t;
+	uint32_t triangle = RAYCAST_NONE; // index in RaycastBVH::triangles, RAYCAST_NONE if nothing is hit
+};
+
+inline void raycast_bvh_clear(RaycastBVH& self) {
+	self.triangles.clear();
+	self.sources.clear();
+	self.nodes.clear();
+}
+
+inline void raycast_bvh_add(RaycastBVH& self, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, RaycastSource source) {
+	self.triangles.push_back(RaycastTriangle { .v0 = a, .e1 = b - a, .e2 = c - a });
+	self.sources.push_back(source);
+}
+
+// world space normal of a hit triangle, facing the ray
+inline glm::vec3 raycast_hit_normal(const RaycastBVH& self, const RaycastHit& hit, const glm::vec3& direction) {
+	const auto& t = self.triangles[hit.triangle];
+	const auto normal = glm::normalize(glm::cross(t.e1, t.e2));
+	return glm::dot(normal, direction) > 0? -normal : normal;
+}
+
+inline float _raycast_area(const glm::vec3& min, const glm::vec3& max) {
+	const auto d = max - min;
+	return d.x * d.y + d.y * d.z + d.z * d.x;
+}
+
+// binned SAH, see "On fast Construction of SAH-based Bounding Volume Hierarchies" (Ingo Wald)
+inline void _raycast_bvh_build(RaycastBVH& self) {
+	self.nodes.clear();
+	const auto count = (uint32_t) self.triangles.size();
+	if (count == 0) {
+		return;
+	}
+
+	struct Bounds {
+		glm::vec3 min, max;
+	};
+	mu::Vec<Bounds> bounds(mu::memory::tmp());
+	mu::Vec<glm::vec3> centroids(mu::memory::tmp());
+	mu::Vec<uint32_t> indices(mu::memory::tmp());
+	bounds.reserve(count);
+	centroids.reserve(count);
+	indices.reserve(count);
+	for (uint32_t i = 0; i < count; i++) {
+		const auto& t = self.triangles[i];
+		const auto v1 = t.v0 + t.e1, v2 = t.v0 + t.e2;
+		bounds.push_back(Bounds { .min = glm::min(t.v0, glm::min(v1, v2)), .max = glm::max(t.v0, glm::max(v1, v2)) });
+		centroids.push_back((bounds[i].min + bounds[i].max) * 0.5f);
+		indices.push_back(i);
+	}
+
+	struct Task {
+		uint32_t node, depth;
+	};
+	mu::Vec<Task> tasks(mu::memory::tmp());
+	self.nodes.push_back(RaycastNode { .first = 0, .count = count });
+	tasks.push_back(Task { 0, 0 });
+
+	while (tasks.empty() == false) {
+		const auto task = tasks.back();
+		tasks.pop_back();
+
+		const uint32_t first = self.nodes[task.node].first;
+		const uint32_t n = self.nodes[task.node].count;
+
+		Bounds node_bounds {glm::vec3{+FLT_MAX}, glm::vec3{-FLT_MAX}};
+		Bounds centroid_bounds = node_bounds;
+		for (uint32_t i = first; i < first + n; i++) {
+			node_bounds.min = glm::min(node_bounds.min, bounds[indices[i]].min);
+			node_bounds.max = glm::max(node_bounds.max, bounds[indices[i]].max);
+			centroid_bounds.min = glm::min(centroid_bounds.min, centroids[indices[i]]);
+			centroid_bounds.max = glm::max(centroid_bounds.max, centroids[indices[i]]);
+		}
+		self.nodes[task.node].min = node_bounds.min;
+		self.nodes[task.node].max = node_bounds.max;
+
+		if (n <= RAYCAST_LEAF_TRIANGLES_MAX || task.depth + 1 >= RAYCAST_DEPTH_MAX) {
+			continue;
+		}
+
+		// cheapest split of all axes, cost of a split is sum of children areas * their triangles
+		int best_axis = -1, best_split = 0;
+		float best_cost = FLT_MAX;
+		for (int axis = 0; axis < 3; axis++) {
+			const float extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+			if (extent <= 0) {
+				continue;
+			}
+
+			struct Bin {
+				Bounds bounds {glm::vec3{+FLT_MAX}, glm::vec3{-FLT_MAX}};
+				uint32_t count;
+			};
+			Bin bins[RAYCAST_SAH_BINS] {};
+			const float scale = RAYCAST_SAH_BINS / extent;
+			for (uint32_t i = first; i < first + n; i++) {
+				const int b = std::min(int((centroids[indices[i]][axis] - centroid_bounds.min[axis]) * scale), RAYCAST_SAH_BINS-1);
+				bins[b].count++;
+				bins[b].bounds.min = glm::min(bins[b].bounds.min, bounds[indices[i]].min);
+				bins[b].bounds.max = glm::max(bins[b].bounds.max, bounds[indices[i]].max);
+			}
+
+			// right side areas swept from the end, then left side from the start
+			float right_costs[RAYCAST_SAH_BINS];
+			Bounds right {glm::vec3{+FLT_MAX}, glm::vec3{-FLT_MAX}};
+			uint32_t right_count = 0;
+			for (int b = RAYCAST_SAH_BINS-1; b > 0; b--) {
+				right.min = glm::min(right.min, bins[b].bounds.min);
+				right.max = glm::max(right.max, bins[b].bounds.max);
+				right_count += bins[b].count;
+				right_costs[b] = right_count? right_count * _raycast_area(right.min, right.max) : 0;
+			}
+			Bounds left {glm::vec3{+FLT_MAX}, glm::vec3{-FLT_MAX}};
+			uint32_t left_count = 0;
+			for (int b = 0; b < RAYCAST_SAH_BINS-1; b++) {
+				left.min = glm::min(left.min, bins[b].bounds.min);
+				left.max = glm::max(left.max, bins[b].bounds.max);
+				left_count += bins[b].count;
+				if (left_count == 0 || left_count == n) {
+					continue;
+				}
+				const float cost = left_count * _raycast_area(left.min, left.max) + right_costs[b+1];
+				if (cost < best_cost) {
+					best_cost = cost;
+					best_axis = axis;
+					best_split = b + 1;
+				}
+			}
+		}
+
+		uint32_t mid;
+		if (best_axis == -1) {
+			// all centroids at one point, halves are as good as anything
+			mid = first + n / 2;
+		} else {
+			// not worth it if testing all triangles costs less than a split (traversal step ~ one triangle)
+			if (n <= RAYCAST_LEAF_TRIANGLES_MAX * 4 && best_cost >= (n - 1) * _raycast_area(node_bounds.min, node_bounds.max)) {
+				continue;
+			}
+
+			const float scale = RAYCAST_SAH_BINS / (centroid_bounds.max[best_axis] - centroid_bounds.min[best_axis]);
+			const auto it = std::partition(indices.begin() + first, indices.begin() + first + n, [&](uint32_t i) {
+				return std::min(int((centroids[i][best_axis] - centroid_bounds.min[best_axis]) * scale), RAYCAST_SAH_BINS-1) < best_split;
+			});
+			mid = uint32_t(it - indices.begin());
+		}
+
+		const auto children = (uint32_t) self.nodes.size();
+		self.nodes.push_back(RaycastNode { .first = first, .count = mid - first });
+		self.nodes.push_back(RaycastNode { .first = mid, .count = first + n - mid });
+		self.nodes[task.node].first = children;
+		self.nodes[task.node].count = 0;
+		tasks.push_back(Task { children, task.depth + 1 });
+		tasks.push_back(Task { children + 1, task.depth + 1 });
+	}
+
+	// triangles in leaves order
+	mu::Vec<RaycastTriangle> triangles(mu::memory::tmp());
+	mu::Vec<RaycastSource> sources(mu::memory::tmp());
+	triangles.reserve(count);
+	sources.reserve(count);
+	for (uint32_t i : indices) {
+		triangles.push_back(self.triangles[i]);
+		sources.push_back(self.sources[i]);
+	}
+	std::copy(triangles.begin(), triangles.end(), self.triangles.begin());
+	std::copy(sources.begin(), sources.end(), self.sources.begin());
+}
+
+inline uint64_t _raycast_hash(const void* data, size_t size, uint64_t hash) {
+	// FNV-1a over 8 bytes at a time, only has to tell apart scenery versions
+	const auto bytes = (const uint8_t*) data;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		memcpy(&word, bytes + i, 8);
+		hash ^= word;
+		hash *= 0x100000001b3;
+	}
+	for (; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+// a tree rooted at node 0 over `triangles_count` triangles, as `raycast_bvh_build` makes it, traversals trust its
+// children and ranges and their stacks hold RAYCAST_DEPTH_MAX levels
+inline bool _raycast_nodes_valid(std::span<const RaycastNode> nodes, uint32_t triangles_count) {
+	mu::Vec<uint8_t> depths(nodes.size(), mu::memory::tmp());
+	mu::Vec<uint8_t> referenced(nodes.size(), mu::memory::tmp());
+	for (size_t i = 0; i < nodes.size(); i++) {
+		const auto& node = nodes[i];
+		if (i > 0 && referenced[i] == 0) {
+			return false;
+		}
+
+		if (node.count > 0) {
+			if (uint64_t(node.first) + node.count > triangles_count) {
+				return false;
+			}
+			continue;
+		}
+
+		// children are added after their parent, each once, so it can't loop
+		if (node.first <= i || uint64_t(node.first) + 1 >= nodes.size() || depths[i] + 1 >= RAYCAST_DEPTH_MAX
+			|| referenced[node.first] || referenced[node.first + 1]) {
+			return false;
+		}
+		for (uint32_t child : {node.first, node.first + 1}) {
+			referenced[child] = 1;
+			depths[child] = depths[i] + 1;
+		}
+	}
+	return true;
+}
+
+// false if there's no file or it's not of same triangles
+inline bool _raycast_bvh_cache_load(RaycastBVH& self, mu::StrView file_path) {
+	FILE* f = fopen(mu::Str(file_path, mu::memory::tmp()).c_str(), "rb");
+	if (f == nullptr) {
+		return false;
+	}
+	mu_defer(fclose(f));
+
+	uint32_t header[4] {};
+	if (fread(header, sizeof(header), 1, f) != 1 || header[0] != RAYCAST_CACHE_MAGIC || header[1] != RAYCAST_CACHE_VERSION
+		|| header[2] != self.triangles.size() || header[3] == 0 || header[3] > 2 * uint64_t(header[2]) - 1) {
+		return false;
+	}
+
+	mu::Vec<RaycastTriangle> triangles(header[2], mu::memory::tmp());
+	mu::Vec<RaycastSource> sources(header[2], mu::memory::tmp());
+	mu::Vec<RaycastNode> nodes(header[3]);
+	if (fread(triangles.data(), sizeof(RaycastTriangle), triangles.size(), f) != triangles.size()
+		|| fread(sources.data(), sizeof(RaycastSource), sources.size(), f) != sources.size()
+		|| fread(nodes.data(), sizeof(RaycastNode), nodes.size(), f) != nodes.size()
+		|| _raycast_nodes_valid(nodes, header[2]) == false) {
+		return false;
+	}
+
+	std::copy(triangles.begin(), triangles.end(), self.triangles.begin());
+	std::copy(sources.begin(), sources.end(), self.sources.begin());
+	self.nodes = std::move(nodes);
+	return true;
+}
+
+inline void _raycast_bvh_cache_save(const RaycastBVH& self, mu::StrView file_path) {
+	FILE* f = fopen(mu::Str(file_path, mu::memory::tmp()).c_str(), "wb");
+	if (f == nullptr) {
+		mu::log_warning("bvh cache: failed to open '{}'", file_path);
+		return;
+	}
+	mu_defer(fclose(f));
+
+	const uint32_t header[4] {RAYCAST_CACHE_MAGIC, RAYCAST_CACHE_VERSION, (uint32_t) self.triangles.size(), (uint32_t) self.nodes.size()};
+	fwrite(header, sizeof(header), 1, f);
+	fwrite(self.triangles.data(), sizeof(RaycastTriangle), self.triangles.size(), f);
+	fwrite(self.sources.data(), sizeof(RaycastSource), self.sources.size(), f);
+	fwrite(self.nodes.data(), sizeof(RaycastNode), self.nodes.size(), f);
+}
+
+// after all triangles are added, `cache_dir` (empty to not cache) has BVHs keyed by their triangles
+// hashing triangles is much cheaper than building, returns true if it was loaded from cache
+inline bool raycast_bvh_build(RaycastBVH& self, mu::StrView cache_dir = {}) {
+	mu::Str cache_path;
+	if (cache_dir.empty() == false && self.triangles.empty() == false) {
+		auto hash = _raycast_hash(self.triangles.data(), self.triangles.size() * sizeof(RaycastTriangle), 0xcbf29ce484222325);
+		hash = _raycast_hash(self.sources.data(), self.sources.size() * sizeof(RaycastSource), hash);
+		cache_path = mu::str_format("{}/{:016x}.bin", cache_dir, hash);
+
+		if (_raycast_bvh_cache_load(self, cache_path)) {
+			return true;
+		}
+	}
+
+	_raycast_bvh_build(self);
+
+	if (cache_path.empty() == false) {
+		std::error_code ec;
+		std::filesystem::create_directories(std::filesystem::path(cache_dir.begin(), cache_dir.end()), ec);
+		if (ec) {
+			mu::log_warning("bvh cache: failed to create '{}', {}", cache_dir, ec.message());
+		} else {
+			_raycast_bvh_cache_save(self, cache_path);
+		}
+	}
+	return false;
+}
+
+// Möller-Trumbore, both faces
+inline bool _raycast_triangle(const RaycastTriangle& tri, const glm::vec3& origin, const glm::vec3& direction, float t_max, float& t) {
+	const auto p = glm::cross(direction, tri.e2);
+	const float det = glm::dot(tri.e1, p);
+	if (std::abs(det) < 1e-12f) {
+		return false;
+	}
+	const float inv_det = 1.0f / det;
+
+	const auto s = origin - tri.v0;
+	const float u = glm::dot(s, p) * inv_det;
+	if (u < 0 || u > 1) {
+		return false;
+	}
+	const auto q = glm::cross(s, tri.e1);
+	const float v = glm::dot(direction, q) * inv_det;
+	if (v < 0 || u + v > 1) {
+		return false;
+	}
+
+	t = glm::dot(tri.e2, q) * inv_det;
+	return t >= 0 && t <= t_max;
+}
+
+// finite even for directions parallel to an axis, so slabs of a ray starting on a box side
+// give 0 instead of 0 * inf = NaN
+inline glm::vec3 _raycast_inv_direction(const glm::vec3& direction) {
+	glm::vec3 inv;
+	for (int k = 0; k < 3; k++) {
+		inv[k] = 1.0f / (std::abs(direction[k]) > 1e-20f? direction[k] : std::copysign(1e-20f, direction[k]));
+	}
+	return inv;
+}
+
+// t where ray enters node, FLT_MAX if it doesn't before t_max
+inline float _raycast_node_enter(const RaycastNode& node, const glm::vec3& origin, const glm::vec3& inv_direction, float t_max) {
+	const auto t0 = (node.min - origin) * inv_direction;
+	const auto t1 = (node.max - origin) * inv_direction;
+	const auto t_near = glm::min(t0, t1);
+	const auto t_far = glm::max(t0, t1);
+	const float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.0f));
+	const float exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, t_max));
+	return enter <= exit? enter : FLT_MAX;
+}
+
+// closest hit, nearer child first so farther ones are mostly skipped
+inline RaycastHit raycast(const RaycastBVH& self, const Ray& ray) {
+	RaycastHit hit { .t = ray.t_max };
+	if (self.nodes.empty()) {
+		return hit;
+	}
+
+	const auto inv_direction = _raycast_inv_direction(ray.direction);
+
+	struct Entry {
+		uint32_t node;
+		float enter;
+	};
+	Entry stack[RAYCAST_DEPTH_MAX+1];
+	int stack_size = 0;
+
+	const float root_enter = _raycast_node_enter(self.nodes[0], ray.origin, inv_direction, hit.t);
+	if (root_enter != FLT_MAX) {
+		stack[stack_size++] = Entry { 0, root_enter };
+	}
+
+	while (stack_size > 0) {
+		const auto entry = stack[--stack_size];
+		if (entry.enter > hit.t) {
+			continue;
+		}
+
+		const auto& node = self.nodes[entry.node];
+		if (node.count > 0) {
+			for (uint32_t i = node.first; i < node.first + node.count; i++) {
+				float t;
+				if (_raycast_triangle(self.triangles[i], ray.origin, ray.direction, hit.t, t)) {
+					hit.t = t;
+					hit.triangle = i;
+				}
+			}
+			continue;
+		}
+
+		Entry closer {node.first, _raycast_node_enter(self.nodes[node.first], ray.origin, inv_direction, hit.t)};
+		Entry farther {node.first + 1, _raycast_node_enter(self.nodes[node.first + 1], ray.origin, inv_direction, hit.t)};
+		if (farther.enter < closer.enter) {
+			std::swap(closer, farther);
+		}
+		if (farther.enter != FLT_MAX) {
+			stack[stack_size++] = farther;
+		}
+		if (closer.enter != FLT_MAX) {
+			stack[stack_size++] = closer;
+		}
+	}
+
+	return hit;
+}
+
+// anything between origin and origin + t_max * direction, stops at first hit (line of sight)
+inline bool raycast_any(const RaycastBVH& self, const Ray& ray) {
+	if (self.nodes.empty()) {
+		return false;
+	}
+
+	const auto inv_direction = _raycast_inv_direction(ray.direction);
+	uint32_t stack[RAYCAST_DEPTH_MAX+1];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size > 0) {
+		const auto& node = self.nodes[stack[--stack_size]];
+		if (_raycast_node_enter(node, ray.origin, inv_direction, ray.t_max) == FLT_MAX) {
+			continue;
+		}
+
+		if (node.count > 0) {
+			for (uint32_t i = node.first; i < node.first + node.count; i++) {
+				float t;
+				if (_raycast_triangle(self.triangles[i], ray.origin, ray.direction, ray.t_max, t)) {
+					return true;
+				}
+			}
+			continue;
+		}
+
+		stack[stack_size++] = node.first + 1;
+		stack[stack_size++] = node.first;
+	}
+
+	return false;
+}
+
+// 4 rays down the tree together, a node is visited if any of them enters it
+// worth it for rays starting near each other going about same way (camera pixels, fan of sight lines)
+inline void _raycast_packet4(const RaycastBVH& self, const Ray* rays, int count, RaycastHit* hits) {
+	float lanes[10][4];
+	for (int l = 0; l < 4; l++) {
+		// missing lanes are copies of first ray that can't hit anything
+		const auto& ray = rays[l < count? l : 0];
+		const auto inv_direction = _raycast_inv_direction(ray.direction);
+		for (int k = 0; k < 3; k++) {
+			lanes[k][l] = ray.origin[k];
+			lanes[3+k][l] = inv_direction[k];
+			lanes[6+k][l] = ray.direction[k];
+		}
+		lanes[9][l] = l < count? ray.t_max : -1.0f;
+	}
+
+	Float4 origin[3], inv_direction[3], direction[3];
+	for (int k = 0; k < 3; k++) {
+		origin[k] = float4_load(lanes[k]);
+		inv_direction[k] = float4_load(lanes[3+k]);
+		direction[k] = float4_load(lanes[6+k]);
+	}
+	Float4 best_t = float4_load(lanes[9]);
+	uint32_t best_triangle[4] {RAYCAST_NONE, RAYCAST_NONE, RAYCAST_NONE, RAYCAST_NONE};
+
+	uint32_t stack[RAYCAST_DEPTH_MAX+1];
+	int stack_size = 0;
+	if (self.nodes.empty() == false) {
+		stack[stack_size++] = 0;
+	}
+
+	while (stack_size > 0) {
+		const auto& node = self.nodes[stack[--stack_size]];
+
+		Float4 enter = 0.0f, exit = best_t;
+		for (int k = 0; k < 3; k++) {
+			const auto t0 = (Float4(node.min[k]) - origin[k]) * inv_direction[k];
+			const auto t1 = (Float4(node.max[k]) - origin[k]) * inv_direction[k];
+			enter = float4_max(enter, float4_min(t0, t1));
+			exit = float4_min(exit, float4_max(t0, t1));
+		}
+		if (bool4_any(exit >= enter) == false) {
+			continue;
+		}
+
+		if (node.count == 0) {
+			stack[stack_size++] = node.first + 1;
+			stack[stack_size++] = node.first;
+			continue;
+		}
+
+		for (uint32_t i = node.first; i < node.first + node.count; i++) {
+			const auto& tri = self.triangles[i];
+			const Float4 e1[3] {tri.e1.x, tri.e1.y, tri.e1.z};
+			const Float4 e2[3] {tri.e2.x, tri.e2.y, tri.e2.z};
+
+			const Float4 p[3] {
+				direction[1] * e2[2] - direction[2] * e2[1],
+				direction[2] * e2[0] - direction[0] * e2[2],
+				direction[0] * e2[1] - direction[1] * e2[0],
+			};
+			const auto det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+			const auto inv_det = Float4(1.0f) / det;
+
+			const Float4 s[3] {origin[0] - Float4(tri.v0.x), origin[1] - Float4(tri.v0.y), origin[2] - Float4(tri.v0.z)};
+			const auto u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv_det;
+			const Float4 q[3] {
+				s[1] * e1[2] - s[2] * e1[1],
+				s[2] * e1[0] - s[0] * e1[2],
+				s[0] * e1[1] - s[1] * e1[0],
+			};
+			const auto v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inv_det;
+			const auto t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv_det;
+
+			const auto mask = (float4_abs(det) > Float4(1e-12f)) & (u >= Float4(0.0f)) & (v >= Float4(0.0f))
+				& (Float4(1.0f) >= u + v) & (t >= Float4(0.0f)) & (best_t >= t);
+			if (bool4_any(mask) == false) {
+				continue;
+			}
+
+			float old_t[4], new_t[4];
+			float4_store(old_t, best_t);
+			best_t = float4_select(mask, t, best_t);
+			float4_store(new_t, best_t);
+			for (int l = 0; l < 4; l++) {
+				if (new_t[l] != old_t[l]) {
+					best_triangle[l] = i;
+				}
+			}
+		}
+	}
+
+	float t[4];
+	float4_store(t, best_t);
+	for (int l = 0; l < count; l++) {
+		hits[l] = RaycastHit { .t = t[l], .triangle = best_triangle[l] };
+	}
+}
+
+// closest hits of many rays, in packets of 4 consecutive rays, so order coherent rays next to each other
+inline void raycast_batch(const RaycastBVH& self, std::span<const Ray> rays, std::span<RaycastHit> hits) {
+	mu_assert(hits.size() >= rays.size());
+	for (size_t i = 0; i < rays.size(); i += 4) {
+		_raycast_packet4(self, rays.data() + i, (int) std::min<size_t>(4, rays.size() - i), hits.data() + i);
+	}
+}
+
+inline void test_raycast() {
+	mu_test_suite("raycast");
+
+	// 40x40 quads of hills on xz (-y up), and a wall standing on them
+	auto height = [](float x, float z) {
+		return -3.0f * std::sin(x * 0.3f) * std::cos(z * 0.2f);
+	};
+	RaycastBVH bvh {};
+	for (int x = 0; x < 40; x++) {
+		for (int z = 0; z < 40; z++) {
+			const glm::vec3 p {float(x), height(x, z), float(z)};
+			const glm::vec3 px {float(x+1), height(x+1, z), float(z)};
+			const glm::vec3 pz {float(x), height(x, z+1), float(z+1)};
+			const glm::vec3 pxz {float(x+1), height(x+1, z+1), float(z+1)};
+			raycast_bvh_add(bvh, p, px, pz, RaycastSource::TERRAIN);
+			raycast_bvh_add(bvh, px, pxz, pz, RaycastSource::TERRAIN);
+		}
+	}
+	raycast_bvh_add(bvh, {20, -20, 10}, {20, -20, 30}, {20, 5, 10}, RaycastSource::FIELD_MESH);
+	raycast_bvh_add(bvh, {20, -20, 30}, {20, 5, 30}, {20, 5, 10}, RaycastSource::FIELD_MESH);
+
+	const auto unsorted = bvh.triangles;
+	const auto unsorted_sources = bvh.sources;
+	mu_test(raycast_bvh_build(bvh) == false);
+	mu_test(bvh.nodes.size() > 1);
+	mu_test(bvh.triangles.size() == unsorted.size());
+
+	auto brute_force = [&](const Ray& ray) {
+		RaycastHit hit { .t = ray.t_max };
+		for (uint32_t i = 0; i < unsorted.size(); i++) {
+			float t;
+			if (_raycast_triangle(unsorted[i], ray.origin, ray.direction, hit.t, t)) {
+				hit = RaycastHit { .t = t, .triangle = i };
+			}
+		}
+		return hit;
+	};
+
+	// closest hit and any hit agree with testing every triangle, in any direction
+	mu::Vec<Ray> rays;
+	uint32_t random = 3;
+	auto random_float = [&random](float min, float max) {
+		random = random * 1664525u + 1013904223u;
+		return min + (random >> 8) / float(1 << 24) * (max - min);
+	};
+	for (int i = 0; i < 500; i++) {
+		rays.push_back(Ray {
+			.origin = {random_float(-5, 45), random_float(-15, 5), random_float(-5, 45)},
+			.direction = {random_float(-1, 1), random_float(-1, 1), random_float(-1, 1)},
+			.t_max = i % 5 == 0? random_float(1, 10) : FLT_MAX,
+		});
+	}
+	mu::Vec<RaycastHit> batch_hits(rays.size());
+	raycast_batch(bvh, rays, batch_hits);
+
+	{
+		int hits = 0, mismatches = 0;
+		for (size_t i = 0; i < rays.size(); i++) {
+			const auto expected = brute_force(rays[i]);
+			const auto hit = raycast(bvh, rays[i]);
+			hits += expected.triangle != RAYCAST_NONE;
+
+			const bool same_hit = (hit.triangle == RAYCAST_NONE) == (expected.triangle == RAYCAST_NONE)
+				&& std::abs(hit.t - expected.t) < 1e-4f;
+			const bool same_batch_hit = (batch_hits[i].triangle == RAYCAST_NONE) == (expected.triangle == RAYCAST_NONE)
+				&& std::abs(batch_hits[i].t - expected.t) < 1e-3f;
+			mismatches += !same_hit || !same_batch_hit || raycast_any(bvh, rays[i]) != (expected.triangle != RAYCAST_NONE);
+		}
+		mu_test(hits > 50 && hits < 450);
+		mu_test(mismatches == 0);
+	}
+
+	// wall blocks line of sight, its triangle is reported
+	{
+		const Ray ray {.origin = {10, -10, 20}, .direction = {1, 0, 0}, .t_max = 20};
+		mu_test(raycast_any(bvh, ray));
+		const auto hit = raycast(bvh, ray);
+		mu_test(hit.triangle != RAYCAST_NONE && bvh.sources[hit.triangle] == RaycastSource::FIELD_MESH);
+		mu_test(std::abs(hit.t - 10) < 1e-4f);
+		mu_test(glm::length(raycast_hit_normal(bvh, hit, ray.direction) - glm::vec3{-1, 0, 0}) < 1e-4f);
+
+		mu_test(raycast_any(bvh, Ray {.origin = {10, -10, 20}, .direction = {1, 0, 0}, .t_max = 9}) == false);
+	}
+
+	// parallel to axes from box sides, where slabs give 0 * inf
+	{
+		for (const auto& ray : {Ray {.origin = {10, -50, 20}, .direction = {0, 1, 0}}, Ray {.origin = {10, -10, 20}, .direction = {1, 0, 0}}}) {
+			const auto expected = brute_force(ray);
+			mu_test(expected.triangle != RAYCAST_NONE);
+			mu_test(std::abs(raycast(bvh, ray).t - expected.t) < 1e-4f);
+			RaycastHit hit;
+			raycast_batch(bvh, std::span(&ray, 1), std::span(&hit, 1));
+			mu_test(std::abs(hit.t - expected.t) < 1e-3f);
+		}
+	}
+
+	// straight down finds terrain height
+	{
+		const auto hit = raycast(bvh, Ray {.origin = {12.5f, -50, 7.5f}, .direction = {0, 1, 0}});
+		mu_test(hit.triangle != RAYCAST_NONE && bvh.sources[hit.triangle] == RaycastSource::TERRAIN);
+		mu_test(std::abs(-50 + hit.t - height(12.5f, 7.5f)) < 0.2f);
+	}
+
+	// cached BVH is the same as built one
+	{
+		const auto cache_dir = (std::filesystem::temp_directory_path() / "open-ysf-test-bvh-cache").string();
+		std::filesystem::remove_all(cache_dir);
+
+		RaycastBVH built {.triangles = unsorted, .sources = unsorted_sources};
+		mu_test(raycast_bvh_build(built, cache_dir) == false);
+
+		RaycastBVH cached {.triangles = unsorted, .sources = unsorted_sources};
+		mu_test(raycast_bvh_build(cached, cache_dir));
+		mu_test(cached.nodes.size() == built.nodes.size());
+		mu_test(memcmp(cached.triangles.data(), built.triangles.data(), built.triangles.size() * sizeof(RaycastTriangle)) == 0);
+
+		const auto hit = raycast(cached, rays[7]);
+		mu_test(hit.t == raycast(built, rays[7]).t);
+
+		// corrupt node counts, ranges and children are rejected and built again
+		mu::Vec<std::filesystem::path> files;
+		for (const auto& entry : std::filesystem::directory_iterator(cache_dir)) {
+			files.push_back(entry.path());
+		}
+		mu_test(files.size() == 1);
+		const auto corrupt = [&](long offset, uint32_t value) {
+			FILE* f = fopen(files[0].string().c_str(), "r+b");
+			fseek(f, offset, SEEK_SET);
+			fwrite(&value, sizeof(value), 1, f);
+			fclose(f);
+
+			RaycastBVH loaded {.triangles = unsorted, .sources = unsorted_sources};
+			const bool from_cache = raycast_bvh_build(loaded, cache_dir);
+			const bool same_hit = raycast(loaded, rays[7]).t == raycast(built, rays[7]).t;
+			return from_cache == false && same_hit;
+		};
+		const long nodes_offset = sizeof(uint32_t) * 4 + built.triangles.size() * (sizeof(RaycastTriangle) + sizeof(RaycastSource));
+		mu_test(corrupt(sizeof(uint32_t) * 3, 0x7fffffff));
+		mu_test(corrupt(nodes_offset + offsetof(RaycastNode, first), 0));
+		mu_test(corrupt(nodes_offset + sizeof(RaycastNode) + offsetof(RaycastNode, count), 0xffffff));
+
+		std::filesystem::remove_all(cache_dir);
+	}
+}
@@ -0,0 +1,100 @@
+#include "world.h"
+
+namespace sys {
+
+	void recorder_init(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.recorder;
+		if (self.path.empty()) {
+			return;
+		}
+
+		mu::Vec<mu::Str> aircraft_names;
+		for (const auto& aircraft : world.aircrafts) {
+			aircraft_names.push_back(aircraft.aircraft_template.short_name);
+		}
+		if (recorder_open(self, world.scenery.scenery_template.name, aircraft_names) == false) {
+			return;
+		}
+		self.samples.reserve(aircraft_names.size());
+
+		mu::log_info("recorder: recording {} aircrafts on '{}' into '{}'",
+			aircraft_names.size(), world.scenery.scenery_template.name, self.path);
+	}
+
+	void recorder_free(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.recorder;
+		if (self.file == nullptr) {
+			return;
+		}
+
+		recorder_close(self);
+		mu::log_info("recorder: {} ticks in {} bytes written to '{}', {} ticks dropped",
+			self.tick, self.written_bytes, self.path, self.dropped_ticks);
+	}
+
+	// after each aircrafts_step, on simulation thread
+	void recorder_step(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.recorder;
+		if (self.file == nullptr) {
+			return;
+		}
+
+		// aircrafts are known by their index in the file
+		if (world.aircrafts.size() != self.aircrafts_count) {
+			mu::log_warning("recorder: aircrafts changed from {} to {}, recording stopped", self.aircrafts_count, world.aircrafts.size());
+			recorder_free(world);
+			return;
+		}
+
+		self.samples.clear();
+		for (const auto& aircraft : world.aircrafts) {
+			self.samples.push_back(recorder_sample_from_state(aircraft_recorder_state(aircraft)));
+		}
+		recorder_push(self, self.samples);
+	}
+
+	// replaces scenery and aircrafts with recorded ones, they're only loaded on first update so it's cheap
+	void replay_init(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.replay;
+		if (self.path.empty()) {
+			return;
+		}
+
+		if (replay_open(self) == false) {
+			mu::panic("replay: failed to open '{}'", self.path);
+		}
+
+		auto scenery_template = world.scenery_templates.find(self.scenery_name);
+		if (scenery_template == world.scenery_templates.end()) {
+			mu::panic("replay: scenery '{}' not found", self.scenery_name);
+		}
+		world.scenery = scenery_new(scenery_template->second);
+
+		world.aircrafts.clear();
+		for (const auto& name : self.aircraft_names) {
+			auto aircraft_template = world.aircraft_templates.find(name);
+			if (aircraft_template == world.aircraft_templates.end()) {
+				mu::panic("replay: aircraft '{}' not found", name);
+			}
+			world.aircrafts.push_back(aircraft_new(aircraft_template->second));
+		}
+		world.camera.aircraft = &world.aircrafts[0];
+
+		mu::log_info("replay: {} aircrafts on '{}' from '{}'", self.aircraft_names.size(), self.scenery_name, self.path);
+	}
+
+	void replay_free(World& world) {
+		DEF_SYSTEM
+
+		replay_close(world.replay);
+	}
+
+}
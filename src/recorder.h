@@ -0,0 +1,612 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <mu/utils.h>
+
+// file is a header then chunks, all little endian:
+// header: magic, u32 version, str scenery, u32 aircrafts count, str aircraft short name for each (str is u32 size then bytes)
+// chunk: u64 first tick, u32 ticks count, u32 bytes count, bytes (ticks of all aircrafts, see RecorderCodec)
+constexpr char RECORDER_MAGIC[8] = {'O', 'Y', 'S', 'F', 'R', 'E', 'C', '1'};
+constexpr uint32_t RECORDER_VERSION = 1;
+
+// memory of a recording is RECORDER_CHUNKS chunks, however long it runs
+constexpr size_t RECORDER_CHUNK_BYTES = 64 * 1024;
+constexpr size_t RECORDER_CHUNKS = 16;
+
+// what's recorded of an aircraft each simulation step, and what replay sets back
+struct RecorderState {
+	glm::vec3 translation;
+	glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+	glm::vec3 velocity;
+	float throttle, elevator, aileron, rudder;
+	float engine_speed, landing_gear_alpha;
+	float fuel; // tons
+	bool braking, burner_enabled, engine_cutoff, visible;
+};
+
+// fields of a sample, in the order they're coded
+enum RecorderField {
+	RECORDER_FIELD_TRANSLATION_X, // mm
+	RECORDER_FIELD_TRANSLATION_Y,
+	RECORDER_FIELD_TRANSLATION_Z,
+	RECORDER_FIELD_ORIENTATION_W, // 1/32767
+	RECORDER_FIELD_ORIENTATION_X,
+	RECORDER_FIELD_ORIENTATION_Y,
+	RECORDER_FIELD_ORIENTATION_Z,
+	RECORDER_FIELD_VELOCITY_X,    // mm/s
+	RECORDER_FIELD_VELOCITY_Y,
+	RECORDER_FIELD_VELOCITY_Z,
+	RECORDER_FIELD_THROTTLE,      // 1/10000 for this and all controls
+	RECORDER_FIELD_ELEVATOR,
+	RECORDER_FIELD_AILERON,
+	RECORDER_FIELD_RUDDER,
+	RECORDER_FIELD_ENGINE_SPEED,
+	RECORDER_FIELD_LANDING_GEAR,
+	RECORDER_FIELD_FUEL,          // g
+	RECORDER_FIELD_FLAGS,         // braking, burner_enabled, engine_cutoff, visible from lowest bit
+
+	RECORDER_FIELDS_COUNT,
+};
+
+// RecorderState in fixed point, replay gives back exactly these whatever machine decodes it
+struct RecorderSample {
+	int32_t fields[RECORDER_FIELDS_COUNT];
+};
+
+inline RecorderSample recorder_sample_from_state(const RecorderState& state) {
+	const auto q = [](float value, float scale) { return int32_t(std::lround(double(value) * scale)); };
+
+	RecorderSample self {};
+	auto& f = self.fields;
+	f[RECORDER_FIELD_TRANSLATION_X] = q(state.translation.x, 1000);
+	f[RECORDER_FIELD_TRANSLATION_Y] = q(state.translation.y, 1000);
+	f[RECORDER_FIELD_TRANSLATION_Z] = q(state.translation.z, 1000);
+	f[RECORDER_FIELD_ORIENTATION_W] = q(state.orientation.w, 32767);
+	f[RECORDER_FIELD_ORIENTATION_X] = q(state.orientation.x, 32767);
+	f[RECORDER_FIELD_ORIENTATION_Y] = q(state.orientation.y, 32767);
+	f[RECORDER_FIELD_ORIENTATION_Z] = q(state.orientation.z, 32767);
+	f[RECORDER_FIELD_VELOCITY_X] = q(state.velocity.x, 1000);
+	f[RECORDER_FIELD_VELOCITY_Y] = q(state.velocity.y, 1000);
+	f[RECORDER_FIELD_VELOCITY_Z] = q(state.velocity.z, 1000);
+	f[RECORDER_FIELD_THROTTLE] = q(state.throttle, 10000);
+	f[RECORDER_FIELD_ELEVATOR] = q(state.elevator, 10000);
+	f[RECORDER_FIELD_AILERON] = q(state.aileron, 10000);
+	f[RECORDER_FIELD_RUDDER] = q(state.rudder, 10000);
+	f[RECORDER_FIELD_ENGINE_SPEED] = q(state.engine_speed, 10000);
+	f[RECORDER_FIELD_LANDING_GEAR] = q(state.landing_gear_alpha, 10000);
+	f[RECORDER_FIELD_FUEL] = q(state.fuel, 1e6f);
+	f[RECORDER_FIELD_FLAGS] = (state.braking << 0) | (state.burner_enabled << 1) | (state.engine_cutoff << 2) | (state.visible << 3);
+	return self;
+}
+
+inline RecorderState recorder_state_from_sample(const RecorderSample& self) {
+	const auto& f = self.fields;
+	const auto v = [&](RecorderField field, float scale) { return float(f[field] / double(scale)); };
+
+	RecorderState state {};
+	state.translation = {v(RECORDER_FIELD_TRANSLATION_X, 1000), v(RECORDER_FIELD_TRANSLATION_Y, 1000), v(RECORDER_FIELD_TRANSLATION_Z, 1000)};
+	state.orientation = glm::normalize(glm::quat{
+		v(RECORDER_FIELD_ORIENTATION_W, 32767), v(RECORDER_FIELD_ORIENTATION_X, 32767),
+		v(RECORDER_FIELD_ORIENTATION_Y, 32767), v(RECORDER_FIELD_ORIENTATION_Z, 32767),
+	});
+	state.velocity = {v(RECORDER_FIELD_VELOCITY_X, 1000), v(RECORDER_FIELD_VELOCITY_Y, 1000), v(RECORDER_FIELD_VELOCITY_Z, 1000)};
+	state.throttle = v(RECORDER_FIELD_THROTTLE, 10000);
+	state.elevator = v(RECORDER_FIELD_ELEVATOR, 10000);
+	state.aileron = v(RECORDER_FIELD_AILERON, 10000);
+	state.rudder = v(RECORDER_FIELD_RUDDER, 10000);
+	state.engine_speed = v(RECORDER_FIELD_ENGINE_SPEED, 10000);
+	state.landing_gear_alpha = v(RECORDER_FIELD_LANDING_GEAR, 10000);
+	state.fuel = v(RECORDER_FIELD_FUEL, 1e6f);
+	state.braking        = f[RECORDER_FIELD_FLAGS] & (1 << 0);
+	state.burner_enabled = f[RECORDER_FIELD_FLAGS] & (1 << 1);
+	state.engine_cutoff  = f[RECORDER_FIELD_FLAGS] & (1 << 2);
+	state.visible        = f[RECORDER_FIELD_FLAGS] & (1 << 3);
+	return state;
+}
+
+// each field is coded as its difference from a prediction, zigzag then LEB128 so small differences take a byte,
+// translation predicts constant velocity (2*prev - prev2), the rest predicts no change,
+// prediction starts from zeros at each chunk so chunks decode on their own
+struct RecorderCodec {
+	mu::Vec<RecorderSample> prev, prev2;
+	bool first;
+};
+
+// worst case bytes of one tick, 5 bytes a field
+inline size_t recorder_tick_bytes_max(size_t aircrafts_count) {
+	return aircrafts_count * RECORDER_FIELDS_COUNT * 5;
+}
+
+// of a chunk, big enough for a couple of ticks even with lots of aircrafts, replay rejects bigger ones
+inline size_t recorder_chunk_bytes(size_t aircrafts_count) {
+	return std::max(RECORDER_CHUNK_BYTES, 2 * recorder_tick_bytes_max(aircrafts_count));
+}
+
+inline void recorder_codec_reset(RecorderCodec& self, size_t aircrafts_count) {
+	self.prev = mu::Vec<RecorderSample>(aircrafts_count, RecorderSample {});
+	self.prev2 = mu::Vec<RecorderSample>(aircrafts_count, RecorderSample {});
+	self.first = true;
+}
+
+// wraps around instead of overflowing, encoder and decoder wrap the same
+inline uint32_t _recorder_codec_predict(const RecorderCodec& self, size_t aircraft, int field) {
+	const uint32_t prev = self.prev[aircraft].fields[field];
+	if (field <= RECORDER_FIELD_TRANSLATION_Z) {
+		return 2 * prev - uint32_t(self.prev2[aircraft].fields[field]);
+	}
+	return prev;
+}
+
+inline void _recorder_codec_advance(RecorderCodec& self, const mu::Vec<RecorderSample>& samples) {
+	// second tick of a chunk has no velocity to predict with yet, it predicts no change
+	self.prev2 = self.first? samples : self.prev;
+	self.prev = samples;
+	self.first = false;
+}
+
+inline void recorder_codec_encode(RecorderCodec& self, const mu::Vec<RecorderSample>& samples, mu::Vec<uint8_t>& out) {
+	for (size_t i = 0; i < samples.size(); i++) {
+		for (int field = 0; field < RECORDER_FIELDS_COUNT; field++) {
+			const int32_t delta = int32_t(uint32_t(samples[i].fields[field]) - _recorder_codec_predict(self, i, field));
+			uint32_t zigzag = (uint32_t(delta) << 1) ^ uint32_t(delta >> 31);
+			while (zigzag >= 0x80) {
+				out.push_back(uint8_t(zigzag | 0x80));
+				zigzag >>= 7;
+			}
+			out.push_back(uint8_t(zigzag));
+		}
+	}
+	_recorder_codec_advance(self, samples);
+}
+
+// reads one tick of `samples.size()` aircrafts from `p`, returns false if it's truncated
+inline bool recorder_codec_decode(RecorderCodec& self, const uint8_t*& p, const uint8_t* end, mu::Vec<RecorderSample>& samples) {
+	for (size_t i = 0; i < samples.size(); i++) {
+		for (int field = 0; field < RECORDER_FIELDS_COUNT; field++) {
+			uint32_t zigzag = 0;
+			for (int shift = 0; ; shift += 7) {
+				if (p == end || shift > 28) {
+					return false;
+				}
+				const uint8_t byte = *p++;
+				zigzag |= uint32_t(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0) {
+					break;
+				}
+			}
+			const uint32_t delta = (zigzag >> 1) ^ (0 - (zigzag & 1));
+			samples[i].fields[field] = int32_t(_recorder_codec_predict(self, i, field) + delta);
+		}
+	}
+	_recorder_codec_advance(self, samples);
+	return true;
+}
+
+struct RecorderChunk {
+	uint64_t first_tick;
+	uint32_t ticks;
+	mu::Vec<uint8_t> bytes;
+};
+
+inline void _recorder_write_str(FILE* f, mu::StrView str) {
+	const uint32_t size = str.size();
+	fwrite(&size, sizeof(size), 1, f);
+	fwrite(str.data(), 1, size, f);
+}
+
+inline bool _recorder_read_str(FILE* f, mu::Str& str) {
+	char buf[256];
+	uint32_t size;
+	if (fread(&size, sizeof(size), 1, f) != 1 || size > sizeof(buf) || fread(buf, 1, size, f) != size) {
+		return false;
+	}
+	str = mu::Str(buf, buf + size, mu::memory::default_allocator());
+	return true;
+}
+
+// `--record <path>` writes every aircraft's state each simulation step, chunks are filled on simulation thread
+// and written by a thread of recorder's own, when it falls behind by all chunks, the chunk just filled is dropped
+// and its ticks are counted in `dropped_ticks`, replay holds the last state over them
+struct Recorder {
+	mu::Str path;
+
+	FILE* file;
+	size_t aircrafts_count;
+	RecorderCodec codec;
+
+	// ring, [full_first, full_first+full_count) wait for writer, `filling` is the one being encoded into
+	mu::Vec<RecorderChunk> chunks;
+	size_t filling, full_first, full_count;
+
+	uint64_t tick;
+	uint64_t dropped_ticks;
+	uint64_t written_bytes;
+
+	// of all aircrafts each tick, kept to not allocate per tick
+	mu::Vec<RecorderSample> samples;
+
+	std::thread writer;
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool quit;
+};
+
+inline void _recorder_writer_main(Recorder* self) {
+	while (true) {
+		RecorderChunk* chunk;
+		{
+			std::unique_lock lock(self->mutex);
+			self->cv.wait(lock, [&] { return self->full_count > 0 || self->quit; });
+			if (self->full_count == 0) {
+				return;
+			}
+			chunk = &self->chunks[self->full_first];
+		}
+
+		// chunk is ours till it's released below
+		fwrite(&chunk->first_tick, sizeof(chunk->first_tick), 1, self->file);
+		fwrite(&chunk->ticks, sizeof(chunk->ticks), 1, self->file);
+		const uint32_t size = chunk->bytes.size();
+		fwrite(&size, sizeof(size), 1, self->file);
+		fwrite(chunk->bytes.data(), 1, size, self->file);
+
+		{
+			std::lock_guard lock(self->mutex);
+			self->written_bytes += sizeof(chunk->first_tick) + sizeof(chunk->ticks) + sizeof(size) + size;
+			self->full_first = (self->full_first + 1) % self->chunks.size();
+			self->full_count--;
+		}
+	}
+}
+
+inline void _recorder_chunk_begin(Recorder& self) {
+	auto& chunk = self.chunks[self.filling];
+	chunk.first_tick = self.tick;
+	chunk.ticks = 0;
+	chunk.bytes.clear();
+	recorder_codec_reset(self.codec, self.aircrafts_count);
+}
+
+// hands filled chunk to writer, or drops it if writer holds all others
+inline void _recorder_chunk_end(Recorder& self) {
+	auto& chunk = self.chunks[self.filling];
+	if (chunk.ticks == 0) {
+		return;
+	}
+
+	{
+		std::lock_guard lock(self.mutex);
+		if (self.full_count + 1 < self.chunks.size()) {
+			self.full_count++;
+			self.filling = (self.filling + 1) % self.chunks.size();
+		} else {
+			self.dropped_ticks += chunk.ticks;
+		}
+	}
+	self.cv.notify_one();
+}
+
+inline bool recorder_open(Recorder& self, mu::StrView scenery_name, const mu::Vec<mu::Str>& aircraft_names) {
+	self.file = fopen(self.path.c_str(), "wb");
+	if (self.file == nullptr) {
+		mu::log_error("recorder: failed to open '{}'", self.path);
+		return false;
+	}
+
+	fwrite(RECORDER_MAGIC, 1, sizeof(RECORDER_MAGIC), self.file);
+	fwrite(&RECORDER_VERSION, sizeof(RECORDER_VERSION), 1, self.file);
+	_recorder_write_str(self.file, scenery_name);
+	const uint32_t count = aircraft_names.size();
+	fwrite(&count, sizeof(count), 1, self.file);
+	for (const auto& name : aircraft_names) {
+		_recorder_write_str(self.file, name);
+	}
+
+	const size_t chunk_bytes = recorder_chunk_bytes(count);
+	self.chunks = mu::Vec<RecorderChunk>(RECORDER_CHUNKS);
+	for (auto& chunk : self.chunks) {
+		chunk.bytes.reserve(chunk_bytes);
+	}
+
+	self.aircrafts_count = count;
+	self.filling = self.full_first = self.full_count = 0;
+	self.tick = self.dropped_ticks = self.written_bytes = 0;
+	self.quit = false;
+	_recorder_chunk_begin(self);
+
+	self.writer = std::thread(_recorder_writer_main, &self);
+	return true;
+}
+
+// `samples` are of all aircrafts, in the order of names given to recorder_open
+inline void recorder_push(Recorder& self, const mu::Vec<RecorderSample>& samples) {
+	mu_assert(samples.size() == self.aircrafts_count);
+
+	if (self.chunks[self.filling].bytes.size() + recorder_tick_bytes_max(self.aircrafts_count) > self.chunks[self.filling].bytes.capacity()) {
+		_recorder_chunk_end(self);
+		_recorder_chunk_begin(self);
+	}
+
+	auto& chunk = self.chunks[self.filling];
+	recorder_codec_encode(self.codec, samples, chunk.bytes);
+	chunk.ticks++;
+	self.tick++;
+}
+
+// writes what's left and waits for writer
+inline void recorder_close(Recorder& self) {
+	if (self.file == nullptr) {
+		return;
+	}
+
+	_recorder_chunk_end(self);
+	{
+		std::lock_guard lock(self.mutex);
+		self.quit = true;
+	}
+	self.cv.notify_one();
+	self.writer.join();
+
+	fclose(self.file);
+	self.file = nullptr;
+}
+
+// `--replay <path>` sets aircrafts' state from a recording instead of stepping their physics,
+// chunks are read one at a time as replay reaches them
+struct Replay {
+	mu::Str path;
+
+	FILE* file;
+	mu::Str scenery_name;
+	mu::Vec<mu::Str> aircraft_names;
+
+	RecorderCodec codec;
+	RecorderChunk chunk;
+	size_t offset;
+	uint32_t chunk_tick;
+
+	// of last replay_next
+	uint64_t tick;
+	// ticks before chunk's first one were dropped by recorder when it's ahead of this
+	uint64_t next_tick;
+	mu::Vec<RecorderSample> samples;
+	bool finished;
+};
+
+inline bool replay_open(Replay& self) {
+	self.file = fopen(self.path.c_str(), "rb");
+	if (self.file == nullptr) {
+		mu::log_error("replay: failed to open '{}'", self.path);
+		return false;
+	}
+
+	char magic[sizeof(RECORDER_MAGIC)];
+	uint32_t version, count;
+	bool ok = fread(magic, 1, sizeof(magic), self.file) == sizeof(magic)
+		&& memcmp(magic, RECORDER_MAGIC, sizeof(magic)) == 0
+		&& fread(&version, sizeof(version), 1, self.file) == 1
+		&& version == RECORDER_VERSION
+		&& _recorder_read_str(self.file, self.scenery_name)
+		&& fread(&count, sizeof(count), 1, self.file) == 1
+		&& count > 0;
+	self.aircraft_names.clear();
+	for (uint32_t i = 0; ok && i < count; i++) {
+		ok = _recorder_read_str(self.file, self.aircraft_names.emplace_back());
+	}
+	if (ok == false) {
+		mu::log_error("replay: '{}' isn't a recording of version {}", self.path, RECORDER_VERSION);
+		fclose(self.file);
+		self.file = nullptr;
+		return false;
+	}
+
+	self.samples = mu::Vec<RecorderSample>(count, RecorderSample {});
+	self.chunk = {};
+	self.offset = self.chunk_tick = 0;
+	self.next_tick = 0;
+	self.finished = false;
+	return true;
+}
+
+// decodes next tick into `samples`, returns false when recording ended
+inline bool replay_next(Replay& self) {
+	if (self.finished) {
+		return false;
+	}
+
+	while (self.chunk_tick == self.chunk.ticks) {
+		uint32_t size = 0;
+		const bool ok = fread(&self.chunk.first_tick, sizeof(self.chunk.first_tick), 1, self.file) == 1
+			&& fread(&self.chunk.ticks, sizeof(self.chunk.ticks), 1, self.file) == 1
+			&& fread(&size, sizeof(size), 1, self.file) == 1;
+		if (ok == false) {
+			self.finished = true;
+			return false;
+		}
+		if (size > recorder_chunk_bytes(self.aircraft_names.size())) {
+			mu::log_error("replay: '{}' has a chunk of {} bytes at tick {}, more than recorder writes",
+				self.path, size, self.chunk.first_tick);
+			self.finished = true;
+			return false;
+		}
+		if (self.chunk.first_tick < self.next_tick) {
+			mu::log_error("replay: '{}' has a chunk at tick {} after tick {}", self.path, self.chunk.first_tick, self.next_tick);
+			self.finished = true;
+			return false;
+		}
+		if (self.chunk.first_tick > self.next_tick) {
+			mu::log_warning("replay: '{}' misses ticks [{}, {}) recorder dropped, holding last state over them",
+				self.path, self.next_tick, self.chunk.first_tick);
+		}
+		self.chunk.bytes.resize(size);
+		if (fread(self.chunk.bytes.data(), 1, size, self.file) != size) {
+			self.finished = true;
+			return false;
+		}
+		self.offset = 0;
+		self.chunk_tick = 0;
+		recorder_codec_reset(self.codec, self.samples.size());
+	}
+
+	// keeps time of recording, samples stay as they were
+	if (self.next_tick < self.chunk.first_tick) {
+		self.tick = self.next_tick++;
+		return true;
+	}
+
+	const uint8_t* p = self.chunk.bytes.data() + self.offset;
+	const uint8_t* end = self.chunk.bytes.data() + self.chunk.bytes.size();
+	if (recorder_codec_decode(self.codec, p, end, self.samples) == false) {
+		mu::log_error("replay: '{}' is truncated at tick {}", self.path, self.chunk.first_tick + self.chunk_tick);
+		self.finished = true;
+		return false;
+	}
+	self.offset = p - self.chunk.bytes.data();
+	self.tick = self.chunk.first_tick + self.chunk_tick;
+	self.next_tick = self.tick + 1;
+	self.chunk_tick++;
+	return true;
+}
+
+inline void replay_close(Replay& self) {
+	if (self.file) {
+		fclose(self.file);
+		self.file = nullptr;
+	}
+}
+
+// parses `--record <path>` and `--replay <path>`, returns false and logs on invalid arguments
+inline bool recorder_parse_args(Recorder& recorder, Replay& replay, int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		const auto arg = mu::StrView(argv[i]);
+		const bool has_value = i+1 < argc;
+
+		if (arg == "--record" && has_value) {
+			recorder.path = argv[++i];
+		} else if (arg == "--replay" && has_value) {
+			replay.path = argv[++i];
+		}
+	}
+
+	if (recorder.path.empty() == false && recorder.path == replay.path) {
+		mu::log_error("can't record into '{}' while replaying it", recorder.path);
+		return false;
+	}
+
+	return true;
+}
+
+inline void test_recorder() {
+	mu_test_suite("test_recorder");
+
+	// quantization
+	{
+		RecorderState state {
+			.translation = {1234.5678f, -250.25f, -0.0004f},
+			.orientation = glm::normalize(glm::quat{0.9f, 0.1f, -0.3f, 0.2f}),
+			.velocity = {120.5f, -3.25f, 0},
+			.throttle = 0.8f,
+			.elevator = -0.25f,
+			.engine_speed = 0.75f,
+			.landing_gear_alpha = 1,
+			.fuel = 2.5f,
+			.braking = true,
+			.engine_cutoff = true,
+		};
+		const auto back = recorder_state_from_sample(recorder_sample_from_state(state));
+		mu_test(glm::length(back.translation - state.translation) < 1e-3f);
+		mu_test(std::abs(glm::dot(back.orientation, state.orientation)) > 1 - 1e-6f);
+		mu_test(glm::length(back.velocity - state.velocity) < 1e-3f);
+		mu_test(back.throttle == 0.8f && back.elevator == -0.25f && back.engine_speed == 0.75f && back.fuel == 2.5f);
+		mu_test(back.braking && back.burner_enabled == false && back.engine_cutoff && back.visible == false);
+	}
+
+	// coding gives back the same samples, and steady flight takes few bytes
+	{
+		constexpr int TICKS = 240;
+		mu::Vec<mu::Vec<RecorderSample>> ticks;
+		for (int t = 0; t < TICKS; t++) {
+			RecorderState a {.translation = {t * 0.8f, -500, t * -0.1f}, .velocity = {96, 0, -12}, .throttle = 0.7f, .visible = true};
+			RecorderState b {.translation = {-3e5f, -1, 3e5f}, .elevator = t < 100? 0.0f : 0.5f, .fuel = 3 - t * 1e-5f};
+			ticks.push_back({recorder_sample_from_state(a), recorder_sample_from_state(b)});
+		}
+
+		RecorderCodec encoder {};
+		recorder_codec_reset(encoder, 2);
+		mu::Vec<uint8_t> bytes;
+		for (const auto& samples : ticks) {
+			recorder_codec_encode(encoder, samples, bytes);
+		}
+		mu_test(bytes.size() < TICKS * 2 * RECORDER_FIELDS_COUNT * 1.2);
+
+		RecorderCodec decoder {};
+		recorder_codec_reset(decoder, 2);
+		const uint8_t* p = bytes.data();
+		mu::Vec<RecorderSample> samples(2, RecorderSample {});
+		bool same = true;
+		for (const auto& expected : ticks) {
+			same &= recorder_codec_decode(decoder, p, bytes.data() + bytes.size(), samples);
+			same &= memcmp(samples.data(), expected.data(), sizeof(RecorderSample) * 2) == 0;
+		}
+		mu_test(same);
+		mu_test(p == bytes.data() + bytes.size());
+		mu_test(recorder_codec_decode(decoder, p, bytes.data() + bytes.size(), samples) == false);
+	}
+
+	// dropped ticks hold last state, chunks bigger than recorder writes end replay
+	{
+		const auto path = (std::filesystem::temp_directory_path() / "open-ysf-test-replay").string();
+		FILE* f = fopen(path.c_str(), "wb");
+		fwrite(RECORDER_MAGIC, 1, sizeof(RECORDER_MAGIC), f);
+		fwrite(&RECORDER_VERSION, sizeof(RECORDER_VERSION), 1, f);
+		_recorder_write_str(f, "SMALL_MAP");
+		const uint32_t count = 1;
+		fwrite(&count, sizeof(count), 1, f);
+		_recorder_write_str(f, "F-16");
+
+		const auto write_chunk = [&](uint64_t first_tick, mu::Vec<float> xs, uint32_t size_override = 0) {
+			RecorderCodec encoder {};
+			recorder_codec_reset(encoder, 1);
+			mu::Vec<uint8_t> bytes;
+			for (float x : xs) {
+				recorder_codec_encode(encoder, {recorder_sample_from_state(RecorderState {.translation = {x, 0, 0}})}, bytes);
+			}
+			const uint32_t ticks = xs.size();
+			const uint32_t size = size_override? size_override : uint32_t(bytes.size());
+			fwrite(&first_tick, sizeof(first_tick), 1, f);
+			fwrite(&ticks, sizeof(ticks), 1, f);
+			fwrite(&size, sizeof(size), 1, f);
+			fwrite(bytes.data(), 1, bytes.size(), f);
+		};
+		write_chunk(0, {1, 2});
+		write_chunk(5, {6});
+		write_chunk(6, {7}, 0xffffffff);
+		fclose(f);
+
+		Replay replay {.path = mu::Str(path)};
+		mu_test(replay_open(replay));
+		mu::Vec<uint64_t> ticks;
+		mu::Vec<float> xs;
+		while (replay_next(replay)) {
+			ticks.push_back(replay.tick);
+			xs.push_back(recorder_state_from_sample(replay.samples[0]).translation.x);
+		}
+		replay_close(replay);
+		std::filesystem::remove(path);
+
+		mu_test(ticks == mu::Vec<uint64_t>({0, 1, 2, 3, 4, 5}));
+		mu_test(xs == mu::Vec<float>({1, 2, 2, 2, 2, 6}));
+		mu_test(replay.finished);
+	}
+}
@@ -6,58 +6,138 @@ namespace sys {
 		DEF_SYSTEM
 
 		if (!world.settings.handle_collision) {
+			// nothing tested meanwhile, don't sweep over it once enabled again
+			for (auto& a : world.aircrafts) {
+				a.has_swept_from = false;
+			}
 			return;
 		}
 
 		// adhoc entity query
+		// body is where entity is now, it moved by displacement since last test and swept covers all the way
 		struct Entity {
 			AABB* aabb;
+			AABB swept;
+			glm::vec3 displacement;
 			const char* name;
 			bool render_aabb, visible, is_aircraft, collided;
+			CollisionBody body;
 		};
-		mu::Vec<Entity> e(mu::memory::tmp());
+		mu::Vec<Entity> e(&world.sim_thread.arena);
 		for (auto& a : world.aircrafts) {
+			const auto displacement = a.has_swept_from? a.translation - a.swept_from : glm::vec3{0};
 			e.push_back(Entity {
 				.aabb = &a.current_aabb,
+				.swept = aabb_swept(a.current_aabb, displacement),
+				.displacement = displacement,
 				.name = a.aircraft_template.short_name.c_str(),
 				.render_aabb = a.render_aabb,
 				.visible = a.visible,
 				.is_aircraft = true,
 				.collided = false,
+				.body = CollisionBody {
+					.mesh = &a.collision,
+					.initial_aabb = a.initial_aabb,
+					.transformation = a.kinematics.model_transformation,
+				},
 			});
 		}
 		for (auto& g : world.ground_objs) {
+			// slow enough to be tested where they are
 			e.push_back(Entity {
 				.aabb = &g.current_aabb,
+				.swept = g.current_aabb,
+				.displacement = {0, 0, 0},
 				.name = g.ground_obj_template.short_name.c_str(),
 				.render_aabb = g.render_aabb,
 				.visible = g.visible,
 				.is_aircraft = false,
 				.collided = false,
+				.body = CollisionBody {
+					.mesh = &g.collision,
+					.initial_aabb = g.initial_aabb,
+					.transformation = local_euler_angles_matrix(g.angles, g.translation),
+				},
 			});
 		}
 
-		// test collision
-		for (uint32_t i = 0; e.size() > 1 && i < e.size()-1 && e[i].is_aircraft; i++) {
-			if (e[i].visible == false) {
+		// sync proxies, entities are copied, erased and cleared without telling the broadphase
+		// so each proxy goes to first entity holding its handle, others get new ones and unclaimed proxies are removed
+		auto& broadphase = world.broadphase;
+		mu::Vec<uint8_t> claimed(&world.sim_thread.arena);
+		claimed.resize(broadphase.proxies.size());
+		auto sync = [&](uint32_t& handle, uint32_t entity, bool is_static) {
+			const bool owned = handle < claimed.size() && claimed[handle] == 0
+				&& broadphase.proxies[handle].alive && broadphase.proxies[handle].is_static == is_static;
+			if (owned) {
+				broadphase_move(broadphase, handle, e[entity].swept, entity);
+			} else {
+				handle = broadphase_add(broadphase, e[entity].swept, entity, is_static);
+				if (handle >= claimed.size()) {
+					claimed.resize(handle+1);
+				}
+			}
+			claimed[handle] = 1;
+		};
+		for (uint32_t i = 0; i < world.aircrafts.size(); i++) {
+			sync(world.aircrafts[i].broadphase_proxy, i, false);
+		}
+		for (uint32_t i = 0; i < world.ground_objs.size(); i++) {
+			sync(world.ground_objs[i].broadphase_proxy, world.aircrafts.size() + i, world.ground_objs[i].speed == 0);
+		}
+		for (uint32_t handle = 0; handle < claimed.size(); handle++) {
+			if (claimed[handle] == 0 && broadphase.proxies[handle].alive) {
+				broadphase_remove(broadphase, handle);
+			}
+		}
+
+		// test collision, only aircrafts collide (with anything)
+		// broadphase pairs have intersecting swept AABBs, narrowphase keeps ones whose OBBs then collision meshes
+		// touch somewhere on the way, each moved from where it was at last test to where it is now
+		broadphase_update(broadphase);
+		for (auto [i, j] : broadphase.pairs) {
+			if (e[i].visible == false || e[j].visible == false || (e[i].is_aircraft || e[j].is_aircraft) == false) {
 				continue;
 			}
 
-			for (uint32_t j = i+1; j < e.size(); j++) {
-				if (e[j].visible && aabbs_intersect(*e[i].aabb, *e[j].aabb)) {
-					e[i].collided = true;
-					e[j].collided = true;
-					TEXT_OVERLAY("{}[air] collided with {}[{}]", e[i].name, e[j].name, e[j].is_aircraft ? "air":"gro");
-				}
+			auto from_i = e[i].body;
+			auto from_j = e[j].body;
+			from_i.transformation = glm::translate(glm::mat4{1.0f}, -e[i].displacement) * from_i.transformation;
+			from_j.transformation = glm::translate(glm::mat4{1.0f}, -e[j].displacement) * from_j.transformation;
+			float t;
+			if (collision_bodies_time_of_impact(from_i, e[i].displacement - e[j].displacement, from_j, t) == false) {
+				continue;
+			}
+			if (e[i].is_aircraft == false) {
+				std::swap(i, j);
+			}
+
+			e[i].collided = true;
+			e[j].collided = true;
+			TEXT_OVERLAY("{}[air] collided with {}[{}] at {:.2f} of its way", e[i].name, e[j].name, e[j].is_aircraft ? "air":"gro", t);
+		}
+
+		// physics keeps aircrafts 1m above ground under them, way they went gets under it only if they flew into it
+		for (uint32_t i = 0; i < world.aircrafts.size(); i++) {
+			const auto& aircraft = world.aircrafts[i];
+			float t;
+			if (aircraft.visible && aircraft.has_swept_from
+				&& terrain_time_of_impact(world.scenery.terrain, aircraft.swept_from, aircraft.translation, t)) {
+				e[i].collided = true;
+				TEXT_OVERLAY("{}[air] collided with terrain at {:.2f} of its way", e[i].name, t);
 			}
 		}
+		for (auto& a : world.aircrafts) {
+			a.swept_from = a.translation;
+			a.has_swept_from = true;
+		}
 
 		// render boxes as lines (12 edges per aabb)
 		constexpr glm::vec3 RED {1,0,0};
 		constexpr glm::vec3 BLU {0,0,1};
 		for (int i = 0; i < e.size(); i++) {
 			if (e[i].visible && e[i].render_aabb) {
-				canvas_add(world.canvas, canvas::Box {
+				canvas_add(canvas_frame_recording(world.canvas).cmd_lists[CANVAS_LANE_COLLISION][0], canvas::Box {
 					.translation = e[i].aabb->min,
 					.scale = e[i].aabb->max - e[i].aabb->min,
 					.color = e[i].collided ? RED : BLU,
@@ -76,40 +156,35 @@ namespace sys {
 	void scenery_free(World& world) {
 		DEF_SYSTEM
 
-		field_unload_from_gpu(world.scenery.root_fld);
+		scenery_unload(world.scenery);
 	}
 
 	void scenery_update(World& world) {
 		DEF_SYSTEM
 
 		auto& self = world.scenery;
-		const auto all_fields = field_list_recursively(self.root_fld, mu::memory::tmp());
 
 		if (self.should_be_loaded) {
+			textures_clear(world.textures);
 			scenery_unload(self);
 			scenery_load(self);
+			scenery_textures_request(self, world.textures, world.jobs);
 			signal_fire(world.signals.scenery_loaded);
 		}
 
 		if (self.root_fld.should_be_transformed) {
 			self.root_fld.should_be_transformed = false;
 
-			// transform fields
-			self.root_fld.transformation = glm::identity<glm::mat4>();
+			// listed after loading, loading replaces all fields
+			const auto all_fields = field_list_recursively(self.root_fld, mu::memory::tmp());
+
+			scenery_fields_transform(self, all_fields);
+
 			for (Field* fld : all_fields) {
 				if (fld->visible == false) {
 					continue;
 				}
 
-				fld->transformation = glm::translate(fld->transformation, fld->translation);
-				fld->transformation = glm::rotate(fld->transformation, fld->rotation[2], glm::vec3{0, 0, 1});
-				fld->transformation = glm::rotate(fld->transformation, fld->rotation[1], glm::vec3{1, 0, 0});
-				fld->transformation = glm::rotate(fld->transformation, fld->rotation[0], glm::vec3{0, 1, 0});
-
-				for (auto& subfield : fld->subfields) {
-					subfield.transformation = fld->transformation;
-				}
-
 				meshes_foreach(fld->meshes, [&](Mesh& mesh) {
 					if (mesh.render_cnt_axis) {
 						canvas_add(world.canvas, canvas::Axis { glm::translate(glm::identity<glm::mat4>(), mesh.cnt) });
@@ -144,148 +219,67 @@ namespace sys {
 					}
 				}
 			}
+
+			self.should_rebuild_render_cache = true;
+		}
+
+		if (self.should_rebuild_render_cache) {
+			scenery_terrain_rebuild(self);
+			// after ground objects are loaded, in ground_objs_update
+			self.should_rebuild_raycast = true;
+		}
+
+		if (self.should_rebuild_render_cache || self.render_cache_textures_generation != world.textures.generation) {
+			scenery_render_cache_rebuild(self, world.textures);
+			world.canvas.frame_drawing_stale = true;
 		}
 	}
 
 	void scenery_prepare_render(World& world) {
 		DEF_SYSTEM
 
-		const auto all_fields = field_list_recursively(world.scenery.root_fld, mu::memory::tmp());
+		auto& lane = canvas_frame_recording(world.canvas).cmd_lists[CANVAS_LANE_SCENERY];
+		const auto& cache = world.scenery.render_cache;
+		const auto& projection_view = world.mats.projection_view;
 
-		for (const Field* fld : all_fields) {
-			if (fld->visible == false) {
-				continue;
-			}
+		if (cache.has_ground) {
+			canvas_add(lane[0], canvas::Ground(cache.ground));
+		}
 
-			// ground
-			canvas_add(world.canvas, canvas::Ground {
-				.color = fld->ground_color,
+		for (const auto& batch : cache.batches) {
+			canvas_add(lane[0], canvas::MeshBatch {
+				.vao = batch.gl_buf.vao,
+				.firsts = batch.firsts,
+				.counts = batch.counts,
+				.projection_view = projection_view,
+				.texture_id = batch.texture_id,
+				.tex_enabled = batch.tex_enabled,
 			});
+		}
 
-			// pictures
-			for (const auto& picture : fld->pictures) {
-				if (picture.visible == false) {
-					continue;
-				}
-
-				auto model_transformation = fld->transformation;
-				model_transformation = glm::translate(model_transformation, picture.translation);
-				model_transformation = glm::rotate(model_transformation, picture.rotation[2], glm::vec3{0, 0, 1});
-				model_transformation = glm::rotate(model_transformation, picture.rotation[1], glm::vec3{1, 0, 0});
-				model_transformation = glm::rotate(model_transformation, picture.rotation[0], glm::vec3{0, 1, 0});
-
-				auto gnd_pic = canvas::GndPic {
-					.projection_view_model = world.mats.projection_view * model_transformation,
-					.list_primitives = mu::Vec<canvas::GndPic::Primitive>(&world.canvas.arena),
-				};
-
-				for (const auto& primitive : picture.primitives) {
-					GLenum gl_primitive_type;
-					switch (primitive.kind) {
-					case Primitive2D::Kind::POINTS:
-						gl_primitive_type = GL_POINTS;
-						break;
-					case Primitive2D::Kind::LINES:
-						gl_primitive_type = GL_LINES;
-						break;
-					case Primitive2D::Kind::LINE_SEGMENTS:
-						gl_primitive_type = GL_LINE_STRIP;
-						break;
-					case Primitive2D::Kind::TRIANGLES:
-					case Primitive2D::Kind::QUAD_STRIPS:
-					case Primitive2D::Kind::QUADRILATERAL:
-					case Primitive2D::Kind::POLYGON:
-					case Primitive2D::Kind::GRADATION_QUAD_STRIPS:
-						gl_primitive_type = GL_TRIANGLES;
-						break;
-					default: mu_unreachable();
-					}
-
-					canvas::GndPic::Primitive cp {
-						.vao = primitive.gl_buf.vao,
-						.buf_len = primitive.gl_buf.len,
-						.gl_primitive_type = gl_primitive_type,
-
-						.color = primitive.color,
-						.gradient_enabled = primitive.kind == Primitive2D::Kind::GRADATION_QUAD_STRIPS,
-						.gradient_color2 = primitive.gradient_color2,
-					};
-
-					if (primitive.tex_name.size() > 0 && fld->textures.contains(primitive.tex_name)) {
-						cp.tex_enabled = true;
-						cp.texture_id = fld->textures.at(primitive.tex_name);
-					}
-
-					gnd_pic.list_primitives.push_back(std::move(cp));
-				}
-
-				canvas_add(world.canvas, std::move(gnd_pic));
-			}
+		workers_run(world.workers, [&](size_t slot) {
+			auto& cmds = lane[slot];
 
-			// terrains
-			for (const auto& terr_mesh : fld->terr_meshes) {
-				if (terr_mesh.visible == false) {
-					continue;
-				}
-
-				auto model_transformation = fld->transformation;
-				model_transformation = glm::translate(model_transformation, terr_mesh.translation);
-				model_transformation = glm::rotate(model_transformation, terr_mesh.rotation[2], glm::vec3{0, 0, 1});
-				model_transformation = glm::rotate(model_transformation, terr_mesh.rotation[1], glm::vec3{1, 0, 0});
-				model_transformation = glm::rotate(model_transformation, terr_mesh.rotation[0], glm::vec3{0, 1, 0});
-
-				if (terr_mesh.gradient.enabled) {
-					canvas_add(world.canvas, canvas::GradientMesh {
-						.vao = terr_mesh.gl_buf.vao,
-						.buf_len = terr_mesh.gl_buf.len,
-						.projection_view_model = world.mats.projection_view * model_transformation,
-						.model_normal = glm::transpose(glm::inverse(glm::mat3(model_transformation))),
-
-						.gradient_bottom_y = terr_mesh.gradient.bottom_y,
-						.gradient_top_y = terr_mesh.gradient.top_y,
-						.gradient_bottom_color = terr_mesh.gradient.bottom_color,
-						.gradient_top_color = terr_mesh.gradient.top_color,
+			{
+				const auto [begin, end] = workers_slot_range(world.workers, slot, cache.gnd_pics.size());
+				for (size_t i = begin; i < end; i++) {
+					const auto& gnd_pic = cache.gnd_pics[i];
+					canvas_add(cmds, canvas::GndPic {
+						.projection_view_model = projection_view * gnd_pic.model,
+						.list_primitives = gnd_pic.primitives,
 					});
-				} else {
-					auto mesh = canvas::Mesh {
-						.vao = terr_mesh.gl_buf.vao,
-						.buf_len = terr_mesh.gl_buf.len,
-						.projection_view_model = world.mats.projection_view * model_transformation,
-						.model_normal = glm::transpose(glm::inverse(glm::mat3(model_transformation)))
-					};
-
-					if (!terr_mesh.tex_name.empty()) {
-						auto it = fld->textures.find(terr_mesh.tex_name);
-						if (it != fld->textures.end()) {
-							mesh.texture_id = it->second;
-							mesh.tex_enabled = true;
-						}
-					}
-
-					canvas_add(world.canvas, std::move(mesh));
 				}
 			}
 
-			// meshes
-			meshes_foreach(fld->meshes, [&](const Mesh& mesh) {
-				if (mesh.visible == false) {
-					return false;
+			{
+				const auto [begin, end] = workers_slot_range(world.workers, slot, cache.gradient_meshes.size());
+				for (size_t i = begin; i < end; i++) {
+					auto mesh = cache.gradient_meshes[i].mesh;
+					mesh.projection_view_model = projection_view * cache.gradient_meshes[i].model;
+					canvas_add(cmds, std::move(mesh));
 				}
-
-				canvas_add(world.canvas, canvas::Mesh {
-					.vao = mesh.gl_buf.vao,
-					.buf_len = mesh.gl_buf.len,
-					.projection_view_model =
-						world.mats.projection_view
-						* mesh.transformation
-						* fld->transformation,
-					.model_normal = glm::transpose(glm::inverse(
-						glm::mat3(mesh.transformation * fld->transformation)))
-				});
-
-				return true;
-			});
-		}
+			}
+		});
 	}
 
 } // namespace sys
@@ -1,6 +1,63 @@
 #pragma once
 
+#include <span>
+#include <chrono>
+
+#include <glm/gtc/matrix_transform.hpp>
+
 #include "assets.h"
+#include "canvas.h"
+#include "terrain.h"
+#include "raycast.h"
+#include "ground_obj.h"
+
+// what scenery submits to canvas each frame, scenery is static so this is only rebuilt
+// on load or transformation change, and each frame only multiplies by projection_view
+// records are in the order fields are visited, same order they were submitted before caching
+struct SceneryRenderCache {
+	struct GndPic {
+		glm::mat4 model;
+		mu::Vec<canvas::GndPic::Primitive> primitives;
+	};
+
+	// non gradient terrains and field meshes baked in world space, one buffer per texture array
+	// each baked mesh is one range, so the whole batch is a single multi draw
+	struct Batch {
+		GLBuf gl_buf;
+		GLuint texture_id; // GL_TEXTURE_2D_ARRAY
+		bool tex_enabled;
+
+		mu::Vec<GLint> firsts;
+		mu::Vec<GLsizei> counts;
+	};
+
+	struct GradientMesh {
+		glm::mat4 model;
+		canvas::GradientMesh mesh;
+	};
+
+	bool has_ground;
+	canvas::Ground ground;
+
+	mu::Vec<GndPic> gnd_pics;
+	mu::Vec<Batch> batches;
+	mu::Vec<GradientMesh> gradient_meshes;
+};
+
+// TerrMeshVertex with layer of texture array in uv.z
+struct SceneryBatchVertex {
+	glm::vec3 vertex;
+	glm::vec4 color;
+	glm::vec3 normal;
+	glm::vec3 uv;
+};
+
+inline void scenery_render_cache_free(SceneryRenderCache& self) {
+	for (auto& batch : self.batches) {
+		gl_buf_free(batch.gl_buf);
+	}
+	self = {};
+}
 
 struct Scenery {
 	SceneryTemplate scenery_template;
@@ -8,6 +65,20 @@ struct Scenery {
 	mu::Vec<StartInfo> start_infos;
 
 	bool should_be_loaded;
+
+	// ground height for physics, rebuilt with render cache
+	Terrain terrain;
+
+	// triangles of fields, terrains and ground objects that don't move, for raycasts (picking, line of sight)
+	// rebuilt with render cache or when ground objects are loaded/removed, after they are
+	RaycastBVH raycast;
+	bool should_rebuild_raycast;
+
+	SceneryRenderCache render_cache;
+	// set whenever anything the cache reads changes (visibility, transformation, colors)
+	bool should_rebuild_render_cache;
+	// Textures::generation the cache was built with, textures that got ready since are drawn untextured till rebuild
+	uint64_t render_cache_textures_generation;
 };
 
 inline Scenery scenery_new(SceneryTemplate& scenery_template) {
@@ -23,8 +94,326 @@ inline void scenery_load(Scenery& self) {
 
 	self.start_infos = start_info_from_stp_file(self.scenery_template.stp);
 	self.should_be_loaded = false;
+	self.should_rebuild_render_cache = true;
+}
+
+// moves textures parsed from fld files to Textures, they are decoded and uploaded asynchronously
+inline void scenery_textures_request(Scenery& self, Textures& textures, JobQueue& jobs) {
+	for (Field* fld : field_list_recursively(self.root_fld, mu::memory::tmp())) {
+		for (auto& ptex : fld->pending_textures) {
+			fld->textures[ptex.name] = textures_request(textures, jobs, ptex.name, std::move(ptex.png_data), ptex.filter_min, ptex.filter_mag);
+		}
+		fld->pending_textures.clear();
+	}
+}
+
+// array and layer of field texture `tex_name`, false if it's not ready or not found
+inline bool _scenery_texture_find(const Field& fld, const Textures& textures, const mu::Str& tex_name, TextureRef& ref) {
+	if (tex_name.empty()) {
+		return false;
+	}
+	auto it = fld.textures.find(tex_name);
+	if (it == fld.textures.end()) {
+		return false;
+	}
+	ref = textures_ref(textures, it->second);
+	return ref.array != 0;
+}
+
+// fld->transformation of visible fields from their translation/rotation, `all_fields` lists parents before subfields
+inline void scenery_fields_transform(Scenery& self, std::span<Field* const> all_fields) {
+	self.root_fld.transformation = glm::identity<glm::mat4>();
+	for (Field* fld : all_fields) {
+		if (fld->visible == false) {
+			continue;
+		}
+
+		fld->transformation = glm::translate(fld->transformation, fld->translation);
+		fld->transformation = glm::rotate(fld->transformation, fld->rotation[2], glm::vec3{0, 0, 1});
+		fld->transformation = glm::rotate(fld->transformation, fld->rotation[1], glm::vec3{1, 0, 0});
+		fld->transformation = glm::rotate(fld->transformation, fld->rotation[0], glm::vec3{0, 1, 0});
+
+		for (auto& subfield : fld->subfields) {
+			subfield.transformation = fld->transformation;
+		}
+	}
 }
 
 inline void scenery_unload(Scenery& self) {
+	scenery_render_cache_free(self.render_cache);
 	field_unload_from_gpu(self.root_fld);
 }
+
+inline glm::mat4 _scenery_model_transformation(const glm::mat4& fld_transformation, const glm::vec3& translation, const glm::vec3& rotation) {
+	auto model_transformation = fld_transformation;
+	model_transformation = glm::translate(model_transformation, translation);
+	model_transformation = glm::rotate(model_transformation, rotation[2], glm::vec3{0, 0, 1});
+	model_transformation = glm::rotate(model_transformation, rotation[1], glm::vec3{1, 0, 0});
+	model_transformation = glm::rotate(model_transformation, rotation[0], glm::vec3{0, 1, 0});
+	return model_transformation;
+}
+
+// appends `vertices` transformed by `model` as a new range of the batch that has `texture.array`
+inline void _scenery_render_cache_bake(SceneryRenderCache& cache, mu::Vec<mu::Vec<SceneryBatchVertex>>& batches_vertices,
+	TextureRef texture, bool tex_enabled, const glm::mat4& model, std::span<const TerrMeshVertex> vertices) {
+	if (vertices.empty()) {
+		return;
+	}
+
+	const GLuint texture_id = texture.array;
+
+	size_t batch_index = 0;
+	while (batch_index < cache.batches.size()
+		&& (cache.batches[batch_index].texture_id != texture_id || cache.batches[batch_index].tex_enabled != tex_enabled)) {
+		batch_index++;
+	}
+	if (batch_index == cache.batches.size()) {
+		cache.batches.push_back(SceneryRenderCache::Batch {
+			.texture_id = texture_id,
+			.tex_enabled = tex_enabled,
+		});
+		batches_vertices.push_back(mu::Vec<SceneryBatchVertex>(mu::memory::tmp()));
+	}
+
+	auto& batch = cache.batches[batch_index];
+	auto& batch_vertices = batches_vertices[batch_index];
+
+	batch.firsts.push_back(batch_vertices.size());
+	batch.counts.push_back(vertices.size());
+
+	const auto model_normal = glm::transpose(glm::inverse(glm::mat3(model)));
+	for (const auto& v : vertices) {
+		auto normal = model_normal * v.normal;
+		if (glm::length(normal) > 0.0001f) {
+			normal = glm::normalize(normal);
+		}
+		batch_vertices.push_back(SceneryBatchVertex {
+			.vertex = glm::vec3(model * glm::vec4(v.vertex, 1)),
+			.color = v.color,
+			.normal = normal,
+			.uv = glm::vec3(v.uv, texture.layer),
+		});
+	}
+}
+
+// visible terrains of visible fields, after fields are transformed
+inline void scenery_terrain_rebuild(Scenery& self) {
+	terrain_clear(self.terrain);
+	for (const Field* fld : field_list_recursively(self.root_fld, mu::memory::tmp())) {
+		if (fld->visible == false) {
+			continue;
+		}
+		for (const auto& terr_mesh : fld->terr_meshes) {
+			if (terr_mesh.visible) {
+				terrain_patch_add(self.terrain, terr_mesh, _scenery_model_transformation(fld->transformation, terr_mesh.translation, terr_mesh.rotation));
+			}
+		}
+	}
+	terrain_grid_build(self.terrain);
+}
+
+// triangles of what's drawn, at where it's drawn, ground objects' mesh transformations should be updated
+inline void scenery_raycast_rebuild(Scenery& self, std::span<const GroundObj> ground_objs, mu::StrView cache_dir) {
+	raycast_bvh_clear(self.raycast);
+
+	auto add_mesh = [&self](const Mesh& mesh, const glm::mat4& transformation, RaycastSource source) {
+		for (const auto& face : mesh.faces) {
+			if (face.vertices_ids.size() < 3) {
+				continue;
+			}
+			const auto vertex = [&](size_t i) {
+				return glm::vec3(transformation * glm::vec4(mesh.vertices[face.vertices_ids[i]], 1.0f));
+			};
+			for (size_t i = 2; i < face.vertices_ids.size(); i++) {
+				raycast_bvh_add(self.raycast, vertex(0), vertex(i-1), vertex(i), source);
+			}
+		}
+	};
+
+	for (const Field* fld : field_list_recursively(self.root_fld, mu::memory::tmp())) {
+		if (fld->visible == false) {
+			continue;
+		}
+
+		for (const auto& terr_mesh : fld->terr_meshes) {
+			if (terr_mesh.visible == false) {
+				continue;
+			}
+			const auto model_transformation = _scenery_model_transformation(fld->transformation, terr_mesh.translation, terr_mesh.rotation);
+			const auto vertices = terr_mesh_vertices(terr_mesh);
+			for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+				raycast_bvh_add(self.raycast,
+					glm::vec3(model_transformation * glm::vec4(vertices[i].vertex, 1.0f)),
+					glm::vec3(model_transformation * glm::vec4(vertices[i+1].vertex, 1.0f)),
+					glm::vec3(model_transformation * glm::vec4(vertices[i+2].vertex, 1.0f)),
+					RaycastSource::TERRAIN
+				);
+			}
+		}
+
+		meshes_foreach(fld->meshes, [&](const Mesh& mesh) {
+			if (mesh.visible == false) {
+				return false;
+			}
+			add_mesh(mesh, mesh.transformation * fld->transformation, RaycastSource::FIELD_MESH);
+			return true;
+		});
+	}
+
+	for (const auto& gro : ground_objs) {
+		if (gro.visible == false || gro.speed != 0) {
+			continue;
+		}
+		meshes_foreach(gro.model.meshes, [&](const Mesh& mesh) {
+			if (mesh.visible == false) {
+				return false;
+			}
+			add_mesh(mesh, mesh.transformation, RaycastSource::GROUND_OBJ);
+			return true;
+		});
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const bool cached = raycast_bvh_build(self.raycast, cache_dir);
+	mu::log_debug("{} scenery bvh of {} triangles in {:.1f}ms", cached? "loaded" : "built", self.raycast.triangles.size(),
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+	self.should_rebuild_raycast = false;
+}
+
+inline void scenery_render_cache_rebuild(Scenery& self, const Textures& textures) {
+	auto& cache = self.render_cache;
+	scenery_render_cache_free(cache);
+
+	auto batches_vertices = mu::Vec<mu::Vec<SceneryBatchVertex>>(mu::memory::tmp());
+	size_t num_baked = 0;
+
+	const auto all_fields = field_list_recursively(self.root_fld, mu::memory::tmp());
+	for (const Field* fld : all_fields) {
+		if (fld->visible == false) {
+			continue;
+		}
+
+		// ground, last visible field wins
+		cache.has_ground = true;
+		cache.ground = canvas::Ground {
+			.color = fld->ground_color,
+		};
+
+		// pictures
+		for (const auto& picture : fld->pictures) {
+			if (picture.visible == false) {
+				continue;
+			}
+
+			auto gnd_pic = SceneryRenderCache::GndPic {
+				.model = _scenery_model_transformation(fld->transformation, picture.translation, picture.rotation),
+			};
+
+			for (const auto& primitive : picture.primitives) {
+				GLenum gl_primitive_type;
+				switch (primitive.kind) {
+				case Primitive2D::Kind::POINTS:
+					gl_primitive_type = GL_POINTS;
+					break;
+				case Primitive2D::Kind::LINES:
+					gl_primitive_type = GL_LINES;
+					break;
+				case Primitive2D::Kind::LINE_SEGMENTS:
+					gl_primitive_type = GL_LINE_STRIP;
+					break;
+				case Primitive2D::Kind::TRIANGLES:
+				case Primitive2D::Kind::QUAD_STRIPS:
+				case Primitive2D::Kind::QUADRILATERAL:
+				case Primitive2D::Kind::POLYGON:
+				case Primitive2D::Kind::GRADATION_QUAD_STRIPS:
+					gl_primitive_type = GL_TRIANGLES;
+					break;
+				default: mu_unreachable();
+				}
+
+				canvas::GndPic::Primitive cp {
+					.vao = primitive.gl_buf.vao,
+					.buf_len = primitive.gl_buf.len,
+					.gl_primitive_type = gl_primitive_type,
+
+					.color = primitive.color,
+					.gradient_enabled = primitive.kind == Primitive2D::Kind::GRADATION_QUAD_STRIPS,
+					.gradient_color2 = primitive.gradient_color2,
+				};
+
+				TextureRef texture {};
+				if (_scenery_texture_find(*fld, textures, primitive.tex_name, texture)) {
+					cp.tex_enabled = true;
+					cp.texture_id = texture.array;
+					cp.texture_layer = texture.layer;
+				}
+
+				gnd_pic.primitives.push_back(std::move(cp));
+			}
+
+			cache.gnd_pics.push_back(std::move(gnd_pic));
+		}
+
+		// terrains
+		for (const auto& terr_mesh : fld->terr_meshes) {
+			if (terr_mesh.visible == false) {
+				continue;
+			}
+
+			const auto model_transformation = _scenery_model_transformation(fld->transformation, terr_mesh.translation, terr_mesh.rotation);
+
+			// gradient is computed from terrain space y, so it can't be baked
+			if (terr_mesh.gradient.enabled) {
+				cache.gradient_meshes.push_back(SceneryRenderCache::GradientMesh {
+					.model = model_transformation,
+					.mesh = canvas::GradientMesh {
+						.vao = terr_mesh.gl_buf.vao,
+						.buf_len = terr_mesh.gl_buf.len,
+						.model_normal = glm::transpose(glm::inverse(glm::mat3(model_transformation))),
+
+						.gradient_bottom_y = terr_mesh.gradient.bottom_y,
+						.gradient_top_y = terr_mesh.gradient.top_y,
+						.gradient_bottom_color = terr_mesh.gradient.bottom_color,
+						.gradient_top_color = terr_mesh.gradient.top_color,
+					},
+				});
+			} else {
+				TextureRef texture {};
+				const bool tex_enabled = _scenery_texture_find(*fld, textures, terr_mesh.tex_name, texture);
+
+				_scenery_render_cache_bake(cache, batches_vertices, texture, tex_enabled, model_transformation, terr_mesh_vertices(terr_mesh));
+				num_baked++;
+			}
+		}
+
+		// meshes
+		meshes_foreach(fld->meshes, [&](const Mesh& mesh) {
+			if (mesh.visible == false) {
+				return false;
+			}
+
+			auto vertices = mu::Vec<TerrMeshVertex>(mu::memory::tmp());
+			for (const auto& v : mesh_vertices(mesh)) {
+				vertices.push_back(TerrMeshVertex {
+					.vertex = v.vertex,
+					.color = v.color,
+					.normal = v.normal,
+				});
+			}
+
+			_scenery_render_cache_bake(cache, batches_vertices, {}, false, mesh.transformation * fld->transformation, vertices);
+			num_baked++;
+
+			return true;
+		});
+	}
+
+	for (size_t i = 0; i < cache.batches.size(); i++) {
+		cache.batches[i].gl_buf = gl_buf_new<glm::vec3, glm::vec4, glm::vec3, glm::vec3>(batches_vertices[i]);
+	}
+	mu::log_debug("baked {} scenery meshes into {} batches", num_baked, cache.batches.size());
+
+	self.should_rebuild_render_cache = false;
+	self.render_cache_textures_generation = textures.generation;
+}
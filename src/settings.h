@@ -11,9 +11,12 @@ struct Settings {
 	bool fullscreen = false;
 	bool should_limit_fps = true;
 	int fps_limit = 60;
+	bool vsync = false;
 	bool custom_aspect_ratio = false;
 	float current_angle_max = DEGREES_MAX;
 	bool handle_collision = true;
+	// scenery BVHs for raycasts are cached here keyed by their triangles, empty to build them on every load
+	mu::Str bvh_cache_dir;
 	float brake_coeff = 1.0f;
 
 	struct {
@@ -24,6 +27,9 @@ struct Settings {
 		GLenum primitives_type = GL_TRIANGLES;
 		GLenum polygon_mode    = GL_FILL;
 
+		// one program per shader that branches on uniforms, instead of a compiled variant per feature set
+		bool uber_shaders = false;
+
 		bool lighting = true;
 		glm::vec3 ambient_color {0.784f, 0.784f, 0.784f}; // RGB(200,200,200) / 255
 		glm::vec3 light_dir {0.577f, 0.577f, 0.577f}; // normalize(1,1,1)
@@ -77,12 +83,26 @@ struct Settings {
 		glm::vec2 position {-0.9f, -0.8f};
 		float scale = 0.48f;
 	} world_axis;
+
+	// AI aircrafts taxiing along field ground paths, only ones near camera go through the flight kernel
+	struct {
+		int count = 0;
+		mu::Str aircraft = "YS-11";
+		float full_radius = 1500; // m
+		int full_max = 32;
+		// farther ones are drawn as points
+		float mesh_radius = 4000; // m
+	} traffic;
 };
 
 // Aircraft/physics constants
 constexpr float PROPOLLER_MAX_ANGLE_SPEED = 10 * RADIANS_MAX;
 constexpr float AFTERBURNER_THROTTLE_THRESHOLD = 0.80f;
 
+// Ground objects constants
+constexpr float RADAR_SLOW_ANGLE_SPEED = RADIANS_MAX / 3;
+constexpr float RADAR_FAST_ANGLE_SPEED = RADIANS_MAX / 2;
+
 constexpr float THROTTLE_SPEED = 1.0f;
 
 constexpr float ENGINE_PROPELLERS_RESISTENCE = 15.0f;
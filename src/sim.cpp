@@ -0,0 +1,273 @@
+#include <chrono>
+
+#include "world.h"
+
+namespace sys {
+
+	// one-shot events must apply once even when a frame runs many steps or none
+	void _sim_events_for_step(World& world, bool first_step) {
+		DEF_SYSTEM
+
+		auto& events = world.events;
+		auto& pending = world.sim_pending_events;
+
+		if (first_step) {
+			events.afterburner_toggle  |= pending.afterburner_toggle;
+			events.brake               |= pending.brake;
+			events.landing_gear_toggle |= pending.landing_gear_toggle;
+			events.mouse_dx            += pending.mouse_dx;
+			events.mouse_dy            += pending.mouse_dy;
+			pending = {};
+		} else {
+			events.afterburner_toggle  = false;
+			events.brake               = false;
+			events.landing_gear_toggle = false;
+			events.mouse_dx            = 0;
+			events.mouse_dy            = 0;
+		}
+	}
+
+	void _sim_events_postpone(World& world) {
+		DEF_SYSTEM
+
+		auto& events = world.events;
+		auto& pending = world.sim_pending_events;
+
+		pending.afterburner_toggle  |= events.afterburner_toggle;
+		pending.brake               |= events.brake;
+		pending.landing_gear_toggle |= events.landing_gear_toggle;
+		pending.mouse_dx            += events.mouse_dx;
+		pending.mouse_dy            += events.mouse_dy;
+	}
+
+	void _sim_render_states_interpolate(World& world) {
+		DEF_SYSTEM
+
+		const float alpha = world.sim_clock.alpha;
+
+		for (auto& aircraft : world.aircrafts) {
+			aircraft_render_state_interpolate(aircraft, alpha);
+		}
+
+		for (auto& gro : world.ground_objs) {
+			gro.render_translation = gro.has_prev_state? glm::mix(gro.prev_translation, gro.translation, alpha) : gro.translation;
+			gro.render_offset = glm::translate(glm::mat4{1.0f}, gro.render_translation - gro.translation);
+		}
+	}
+
+	// steps aircrafts and ground objects at SIM_STEP, as many times as the frame's time covers
+	void sim_update(World& world) {
+		DEF_SYSTEM
+
+		const int steps = sim_clock_advance(world.sim_clock, world.loop_timer.delta_time);
+		if (steps == 0) {
+			_sim_events_postpone(world);
+		}
+
+		for (int i = 0; i < steps; i++) {
+			_sim_events_for_step(world, i == 0);
+
+			for (auto& aircraft : world.aircrafts) {
+				aircraft_prev_state_save(aircraft);
+			}
+			for (auto& gro : world.ground_objs) {
+				gro.prev_translation = gro.translation;
+				gro.has_prev_state = true;
+			}
+
+			frame_graph_run(world.sim_thread.step_graph, world.workers);
+		}
+
+		_sim_render_states_interpolate(world);
+	}
+
+	// after every system recorded into its lane
+	void _sim_frame_merge(World& world) {
+		DEF_SYSTEM
+
+		auto& frame = canvas_frame_recording(world.canvas);
+		frame.mats = world.mats;
+		frame.camera_position = world.camera.position;
+		canvas_frame_merge(frame, workers_count(world.workers));
+	}
+
+	// records current state into canvas frame, also records drawn frame again when GL objects it used were freed
+	void _sim_frame_record(World& world) {
+		DEF_SYSTEM
+
+		frame_graph_run(world.sim_thread.record_graph, world.workers);
+	}
+
+	// everything of a frame except GL, runs on simulation thread unless it's disabled
+	void sim_frame(World& world) {
+		DEF_SYSTEM
+
+		workers_timeline_begin(world.workers);
+
+		TEXT_OVERLAY("fps: {:.2f}", 1.0f/world.loop_timer.delta_time);
+
+		// aircrafts and ground objs are stepped in here
+		sim_update(world);
+
+		// camera, prepare_render, collision and audio
+		frame_graph_run(world.sim_thread.frame_graph, world.workers);
+
+		world.sim_thread.arena = {};
+	}
+
+	// each records into its own canvas lane, `_sim_frame_merge` runs after them
+	void _sim_prepare_render_systems_add(World& world, FrameGraph& graph) {
+		frame_graph_add(graph, "scenery_prepare_render", [&world] { scenery_prepare_render(world); },
+			FRAME_RESOURCE_SCENERY | FRAME_RESOURCE_MATS,
+			frame_resource_canvas_lane(CANVAS_LANE_SCENERY));
+		frame_graph_add(graph, "aircrafts_prepare_render", [&world] { aircrafts_prepare_render(world); },
+			FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_CAMERA | FRAME_RESOURCE_MATS,
+			frame_resource_canvas_lane(CANVAS_LANE_AIRCRAFTS) | FRAME_RESOURCE_TEXT_OVERLAY);
+		frame_graph_add(graph, "ground_objs_prepare_render", [&world] { ground_objs_prepare_render(world); },
+			FRAME_RESOURCE_GROUND_OBJS | FRAME_RESOURCE_MATS,
+			frame_resource_canvas_lane(CANVAS_LANE_GROUND_OBJS));
+		frame_graph_add(graph, "traffic_prepare_render", [&world] { traffic_prepare_render(world); },
+			FRAME_RESOURCE_TRAFFIC | FRAME_RESOURCE_CAMERA | FRAME_RESOURCE_MATS,
+			frame_resource_canvas_lane(CANVAS_LANE_TRAFFIC));
+	}
+
+	void _sim_frame_merge_system_add(World& world, FrameGraph& graph) {
+		frame_graph_add(graph, "_sim_frame_merge", [&world] { _sim_frame_merge(world); },
+			FRAME_RESOURCE_CANVAS_LANES | FRAME_RESOURCE_MATS | FRAME_RESOURCE_CAMERA,
+			FRAME_RESOURCE_CANVAS_MERGED);
+	}
+
+	void _sim_thread_main(World* world) {
+		auto& self = world->sim_thread;
+
+		while (true) {
+			{
+				std::unique_lock lock(self.mutex);
+				self.cv_kick.wait(lock, [&] { return self.quit || self.frame_running; });
+				if (self.quit) {
+					return;
+				}
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			sim_frame(*world);
+			const double millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			{
+				std::lock_guard lock(self.mutex);
+				self.last_frame_millis = millis;
+				self.frame_running = false;
+			}
+			self.cv_done.notify_one();
+		}
+	}
+
+	void sim_thread_init(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.sim_thread;
+
+		// what each system reads and writes of world, in the order they'd run serially
+		frame_graph_add(self.step_graph, "aircrafts_step", [&world] { aircrafts_step(world); },
+			FRAME_RESOURCE_EVENTS | FRAME_RESOURCE_CAMERA | FRAME_RESOURCE_SCENERY,
+			FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_REPLAY | FRAME_RESOURCE_AUDIO | FRAME_RESOURCE_SIM_ARENA);
+		frame_graph_add(self.step_graph, "ground_objs_step", [&world] { ground_objs_step(world); },
+			0, FRAME_RESOURCE_GROUND_OBJS);
+		// level of detail around camera and the aircraft it follows, after it moved
+		frame_graph_add(self.step_graph, "traffic_step", [&world] { traffic_step(world); },
+			FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_CAMERA | FRAME_RESOURCE_SCENERY, FRAME_RESOURCE_TRAFFIC | FRAME_RESOURCE_SIM_ARENA);
+		frame_graph_add(self.step_graph, "recorder_step", [&world] { recorder_step(world); },
+			FRAME_RESOURCE_AIRCRAFTS, FRAME_RESOURCE_RECORDER);
+
+		// camera follows interpolated state, so it's after simulation
+		frame_graph_add(self.frame_graph, "camera_update", [&world] { camera_update(world); },
+			FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_EVENTS, FRAME_RESOURCE_CAMERA);
+		frame_graph_add(self.frame_graph, "cached_matrices_recalc", [&world] { cached_matrices_recalc(world); },
+			FRAME_RESOURCE_CAMERA, FRAME_RESOURCE_MATS);
+		_sim_prepare_render_systems_add(world, self.frame_graph);
+		// ground objects too are written, their broadphase proxies are synced with them
+		frame_graph_add(self.frame_graph, "models_handle_collision", [&world] { models_handle_collision(world); },
+			FRAME_RESOURCE_SCENERY,
+			FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_GROUND_OBJS | FRAME_RESOURCE_BROADPHASE | FRAME_RESOURCE_SIM_ARENA
+				| frame_resource_canvas_lane(CANVAS_LANE_COLLISION) | FRAME_RESOURCE_TEXT_OVERLAY);
+		frame_graph_add(self.frame_graph, "aircrafts_audio_update", [&world] { aircrafts_audio_update(world); },
+			FRAME_RESOURCE_AIRCRAFTS | FRAME_RESOURCE_CAMERA, FRAME_RESOURCE_AUDIO);
+		_sim_frame_merge_system_add(world, self.frame_graph);
+
+		_sim_prepare_render_systems_add(world, self.record_graph);
+		_sim_frame_merge_system_add(world, self.record_graph);
+
+		self.enabled = world.headless.enabled == false;
+		if (self.enabled) {
+			self.thread = std::thread(_sim_thread_main, &world);
+		}
+	}
+
+	void sim_thread_free(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.sim_thread;
+
+		if (self.enabled == false) {
+			return;
+		}
+
+		// a running frame finishes first
+		{
+			std::lock_guard lock(self.mutex);
+			self.quit = true;
+		}
+		self.cv_kick.notify_one();
+		self.thread.join();
+	}
+
+	// blocks till kicked frame is recorded, then it's the frame to draw and main thread owns the world
+	void sim_thread_wait(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.sim_thread;
+
+		if (self.enabled == false || self.frame_pending == false) {
+			return;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		{
+			std::unique_lock lock(self.mutex);
+			self.cv_done.wait(lock, [&] { return self.frame_running == false; });
+		}
+		self.last_wait_millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		self.frame_pending = false;
+		canvas_frames_swap(world.canvas);
+	}
+
+	// main thread is done editing the world, next frame is recorded from here while this one is drawn
+	void sim_thread_kick(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.sim_thread;
+
+		if (self.enabled == false) {
+			sim_frame(world);
+			canvas_frames_swap(world.canvas);
+			return;
+		}
+
+		// GL objects or scenery cache the frame uses were freed since it was recorded, record it again before it's drawn
+		if (world.canvas.frame_drawing_stale) {
+			canvas_frames_swap(world.canvas);
+			canvas_frame_clear(canvas_frame_recording(world.canvas));
+			_sim_frame_record(world);
+			canvas_frames_swap(world.canvas);
+		}
+
+		{
+			std::lock_guard lock(self.mutex);
+			self.frame_running = true;
+		}
+		self.frame_pending = true;
+		self.cv_kick.notify_one();
+	}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <mu/utils.h>
+
+#include "frame_graph.h"
+
+// simulation advances in fixed steps whatever the render rate is, so frame jitter never reaches the flight model
+constexpr double SIM_STEP = 1.0 / 120;
+
+// after a long frame (e.g. loading a scenery) the rest is dropped instead of catching up,
+// as catching up makes next frame even longer
+constexpr int SIM_MAX_STEPS_PER_FRAME = 8;
+
+struct SimClock {
+	// simulation seconds owed to the world, less than SIM_STEP after `sim_clock_advance`
+	double accumulator;
+
+	// where render time is between previous and current step, in [0, 1]
+	double alpha;
+
+	int steps_last_frame;
+	uint64_t steps;
+};
+
+// returns how many steps to run for a frame that took `frame_delta_time` seconds
+inline int sim_clock_advance(SimClock& self, double frame_delta_time) {
+	self.accumulator += frame_delta_time;
+
+	// epsilon so frames that are exact multiples of the step don't lose one to rounding
+	int steps = int((self.accumulator + 1e-9) / SIM_STEP);
+	if (steps > SIM_MAX_STEPS_PER_FRAME) {
+		steps = SIM_MAX_STEPS_PER_FRAME;
+		self.accumulator = steps * SIM_STEP;
+	}
+	self.accumulator = std::max(0.0, self.accumulator - steps * SIM_STEP);
+
+	self.alpha = std::clamp(self.accumulator / SIM_STEP, 0.0, 1.0);
+	self.steps_last_frame = steps;
+	self.steps += steps;
+	return steps;
+}
+
+// runs `sys::sim_frame` (steps, collision, camera and prepare_render) of next frame while main thread draws current one
+// main thread owns the world between `sys::sim_thread_wait` and `sys::sim_thread_kick`, that's where GL objects are
+// loaded/freed and imgui edits the world, simulation thread owns everything but GL and canvas passes after the kick
+struct SimThread {
+	// off in headless, frames run serially there so they are reproducible
+	bool enabled;
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cv_kick, cv_done;
+	bool frame_pending; // kicked and not waited for yet
+	bool frame_running;
+	bool quit;
+
+	// code running on simulation thread allocates from here instead of tmp allocator, reset after each frame
+	mu::memory::Arena arena;
+
+	// systems of each step, of each frame after steps, and of recording a frame alone, see `sys::sim_thread_init`
+	FrameGraph step_graph, frame_graph, record_graph;
+
+	// how long last frame took on simulation thread, and how long main thread waited for it
+	double last_frame_millis;
+	double last_wait_millis;
+};
+
+inline void test_sim_clock() {
+	mu_test_suite("test_sim_clock");
+
+	// render rate lower than sim rate, multiple steps per frame
+	{
+		SimClock clock {};
+		mu_test(sim_clock_advance(clock, 1.0 / 60) == 2);
+		mu_test(clock.alpha < 0.0001);
+	}
+
+	// render rate higher than sim rate, steps only when enough time accumulates
+	{
+		SimClock clock {};
+		mu_test(sim_clock_advance(clock, SIM_STEP * 0.75) == 0);
+		mu_test(clock.alpha > 0.74 && clock.alpha < 0.76);
+		mu_test(sim_clock_advance(clock, SIM_STEP * 0.75) == 1);
+		mu_test(clock.alpha > 0.49 && clock.alpha < 0.51);
+	}
+
+	// long frame drops what doesn't fit
+	{
+		SimClock clock {};
+		mu_test(sim_clock_advance(clock, 1.0) == SIM_MAX_STEPS_PER_FRAME);
+		mu_test(clock.accumulator == 0);
+		mu_test(clock.steps == SIM_MAX_STEPS_PER_FRAME);
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+// SSE2 is there on every x86-64 compiler, others get the same api over plain arrays
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define SIMD_SSE2 1
+#endif
+
+// 4 floats handled per instruction, used by kernels that step many objects at once (e.g. flight_block_step)
+// written like plain float math, compilers don't vectorize long loop bodies with conditions reliably
+#ifdef SIMD_SSE2
+
+struct Float4 {
+	__m128 v;
+
+	Float4() = default;
+	Float4(__m128 v) : v(v) {}
+	Float4(float f) : v(_mm_set1_ps(f)) {}
+};
+
+// all bits set in lanes where it's true
+struct Bool4 {
+	__m128 v;
+};
+
+inline Float4 float4_load(const float* p)       { return _mm_loadu_ps(p); }
+inline void float4_store(float* p, Float4 a)    { _mm_storeu_ps(p, a.v); }
+inline float float4_first(Float4 a)             { return _mm_cvtss_f32(a.v); }
+
+inline Float4 operator+(Float4 a, Float4 b)     { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b)     { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b)     { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator/(Float4 a, Float4 b)     { return _mm_div_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a)               { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+
+inline Bool4 operator<(Float4 a, Float4 b)      { return {_mm_cmplt_ps(a.v, b.v)}; }
+inline Bool4 operator>(Float4 a, Float4 b)      { return {_mm_cmpgt_ps(a.v, b.v)}; }
+inline Bool4 operator>=(Float4 a, Float4 b)     { return {_mm_cmpge_ps(a.v, b.v)}; }
+inline Bool4 operator&(Bool4 a, Bool4 b)        { return {_mm_and_ps(a.v, b.v)}; }
+
+inline Float4 float4_min(Float4 a, Float4 b)    { return _mm_min_ps(a.v, b.v); }
+inline Float4 float4_max(Float4 a, Float4 b)    { return _mm_max_ps(a.v, b.v); }
+inline Float4 float4_sqrt(Float4 a)             { return _mm_sqrt_ps(a.v); }
+inline Float4 float4_abs(Float4 a)              { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline Float4 float4_trunc(Float4 a)            { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v)); } // |a| < 2^31
+
+// a where mask is true, b elsewhere
+inline Float4 float4_select(Bool4 mask, Float4 a, Float4 b) {
+	return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+}
+
+// true in any lane
+inline bool bool4_any(Bool4 a)                  { return _mm_movemask_ps(a.v) != 0; }
+
+#else
+
+struct Float4 {
+	float v[4];
+
+	Float4() = default;
+	Float4(float f) : v{f, f, f, f} {}
+};
+
+struct Bool4 {
+	bool v[4];
+};
+
+#define _FLOAT4_MAP(EXPR) Float4 r; for (int i = 0; i < 4; i++) { r.v[i] = (EXPR); } return r;
+#define _BOOL4_MAP(EXPR) Bool4 r; for (int i = 0; i < 4; i++) { r.v[i] = (EXPR); } return r;
+
+inline Float4 float4_load(const float* p)       { _FLOAT4_MAP(p[i]) }
+inline void float4_store(float* p, Float4 a)    { for (int i = 0; i < 4; i++) { p[i] = a.v[i]; } }
+inline float float4_first(Float4 a)             { return a.v[0]; }
+
+inline Float4 operator+(Float4 a, Float4 b)     { _FLOAT4_MAP(a.v[i] + b.v[i]) }
+inline Float4 operator-(Float4 a, Float4 b)     { _FLOAT4_MAP(a.v[i] - b.v[i]) }
+inline Float4 operator*(Float4 a, Float4 b)     { _FLOAT4_MAP(a.v[i] * b.v[i]) }
+inline Float4 operator/(Float4 a, Float4 b)     { _FLOAT4_MAP(a.v[i] / b.v[i]) }
+inline Float4 operator-(Float4 a)               { _FLOAT4_MAP(-a.v[i]) }
+
+inline Bool4 operator<(Float4 a, Float4 b)      { _BOOL4_MAP(a.v[i] < b.v[i]) }
+inline Bool4 operator>(Float4 a, Float4 b)      { _BOOL4_MAP(a.v[i] > b.v[i]) }
+inline Bool4 operator>=(Float4 a, Float4 b)     { _BOOL4_MAP(a.v[i] >= b.v[i]) }
+inline Bool4 operator&(Bool4 a, Bool4 b)        { _BOOL4_MAP(a.v[i] && b.v[i]) }
+
+inline Float4 float4_min(Float4 a, Float4 b)    { _FLOAT4_MAP(std::min(a.v[i], b.v[i])) }
+inline Float4 float4_max(Float4 a, Float4 b)    { _FLOAT4_MAP(std::max(a.v[i], b.v[i])) }
+inline Float4 float4_sqrt(Float4 a)             { _FLOAT4_MAP(std::sqrt(a.v[i])) }
+inline Float4 float4_abs(Float4 a)              { _FLOAT4_MAP(std::abs(a.v[i])) }
+inline Float4 float4_trunc(Float4 a)            { _FLOAT4_MAP(std::trunc(a.v[i])) }
+
+inline Float4 float4_select(Bool4 mask, Float4 a, Float4 b) { _FLOAT4_MAP(mask.v[i]? a.v[i] : b.v[i]) }
+
+inline bool bool4_any(Bool4 a)                  { return a.v[0] || a.v[1] || a.v[2] || a.v[3]; }
+
+#undef _FLOAT4_MAP
+#undef _BOOL4_MAP
+
+#endif
+
+inline Float4 float4_clamp(Float4 a, Float4 lo, Float4 hi) {
+	return float4_min(float4_max(a, lo), hi);
+}
@@ -0,0 +1,638 @@
+#include <chrono>
+
+#include "world.h"
+
+namespace sys {
+
+	void simulate_init(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.simulate;
+
+		world.aircraft_templates = aircraft_templates_from_dir(ASSETS_DIR "/aircraft");
+		world.scenery_templates = scenery_templates_from_dir(ASSETS_DIR "/scenery");
+
+		// start positions and terrain, field is parsed but never uploaded to GL
+		auto scenery_template = world.scenery_templates.find(self.scenery_name);
+		if (scenery_template == world.scenery_templates.end()) {
+			mu::panic("scenery '{}' not found", self.scenery_name);
+		}
+		world.scenery.scenery_template = scenery_template->second;
+		world.scenery.root_fld = field_from_fld_file(scenery_template->second.fld);
+		scenery_fields_transform(world.scenery, field_list_recursively(world.scenery.root_fld, mu::memory::tmp()));
+		scenery_terrain_rebuild(world.scenery);
+		world.scenery.start_infos = start_info_from_stp_file(scenery_template->second.stp);
+		if (world.scenery.start_infos.size() < self.aircraft_names.size()) {
+			mu::panic("scenery '{}' has {} start positions, can't start {} aircrafts",
+				self.scenery_name, world.scenery.start_infos.size(), self.aircraft_names.size());
+		}
+
+		// camera.aircraft points into it
+		world.aircrafts.reserve(self.aircraft_names.size());
+		for (size_t i = 0; i < self.aircraft_names.size(); i++) {
+			auto aircraft_template = world.aircraft_templates.find(self.aircraft_names[i]);
+			if (aircraft_template == world.aircraft_templates.end()) {
+				mu::panic("aircraft '{}' not found", self.aircraft_names[i]);
+			}
+
+			auto aircraft = aircraft_new(aircraft_template->second);
+			aircraft_load_physics(aircraft);
+			aircraft_update_aero_table(aircraft);
+			aircraft_set_start(aircraft, world.scenery.start_infos[i]);
+			world.aircrafts.push_back(aircraft);
+		}
+		world.camera.aircraft = &world.aircrafts[0];
+
+		if (self.script_path.empty() == false) {
+			self.commands = simulate_script_from_file(self.script_path);
+		}
+
+		mu::log_info("simulate: {:.1f} seconds of {} aircrafts on '{}', {} commands",
+			self.duration_secs, world.aircrafts.size(), self.scenery_name, self.commands.size());
+	}
+
+	// script drives the first aircraft, it's the camera tracked one so user controls apply to it
+	void _simulate_command_apply(World& world, const SimulateCommand& command) {
+		auto& events = world.events;
+		const bool pressed = command.value != 0;
+
+		switch (command.input) {
+		case SimulateInput::STICK_RIGHT:         events.stick_right = pressed;        break;
+		case SimulateInput::STICK_LEFT:          events.stick_left = pressed;         break;
+		case SimulateInput::STICK_FRONT:         events.stick_front = pressed;        break;
+		case SimulateInput::STICK_BACK:          events.stick_back = pressed;         break;
+		case SimulateInput::RUDDER_RIGHT:        events.rudder_right = pressed;       break;
+		case SimulateInput::RUDDER_LEFT:         events.rudder_left = pressed;        break;
+		case SimulateInput::THROTTLE_INCREASE:   events.throttle_increase = pressed;  break;
+		case SimulateInput::THROTTLE_DECREASE:   events.throttle_decrease = pressed;  break;
+		case SimulateInput::AFTERBURNER_TOGGLE:  events.afterburner_toggle = true;    break;
+		case SimulateInput::BRAKE:               events.brake = true;                 break;
+		case SimulateInput::LANDING_GEAR_TOGGLE: events.landing_gear_toggle = true;   break;
+		case SimulateInput::THROTTLE:
+			world.camera.aircraft->throttle = glm::clamp(command.value, 0.0f, 1.0f);
+			break;
+		}
+	}
+
+	void _simulate_trajectory_sample(World& world, double time) {
+		for (int i = 0; i < world.aircrafts.size(); i++) {
+			const auto& aircraft = world.aircrafts[i];
+			world.simulate.trajectory.push_back(SimulateSample {
+				.time = time,
+				.aircraft = i,
+				.translation = aircraft.translation,
+				.velocity = aircraft.velocity,
+				.orientation = aircraft.orientation,
+				.throttle = aircraft.throttle,
+				.elevator = aircraft.elevator_perc,
+				.aileron = aircraft.right_aileron_perc,
+				.rudder = aircraft.rudder_perc,
+				.fuel = aircraft.mass.fuel,
+			});
+		}
+	}
+
+	// same steps windowed loop runs, back to back instead of waiting for frames
+	void simulate_run(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.simulate;
+		auto& events = world.events;
+
+		self.steps = uint64_t(self.duration_secs / SIM_STEP + 0.5);
+		const bool sampled = self.trajectory_path.empty() == false;
+		if (sampled) {
+			self.trajectory.reserve((self.steps / self.trajectory_every + 1) * world.aircrafts.size());
+		}
+
+		size_t next_command = 0;
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint64_t step = 0; step < self.steps; step++) {
+			const double time = step * SIM_STEP;
+
+			if (sampled && step % self.trajectory_every == 0) {
+				_simulate_trajectory_sample(world, time);
+			}
+
+			while (next_command < self.commands.size() && self.commands[next_command].time <= time) {
+				_simulate_command_apply(world, self.commands[next_command]);
+				next_command++;
+			}
+
+			aircrafts_step(world);
+			recorder_step(world);
+
+			events.afterburner_toggle  = false;
+			events.brake               = false;
+			events.landing_gear_toggle = false;
+			world.sim_thread.arena = {};
+		}
+
+		self.wall_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (sampled) {
+			_simulate_trajectory_sample(world, self.steps * SIM_STEP);
+		}
+	}
+
+	void simulate_report(World& world) {
+		DEF_SYSTEM
+
+		const auto& self = world.simulate;
+
+		if (self.trajectory_path.empty() == false) {
+			FILE* f = fopen(self.trajectory_path.c_str(), "w");
+			if (f == nullptr) {
+				mu::log_error("simulate: failed to open '{}'", self.trajectory_path);
+			} else {
+				mu_defer(fclose(f));
+				fmt::print(f, "time,aircraft,x,y,z,qw,qx,qy,qz,vx,vy,vz,throttle,elevator,aileron,rudder,fuel\n");
+				for (const auto& s : self.trajectory) {
+					fmt::print(f, "{:.4f},{},{:.4f},{:.4f},{:.4f},{:.6f},{:.6f},{:.6f},{:.6f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.6f}\n",
+						s.time, s.aircraft,
+						s.translation.x, s.translation.y, s.translation.z,
+						s.orientation.w, s.orientation.x, s.orientation.y, s.orientation.z,
+						s.velocity.x, s.velocity.y, s.velocity.z,
+						s.throttle, s.elevator, s.aileron, s.rudder, s.fuel);
+				}
+			}
+		}
+
+		const double sim_secs = self.steps * SIM_STEP;
+		fmt::print("simulate: {} steps of {} aircrafts at {:.0f}Hz\n", self.steps, world.aircrafts.size(), 1.0 / SIM_STEP);
+		fmt::print("simulated {:.2f}s in {:.4f}s wall, {:.1f} sim-seconds per wall-second, {:.0f} steps per second, {:.3f}us per step\n",
+			sim_secs, self.wall_secs, sim_secs / std::max(self.wall_secs, 1e-9), self.steps / std::max(self.wall_secs, 1e-9),
+			self.wall_secs * 1e6 / std::max<uint64_t>(self.steps, 1));
+		for (const auto& aircraft : world.aircrafts) {
+			fmt::print("{}: position ({:.1f}, {:.1f}, {:.1f}), speed {:.1f}m/s, fuel {:.3f}t\n",
+				aircraft.aircraft_template.short_name,
+				aircraft.translation.x, aircraft.translation.y, aircraft.translation.z,
+				glm::length(aircraft.velocity), aircraft.mass.fuel);
+		}
+	}
+
+	// terrain queries at random points over the scenery, through the grid and against trying every patch
+	void _simulate_bench_terrain(World& world) {
+		DEF_SYSTEM
+
+		const auto& terrain = world.scenery.terrain;
+		if (terrain.grid_x == 0) {
+			return;
+		}
+
+		constexpr size_t QUERIES = 1 << 20;
+		const float cell_size = 1.0f / terrain.cell_size_inv;
+
+		mu::Vec<glm::vec2> points(QUERIES);
+		uint32_t random = 1;
+		for (auto& point : points) {
+			random = random * 1664525u + 1013904223u;
+			point.x = terrain.grid_min.x + (random >> 8) / float(1 << 24) * terrain.grid_x * cell_size;
+			random = random * 1664525u + 1013904223u;
+			point.y = terrain.grid_min.y + (random >> 8) / float(1 << 24) * terrain.grid_z * cell_size;
+		}
+		mu::Vec<TerrainSample> samples(QUERIES);
+
+		auto start = std::chrono::steady_clock::now();
+		terrain_sample_batch(terrain, points, samples);
+		const double grid_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		size_t hits = 0, mismatches = 0;
+		constexpr size_t BRUTE_QUERIES = QUERIES / 64;
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < BRUTE_QUERIES; i++) {
+			TerrainSample best = TERRAIN_SAMPLE_PLANE;
+			bool found = false;
+			for (const auto& patch : terrain.patches) {
+				TerrainSample sample;
+				if (_terrain_patch_sample(terrain, patch, points[i].x, points[i].y, sample) && (found == false || sample.y < best.y)) {
+					best = sample;
+					found = true;
+				}
+			}
+			hits += found;
+			mismatches += best.y != samples[i].y;
+		}
+		const double brute_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		fmt::print("bench: terrain of '{}', {} patches, {}x{} cells of {:.0f}m, {:.0f}% of points on terrain, {} mismatches\n",
+			world.scenery.scenery_template.name, terrain.patches.size(), terrain.grid_x, terrain.grid_z, cell_size,
+			100.0 * hits / BRUTE_QUERIES, mismatches);
+		fmt::print("  grid:         {:.1f}M queries per second\n", QUERIES / std::max(grid_secs, 1e-9) / 1e6);
+		fmt::print("  every patch:  {:.1f}M queries per second\n", BRUTE_QUERIES / std::max(brute_secs, 1e-9) / 1e6);
+	}
+
+	// raycasts over scenery triangles, closest hits of a camera's pixels one by one and in packets, and sight lines
+	void _simulate_bench_raycast(World& world) {
+		DEF_SYSTEM
+
+		const auto& terrain = world.scenery.terrain;
+		if (terrain.grid_x == 0) {
+			return;
+		}
+
+		auto& bvh = world.scenery.raycast;
+
+		auto start = std::chrono::steady_clock::now();
+		scenery_raycast_rebuild(world.scenery, {}, {});
+		const double build_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		const auto cache_dir = (std::filesystem::temp_directory_path() / "open-ysf-bench-bvh-cache").string();
+		scenery_raycast_rebuild(world.scenery, {}, cache_dir);
+		start = std::chrono::steady_clock::now();
+		scenery_raycast_rebuild(world.scenery, {}, cache_dir);
+		const double cached_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::filesystem::remove_all(cache_dir);
+
+		// 1024x1024 pixels of a camera 300m above middle of terrain looking 30 degrees down
+		// in 2x2 tiles, so each packet of 4 rays is of neighbouring pixels
+		constexpr int PIXELS = 1024;
+		const float cell_size = 1.0f / terrain.cell_size_inv;
+		glm::vec3 camera {
+			terrain.grid_min.x + terrain.grid_x * cell_size * 0.5f,
+			0,
+			terrain.grid_min.y + terrain.grid_z * cell_size * 0.5f,
+		};
+		camera.y = terrain_sample(terrain, camera.x, camera.z).y - 300;
+		mu::Vec<Ray> rays;
+		for (int y = 0; y < PIXELS; y += 2) {
+			for (int x = 0; x < PIXELS; x += 2) {
+				for (int i = 0; i < 4; i++) {
+					const float px = float(x + i % 2) / PIXELS - 0.5f;
+					const float py = float(y + i / 2) / PIXELS - 0.5f;
+					rays.push_back(Ray { .origin = camera, .direction = {px, 0.5f + py, 0.866f} });
+				}
+			}
+		}
+		mu::Vec<RaycastHit> hits(rays.size());
+
+		start = std::chrono::steady_clock::now();
+		size_t single_hits = 0;
+		for (const auto& ray : rays) {
+			single_hits += raycast(bvh, ray).triangle != RAYCAST_NONE;
+		}
+		const double single_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		raycast_batch(bvh, rays, hits);
+		const double batch_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		size_t batch_hits = 0;
+		for (const auto& hit : hits) {
+			batch_hits += hit.triangle != RAYCAST_NONE;
+		}
+
+		// between random points 50m over terrain, most are blocked by hills in between
+		uint32_t random = 1;
+		auto random_point = [&]() {
+			glm::vec3 p;
+			random = random * 1664525u + 1013904223u;
+			p.x = terrain.grid_min.x + (random >> 8) / float(1 << 24) * terrain.grid_x * cell_size;
+			random = random * 1664525u + 1013904223u;
+			p.z = terrain.grid_min.y + (random >> 8) / float(1 << 24) * terrain.grid_z * cell_size;
+			p.y = terrain_sample(terrain, p.x, p.z).y - 50;
+			return p;
+		};
+		mu::Vec<Ray> sight_lines;
+		for (int i = 0; i < (1 << 18); i++) {
+			const auto from = random_point();
+			sight_lines.push_back(Ray { .origin = from, .direction = random_point() - from, .t_max = 1 });
+		}
+
+		start = std::chrono::steady_clock::now();
+		size_t blocked = 0;
+		for (const auto& ray : sight_lines) {
+			blocked += raycast_any(bvh, ray);
+		}
+		const double sight_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		fmt::print("bench: raycasts over '{}', {} triangles in {} nodes, built in {:.1f}ms, loaded from cache in {:.1f}ms\n",
+			world.scenery.scenery_template.name, bvh.triangles.size(), bvh.nodes.size(), build_secs * 1000, cached_secs * 1000);
+		fmt::print("  closest hit:  {:.2f}M rays per second one by one, {:.2f}M in packets of 4 ({} and {} of {} hit)\n",
+			rays.size() / std::max(single_secs, 1e-9) / 1e6, rays.size() / std::max(batch_secs, 1e-9) / 1e6, single_hits, batch_hits, rays.size());
+		fmt::print("  sight lines:  {:.2f}M rays per second, {:.0f}% blocked\n",
+			sight_lines.size() / std::max(sight_secs, 1e-9) / 1e6, 100.0 * blocked / sight_lines.size());
+	}
+
+	// 10k boxes over 20km, buildings never move and aircrafts fly straight, broadphase against testing every two
+	void _simulate_bench_broadphase(World& world) {
+		DEF_SYSTEM
+
+		constexpr uint32_t STATICS = 9000, DYNAMICS = 1000, FRAMES = 120, BRUTE_FRAMES = 4;
+		constexpr float AREA = 20000;
+
+		uint32_t random = 1;
+		auto random_float = [&random](float min, float max) {
+			random = random * 1664525u + 1013904223u;
+			return min + (random >> 8) / float(1 << 24) * (max - min);
+		};
+
+		mu::Vec<AABB> boxes;
+		mu::Vec<glm::vec3> velocities;
+		for (uint32_t i = 0; i < STATICS + DYNAMICS; i++) {
+			const bool is_static = i < STATICS;
+			const glm::vec3 min {random_float(0, AREA), is_static? -random_float(10, 80) : -random_float(0, 500), random_float(0, AREA)};
+			const glm::vec3 size = is_static? glm::vec3{random_float(10, 60), -min.y, random_float(10, 60)} : glm::vec3{15, 5, 15};
+			boxes.push_back(AABB { .min = min, .max = min + size });
+			velocities.push_back(is_static? glm::vec3{} : glm::vec3{random_float(-100, 100), 0, random_float(-100, 100)});
+		}
+		auto move = [&]() {
+			for (uint32_t i = STATICS; i < boxes.size(); i++) {
+				boxes[i].min += velocities[i] * (float) SIM_STEP;
+				boxes[i].max += velocities[i] * (float) SIM_STEP;
+			}
+		};
+
+		Broadphase broadphase {};
+		mu::Vec<uint32_t> handles;
+		for (uint32_t i = 0; i < boxes.size(); i++) {
+			handles.push_back(broadphase_add(broadphase, boxes[i], i, i < STATICS));
+		}
+		broadphase_update(broadphase);
+
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < FRAMES; frame++) {
+			move();
+			for (uint32_t i = STATICS; i < boxes.size(); i++) {
+				broadphase_move(broadphase, handles[i], boxes[i], i);
+			}
+			broadphase_update(broadphase);
+		}
+		const double broadphase_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		size_t brute_pairs = 0;
+		start = std::chrono::steady_clock::now();
+		for (uint32_t frame = 0; frame < BRUTE_FRAMES; frame++) {
+			brute_pairs = 0;
+			for (uint32_t i = STATICS; i < boxes.size(); i++) {
+				for (uint32_t j = 0; j < boxes.size(); j++) {
+					brute_pairs += (j < STATICS || j > i) && aabbs_intersect(boxes[i], boxes[j]);
+				}
+			}
+		}
+		const double brute_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		fmt::print("bench: broadphase, {} static and {} moving boxes, {} pairs ({} testing every two)\n",
+			STATICS, DYNAMICS, broadphase.pairs.size(), brute_pairs);
+		fmt::print("  broadphase:   {:.3f}ms per frame\n", broadphase_secs / FRAMES * 1000);
+		fmt::print("  every two:    {:.3f}ms per frame\n", brute_secs / BRUTE_FRAMES * 1000);
+	}
+
+	// narrowphase of each --aircraft against a copy of itself, at random poses whose world AABBs intersect
+	void _simulate_bench_narrowphase(World& world) {
+		DEF_SYSTEM
+
+		for (const auto& bench_aircraft : world.aircrafts) {
+			constexpr int PAIRS = 1 << 14;
+
+			const auto& mesh = bench_aircraft.collision;
+			const auto model_aabb = mesh.nodes.empty()? bench_aircraft.initial_aabb : AABB { .min = mesh.nodes[0].min, .max = mesh.nodes[0].max };
+			const auto model_size = model_aabb.max - model_aabb.min;
+			auto world_aabb = [&](const glm::mat4& transformation) {
+				const auto obb = obb_from_aabb(model_aabb, transformation);
+				glm::vec3 extent {};
+				for (int i = 0; i < 3; i++) {
+					extent += glm::abs(obb.axes[i]) * obb.half_extents[i];
+				}
+				return AABB { .min = obb.center - extent, .max = obb.center + extent };
+			};
+
+			uint32_t random = 1;
+			auto random_float = [&random](float min, float max) {
+				random = random * 1664525u + 1013904223u;
+				return min + (random >> 8) / float(1 << 24) * (max - min);
+			};
+
+			mu::Vec<std::pair<CollisionBody, CollisionBody>> pairs;
+			while (pairs.size() < PAIRS) {
+				CollisionBody a {.mesh = &mesh, .initial_aabb = bench_aircraft.initial_aabb};
+				CollisionBody b = a;
+				a.transformation = local_euler_angles_matrix(local_euler_angles_from_attitude({random_float(0, RADIANS_MAX), random_float(-0.5f, 0.5f), random_float(-1, 1)}), {});
+				b.transformation = local_euler_angles_matrix(local_euler_angles_from_attitude({random_float(0, RADIANS_MAX), random_float(-0.5f, 0.5f), random_float(-1, 1)}),
+					glm::vec3{random_float(-1, 1), random_float(-0.5f, 0.5f), random_float(-1, 1)} * model_size);
+				if (aabbs_intersect(world_aabb(a.transformation), world_aabb(b.transformation))) {
+					pairs.push_back({a, b});
+				}
+			}
+
+			size_t obbs_intersecting = 0;
+			for (const auto& [a, b] : pairs) {
+				obbs_intersecting += obbs_intersect(obb_from_aabb(model_aabb, a.transformation), obb_from_aabb(model_aabb, b.transformation));
+			}
+
+			size_t colliding = 0;
+			const auto start = std::chrono::steady_clock::now();
+			for (const auto& [a, b] : pairs) {
+				colliding += collision_bodies_intersect(a, b);
+			}
+			const double narrowphase_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			fmt::print("bench: '{}' narrowphase, {} triangles in {} nodes, of {} AABB pairs {:.0f}% OBBs and {:.0f}% triangles intersect\n",
+				bench_aircraft.aircraft_template.short_name, mesh.triangles.size(), mesh.nodes.size(), PAIRS,
+				100.0 * obbs_intersecting / PAIRS, 100.0 * colliding / PAIRS);
+			fmt::print("  narrowphase:  {:.1f} pairs per ms\n", PAIRS / std::max(narrowphase_secs * 1000, 1e-9));
+		}
+	}
+
+	// mesh transformations from the animation table against visiting every mesh, for each --aircraft
+	void _simulate_bench_animation(World& world) {
+		DEF_SYSTEM
+
+		for (const auto& bench_aircraft : world.aircrafts) {
+			// copy's table is built again for its own meshes
+			auto aircraft = bench_aircraft;
+			auto& meshes = aircraft.model.meshes;
+			auto& animation = aircraft.animation;
+			animation_table_update(animation, meshes, AnimationModel::AIRCRAFT);
+
+			size_t animated_count = 0;
+			for (const auto& channel : animation.channels) {
+				animated_count += channel.size();
+			}
+
+			constexpr int TICKS = 1 << 14;
+			const auto root = bench_aircraft.kinematics.model_transformation;
+
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < TICKS; i++) {
+				for (auto& mesh : meshes) {
+					mesh.transformation = root;
+				}
+				meshes_foreach(meshes, [](Mesh& mesh) {
+					mesh.transformation = mesh_local_transformation(mesh.transformation, mesh);
+					for (auto& child : mesh.children) {
+						child.transformation = mesh.transformation;
+					}
+					return true;
+				});
+				mu::memory::reset_tmp();
+			}
+			const double traverse_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < TICKS; i++) {
+				animation_table_transform(animation, root);
+			}
+			const double table_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			fmt::print("bench: '{}' meshes, {} nodes ({} static, {} under {} animated)\n", bench_aircraft.aircraft_template.short_name,
+				animation.static_nodes.size() + animation.dynamic_nodes.size(), animation.static_nodes.size(),
+				animation.dynamic_nodes.size(), animated_count);
+			fmt::print("  all meshes:      {:.1f}ns per aircraft-step\n", traverse_secs * 1e9 / TICKS);
+			fmt::print("  animation table: {:.1f}ns per aircraft-step\n", table_secs * 1e9 / TICKS);
+		}
+	}
+
+	// tables against the curves and formula they're sampled from
+	void _simulate_bench_aero_tables(World& world) {
+		DEF_SYSTEM
+
+		const auto& aircraft = world.aircrafts[0];
+
+		const FlightAeroTable* const tables[4] = {&aircraft.aero_table, &aircraft.aero_table, &aircraft.aero_table, &aircraft.aero_table};
+
+		float cl_error = 0, cd_error = 0;
+		for (float aoa = -180; aoa <= 180; aoa += 0.01f) {
+			Float4 cl, cd;
+			flight_aero_lookup(tables, aoa, cl, cd);
+			cl_error = std::max(cl_error, std::abs(float4_first(cl) - aircraft_calc_lift_coeff(aircraft, aoa)));
+			cd_error = std::max(cd_error, std::abs(float4_first(cd) - aircraft_calc_drag_coeff(aircraft, aoa)));
+		}
+
+		float density_error = 0;
+		for (float altitude = 0; altitude <= (FLIGHT_ATMOSPHERE_SAMPLES - 1) * FLIGHT_ATMOSPHERE_STEP; altitude += 1) {
+			const float isa = flight_air_density_isa(altitude);
+			density_error = std::max(density_error, std::abs(float4_first(flight_air_density(-altitude)) - isa) / isa);
+		}
+
+		constexpr int LOOKUPS = 1 << 22;
+		volatile float sink = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < LOOKUPS; i++) {
+			const float aoa = -180.0f + (i % 3600) * 0.1f;
+			sink = sink + aircraft_calc_lift_coeff(aircraft, aoa) + aircraft_calc_drag_coeff(aircraft, aoa) + flight_air_density_isa(float(i % 20000));
+		}
+		const double exact_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		const float lane_offsets[4] = {0, 1, 2, 3};
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < LOOKUPS; i += 4) {
+			const Float4 lane = float(i % 3600) + float4_load(lane_offsets);
+			Float4 cl, cd;
+			flight_aero_lookup(tables, float4_clamp(lane * 0.1f - 180.0f, -180.0f, 180.0f), cl, cd);
+			sink = sink + float4_first(cl + cd + flight_air_density(-lane * 5.0f));
+		}
+		const double table_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		fmt::print("bench: aero and atmosphere tables, {} samples every {}deg, {} every {}m\n",
+			FLIGHT_AERO_SAMPLES, FLIGHT_AERO_STEP, FLIGHT_ATMOSPHERE_SAMPLES, FLIGHT_ATMOSPHERE_STEP);
+		fmt::print("  max error: Cl {:.2e}, Cd {:.2e}, density {:.2e} relative\n", cl_error, cd_error, density_error);
+		fmt::print("  exact:     {:.2f}ns per aircraft (Cl, Cd and density)\n", exact_secs * 1e9 / LOOKUPS);
+		fmt::print("  tables:    {:.2f}ns per aircraft\n", table_secs * 1e9 / LOOKUPS);
+	}
+
+	// N copies of the first aircraft spread over the start positions, kernel alone and
+	// with the gather/scatter every visible aircraft pays in aircrafts_step
+	void _simulate_bench_flight_kernel(World& world) {
+		DEF_SYSTEM
+
+		const auto& self = world.simulate;
+		const auto& start_infos = world.scenery.start_infos;
+		auto aircraft = world.aircrafts[0];
+
+		for (size_t count : {1000, 10000}) {
+			FlightStates states {};
+			for (size_t i = 0; i < count; i++) {
+				const auto index = flight_states_push(states);
+				aircraft_set_start(aircraft, start_infos[i % start_infos.size()]);
+				aircraft.translation.x += float(i / start_infos.size()) * 50;
+				aircraft.engine.speed_percent = float(i % 11) / 10;
+				aircraft_flight_state_store(aircraft, states, index);
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			for (int step = 0; step < self.bench_steps; step++) {
+				flight_states_step(states, world.settings.brake_coeff);
+			}
+			const double kernel_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			for (int step = 0; step < self.bench_steps; step++) {
+				for (size_t i = 0; i < count; i++) {
+					aircraft_flight_state_store(aircraft, states, i);
+				}
+				flight_states_step(states, world.settings.brake_coeff);
+				for (size_t i = 0; i < count; i++) {
+					aircraft_flight_state_load(aircraft, states, i);
+				}
+			}
+			const double total_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			const double sim_secs = self.bench_steps * SIM_STEP;
+			const double aircraft_steps = double(count) * self.bench_steps;
+			fmt::print("bench: {} aircrafts, {} steps\n", count, self.bench_steps);
+			fmt::print("  kernel:         {:.1f}ns per aircraft-step, {:.1f} sim-seconds per wall-second\n",
+				kernel_secs * 1e9 / aircraft_steps, sim_secs / std::max(kernel_secs, 1e-9));
+			fmt::print("  gather/scatter: {:.1f}ns per aircraft-step, {:.1f} sim-seconds per wall-second\n",
+				total_secs * 1e9 / aircraft_steps, sim_secs / std::max(total_secs, 1e-9));
+		}
+	}
+
+	// 5000 agents around a 10km radius loop, the nearest FULL_MAX FULL, against all of them FULL
+	void _simulate_bench_traffic(World& world) {
+		DEF_SYSTEM
+
+		const auto& self = world.simulate;
+		auto aircraft = world.aircrafts[0];
+
+		constexpr size_t AGENTS = 5000, FULL_MAX = 64;
+
+		mu::Vec<glm::vec3> points;
+		for (int i = 0; i < 256; i++) {
+			const float angle = i * RADIANS_MAX / 256;
+			points.push_back(glm::vec3{10000 * std::cos(angle), -1, 10000 * std::sin(angle)});
+		}
+
+		aircraft_set_start(aircraft, world.scenery.start_infos[0]);
+		FlightStates lanes {};
+		for (size_t i = 0; i < FLIGHT_LANES; i++) {
+			aircraft_flight_state_store(aircraft, lanes, flight_states_push(lanes));
+		}
+
+		auto traffic_bench = [&](size_t full_max) {
+			Traffic traffic {};
+			traffic.prototype = lanes.blocks[0];
+			traffic_route_add(traffic, points, true);
+			traffic_spawn(traffic, AGENTS, TRAFFIC_TAXI_SPEED);
+			const glm::vec3 focuses[] = {traffic.agents[0].translation};
+
+			const auto start = std::chrono::steady_clock::now();
+			for (int step = 0; step < self.bench_steps; step++) {
+				traffic_step(traffic, world.scenery.terrain, focuses, std::numeric_limits<float>::max(), full_max, world.settings.brake_coeff);
+			}
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+		const double lod_secs = traffic_bench(FULL_MAX);
+		const double full_secs = traffic_bench(AGENTS);
+
+		fmt::print("bench: traffic, {} agents, {} steps\n", AGENTS, self.bench_steps);
+		fmt::print("  {} full:  {:.3f}ms per step\n", FULL_MAX, lod_secs / self.bench_steps * 1000);
+		fmt::print("  all full: {:.3f}ms per step\n", full_secs / self.bench_steps * 1000);
+	}
+
+	// what `--bench` runs instead of flying, see Simulate::bench
+	void simulate_bench(World& world) {
+		DEF_SYSTEM
+
+		_simulate_bench_terrain(world);
+		_simulate_bench_raycast(world);
+		_simulate_bench_broadphase(world);
+		_simulate_bench_narrowphase(world);
+		_simulate_bench_animation(world);
+		_simulate_bench_aero_tables(world);
+		_simulate_bench_flight_kernel(world);
+		_simulate_bench_traffic(world);
+	}
+
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <mu/utils.h>
+
+#include "parser.h"
+
+// inputs a script can give to the first aircraft, the same a user gives to the tracked one
+enum class SimulateInput {
+	// held, value is 1 (pressed) or 0 (released)
+	STICK_RIGHT,
+	STICK_LEFT,
+	STICK_FRONT,
+	STICK_BACK,
+	RUDDER_RIGHT,
+	RUDDER_LEFT,
+	THROTTLE_INCREASE,
+	THROTTLE_DECREASE,
+
+	// one-shot, applies to one step only
+	AFTERBURNER_TOGGLE,
+	BRAKE,
+	LANDING_GEAR_TOGGLE,
+
+	// sets throttle directly to value in [0, 1]
+	THROTTLE,
+};
+
+constexpr const char* SIMULATE_INPUT_NAMES[] = {
+	"stick_right",
+	"stick_left",
+	"stick_front",
+	"stick_back",
+	"rudder_right",
+	"rudder_left",
+	"throttle_increase",
+	"throttle_decrease",
+	"afterburner_toggle",
+	"brake",
+	"landing_gear_toggle",
+	"throttle",
+};
+
+struct SimulateCommand {
+	double time; // simulation seconds
+	SimulateInput input;
+	float value;
+};
+
+struct SimulateSample {
+	double time;
+	int aircraft;
+	glm::vec3 translation, velocity;
+	glm::quat orientation;
+	float throttle, elevator, aileron, rudder;
+	float fuel; // tons
+};
+
+// `--simulate` steps the flight model as fast as possible without SDL, GL or audio,
+// driven by a script file instead of input, to fly many sorties when tuning it
+struct Simulate {
+	bool enabled;
+
+	// scenery's field is parsed and transformed without GL, for terrain heights and start positions,
+	// its meshes are never uploaded
+	mu::Str scenery_name = "SMALL_MAP";
+	mu::Vec<mu::Str> aircraft_names;
+	double duration_secs = 60;
+
+	// optional, empty means no input
+	mu::Str script_path;
+
+	// optional, empty means don't write
+	mu::Str trajectory_path;
+	// sample every nth step, default is 10Hz
+	int trajectory_every = 12;
+
+	mu::Vec<SimulateCommand> commands;
+	mu::Vec<SimulateSample> trajectory;
+
+	uint64_t steps;
+	double wall_secs;
+
+	// `--bench` times instead of flying: terrain height queries and raycasts over the scenery, broadphase,
+	// narrowphase and animation table per aircraft, aero and atmosphere tables, the flight kernel over
+	// 1k and 10k copies of the first aircraft and a step of 5000 traffic agents, the last two `bench_steps` times
+	bool bench;
+	int bench_steps = 1200;
+};
+
+// parses `--simulate` and its options, returns false and logs on invalid arguments
+inline bool simulate_parse_args(Simulate& self, int argc, char* argv[]) {
+	for (int i = 1; i < argc; i++) {
+		const auto arg = mu::StrView(argv[i]);
+		const bool has_value = i+1 < argc;
+
+		if (arg == "--simulate") {
+			self.enabled = true;
+		} else if (arg == "--bench") {
+			self.bench = true;
+		} else if (arg == "--bench-steps" && has_value) {
+			self.bench_steps = atoi(argv[++i]);
+		} else if (arg == "--scenery" && has_value) {
+			self.scenery_name = argv[++i];
+		} else if (arg == "--aircraft" && has_value) {
+			self.aircraft_names.push_back(mu::Str(argv[++i]));
+		} else if (arg == "--duration" && has_value) {
+			self.duration_secs = atof(argv[++i]);
+		} else if (arg == "--script" && has_value) {
+			self.script_path = argv[++i];
+		} else if (arg == "--trajectory" && has_value) {
+			self.trajectory_path = argv[++i];
+		} else if (arg == "--trajectory-every" && has_value) {
+			self.trajectory_every = atoi(argv[++i]);
+		}
+	}
+
+	if (self.aircraft_names.empty()) {
+		self.aircraft_names.push_back(mu::Str("YS-11"));
+	}
+
+	if (self.duration_secs <= 0 || self.trajectory_every <= 0 || self.bench_steps <= 0) {
+		mu::log_error("invalid simulate options, duration={} trajectory-every={} bench-steps={}",
+			self.duration_secs, self.trajectory_every, self.bench_steps);
+		return false;
+	}
+
+	return true;
+}
+
+// one command per line `<seconds> <input> [value]`, held inputs default to 1, `#` starts a comment line
+// 0     throttle    0.8
+// 2.5   stick_back
+// 4     stick_back  0
+// 10    landing_gear_toggle
+inline mu::Vec<SimulateCommand> simulate_script_from_str(mu::StrView str) {
+	auto parser = parser_from_str(str, mu::memory::tmp());
+
+	mu::Vec<SimulateCommand> commands;
+
+	while (parser_finished(parser) == false) {
+		while (parser_accept(parser, ' ') || parser_accept(parser, '\t')) {}
+		if (parser_accept(parser, '\n')) {
+			continue;
+		}
+		if (parser_accept(parser, '#')) {
+			parser_token_str_with(parser, [](char c) { return c != '\n'; }, mu::memory::tmp());
+			continue;
+		}
+
+		SimulateCommand command {};
+		command.time = parser_token_float(parser);
+		while (parser_accept(parser, ' ') || parser_accept(parser, '\t')) {}
+
+		const auto name = parser_token_str(parser, mu::memory::tmp());
+		bool found = false;
+		for (size_t i = 0; i < std::size(SIMULATE_INPUT_NAMES); i++) {
+			if (name == SIMULATE_INPUT_NAMES[i]) {
+				command.input = (SimulateInput) i;
+				found = true;
+				break;
+			}
+		}
+		if (found == false) {
+			parser_panic(parser, "unknown input '{}'", name);
+		}
+
+		command.value = 1;
+		while (parser_accept(parser, ' ') || parser_accept(parser, '\t')) {}
+		if (parser_finished(parser) == false && parser_peek(parser, '\n') == false) {
+			command.value = parser_token_float(parser);
+		}
+		while (parser_accept(parser, ' ') || parser_accept(parser, '\t')) {}
+		if (parser_finished(parser) == false) {
+			parser_expect(parser, '\n');
+		}
+
+		if (commands.empty() == false && command.time < commands.back().time) {
+			parser_panic(parser, "commands must be ordered by time, {} comes after {}", command.time, commands.back().time);
+		}
+		commands.push_back(command);
+	}
+
+	return commands;
+}
+
+inline mu::Vec<SimulateCommand> simulate_script_from_file(mu::StrView file_path) {
+	const auto str = mu::file_content_str(file_path.data(), mu::memory::tmp());
+	return simulate_script_from_str(str);
+}
+
+inline void test_simulate_script() {
+	mu_test_suite("test_simulate_script");
+
+	{
+		const auto commands = simulate_script_from_str("");
+		mu_test(commands.empty());
+	}
+
+	{
+		const auto commands = simulate_script_from_str(
+			"# takeoff\n"
+			"0 throttle 0.8\n"
+			"\n"
+			"2.5\tstick_back\n"
+			"4 stick_back 0\n"
+			"10 landing_gear_toggle\n"
+			"# end"
+		);
+		mu_test(commands.size() == 4);
+		mu_test(commands[0].time == 0 && commands[0].input == SimulateInput::THROTTLE && commands[0].value == 0.8f);
+		mu_test(commands[1].time == 2.5 && commands[1].input == SimulateInput::STICK_BACK && commands[1].value == 1);
+		mu_test(commands[2].time == 4 && commands[2].input == SimulateInput::STICK_BACK && commands[2].value == 0);
+		mu_test(commands[3].time == 10 && commands[3].input == SimulateInput::LANDING_GEAR_TOGGLE);
+	}
+}
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <cstdio>
 #include <chrono>
 #include <algorithm>
+#include <mutex>
 
+#include <glad/glad.h>
 #include <mu/utils.h>
 
 struct SysInfo {
@@ -11,50 +14,167 @@ struct SysInfo {
 	bool enabled;
 	uint64_t latency_micros, latency_micros_min, latency_micros_max, latency_micros_avg;
 	uint64_t num_calls;
+
+	// only for systems defined with DEF_GPU_SYSTEM, time GPU spent on their commands
+	bool gpu_timed;
+	uint64_t gpu_latency_micros, gpu_latency_micros_min, gpu_latency_micros_max, gpu_latency_micros_avg;
+	uint64_t gpu_num_samples;
+
+	// GL_TIME_ELAPSED queries used on alternating calls, result of a query is read
+	// two calls later when the GPU is already done with it, so we never stall
+	GLuint _gpu_queries[2];
+	bool _gpu_query_pending[2];
+	uint8_t _gpu_query_index;
+	bool _gpu_query_active;
 };
 
+// systems are registered on first call from simulation and render threads, so `systems` never reallocates
+// and each SysInfo is only updated by the thread that runs its system
+constexpr size_t SYSMON_SYSTEMS_MAX = 256;
+
 // systems performance monitor
 struct SysMon {
+	std::mutex mutex;
 	mu::Vec<SysInfo> systems;
 };
 
-#ifdef DEBUG
-	// called once per system
-	inline int _sysmon_register_system(SysMon& self, mu::StrView&& system_name) {
-		self.systems.push_back(SysInfo {
-			.name = mu::Str(system_name),
-			.enabled = true,
-			.latency_micros_min = UINT64_MAX,
-			.latency_micros_max = 0,
-		});
-		return self.systems.size()-1;
+inline void sysmon_free(SysMon& self) {
+	for (auto& sysinfo : self.systems) {
+		if (sysinfo.gpu_timed) {
+			glDeleteQueries(2, sysinfo._gpu_queries);
+			sysinfo.gpu_timed = false;
+		}
 	}
+}
 
-	inline void _sysinfo_update(SysInfo& self, auto start_time) {
-		self.latency_micros = std::chrono::duration_cast<std::chrono::microseconds>(
-			std::chrono::high_resolution_clock::now() - start_time
-		).count();
+// one row per system, gpu columns are empty for systems that aren't gpu timed
+inline bool sysmon_export_csv(const SysMon& self, const char* file_path) {
+	FILE* f = fopen(file_path, "w");
+	if (f == nullptr) {
+		return false;
+	}
+	mu_defer(fclose(f));
+
+	fmt::print(f, "system,enabled,num_calls,cpu_micros_last,cpu_micros_avg,cpu_micros_min,cpu_micros_max,gpu_micros_last,gpu_micros_avg,gpu_micros_min,gpu_micros_max\n");
+	for (const auto& sysinfo : self.systems) {
+		fmt::print(f, "{},{},{},{},{},{},{},", sysinfo.name, sysinfo.enabled, sysinfo.num_calls,
+			sysinfo.latency_micros, sysinfo.latency_micros_avg, sysinfo.latency_micros_min, sysinfo.latency_micros_max);
+		if (sysinfo.gpu_timed && sysinfo.gpu_num_samples > 0) {
+			fmt::print(f, "{},{},{},{}\n", sysinfo.gpu_latency_micros, sysinfo.gpu_latency_micros_avg,
+				sysinfo.gpu_latency_micros_min, sysinfo.gpu_latency_micros_max);
+		} else {
+			fmt::print(f, ",,,\n");
+		}
+	}
 
-		self.latency_micros_avg = double(self.num_calls * self.latency_micros_avg + self.latency_micros) / (self.num_calls+1);
-		self.num_calls++;
+	return true;
+}
 
-		self.latency_micros_max = std::max(self.latency_micros, self.latency_micros_max);
-		self.latency_micros_min = std::min(self.latency_micros, self.latency_micros_min);
+// called once per system
+inline int _sysmon_register_system(SysMon& self, mu::StrView&& system_name) {
+	std::lock_guard lock(self.mutex);
+	if (self.systems.capacity() == 0) {
+		self.systems.reserve(SYSMON_SYSTEMS_MAX);
 	}
+	mu_assert(self.systems.size() < SYSMON_SYSTEMS_MAX);
+
+	self.systems.push_back(SysInfo {
+		.name = mu::Str(system_name),
+		.enabled = true,
+		.latency_micros_min = UINT64_MAX,
+		.latency_micros_max = 0,
+		.gpu_latency_micros_min = UINT64_MAX,
+	});
+	return self.systems.size()-1;
+}
+
+inline void _sysinfo_update(SysInfo& self, auto start_time) {
+	self.latency_micros = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::high_resolution_clock::now() - start_time
+	).count();
+
+	self.latency_micros_avg = double(self.num_calls * self.latency_micros_avg + self.latency_micros) / (self.num_calls+1);
+	self.num_calls++;
+
+	self.latency_micros_max = std::max(self.latency_micros, self.latency_micros_max);
+	self.latency_micros_min = std::min(self.latency_micros, self.latency_micros_min);
+}
+
+inline void _sysinfo_gpu_update(SysInfo& self, uint64_t latency_micros) {
+	self.gpu_latency_micros = latency_micros;
+
+	self.gpu_latency_micros_avg = double(self.gpu_num_samples * self.gpu_latency_micros_avg + self.gpu_latency_micros) / (self.gpu_num_samples+1);
+	self.gpu_num_samples++;
+
+	self.gpu_latency_micros_max = std::max(self.gpu_latency_micros, self.gpu_latency_micros_max);
+	self.gpu_latency_micros_min = std::min(self.gpu_latency_micros, self.gpu_latency_micros_min);
+}
 
-	#ifndef __FUNCTION_NAME__
-		#ifdef WIN32   // WINDOWS
-			#define __FUNCTION_NAME__   __FUNCTION__
-		#else          // OTHER
-			#define __FUNCTION_NAME__   __func__
-		#endif
+inline void _sysinfo_gpu_begin(SysInfo& self) {
+	if (self.gpu_timed == false) {
+		glGenQueries(2, self._gpu_queries);
+		self.gpu_timed = true;
+	}
+
+	const uint8_t i = self._gpu_query_index;
+	if (self._gpu_query_pending[i]) {
+		GLint available = 0;
+		glGetQueryObjectiv(self._gpu_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			// GPU is more than a frame behind, skip this sample instead of waiting
+			return;
+		}
+
+		GLuint64 nanos = 0;
+		glGetQueryObjectui64v(self._gpu_queries[i], GL_QUERY_RESULT, &nanos);
+		_sysinfo_gpu_update(self, nanos / 1000);
+		self._gpu_query_pending[i] = false;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, self._gpu_queries[i]);
+	self._gpu_query_active = true;
+}
+
+inline void _sysinfo_gpu_end(SysInfo& self) {
+	if (self._gpu_query_active == false) {
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	self._gpu_query_active = false;
+	self._gpu_query_pending[self._gpu_query_index] = true;
+	self._gpu_query_index ^= 1;
+}
+
+inline void _sysinfo_gpu_system_update(SysInfo& self, auto start_time) {
+	_sysinfo_gpu_end(self);
+	_sysinfo_update(self, start_time);
+}
+
+#ifndef __FUNCTION_NAME__
+	#ifdef WIN32   // WINDOWS
+		#define __FUNCTION_NAME__   __FUNCTION__
+	#else          // OTHER
+		#define __FUNCTION_NAME__   __func__
 	#endif
+#endif
+
+// same as DEF_SYSTEM, and also measures GPU time of GL commands issued by the system
+// GL_TIME_ELAPSED queries can't nest, so don't call a gpu system from another one
+// defined in all builds, render passes are few and benchmarks run release builds
+#define DEF_GPU_SYSTEM																				\
+	static const auto __sysmon_index = _sysmon_register_system(world.sysmon, __FUNCTION_NAME__);	\
+	if (world.sysmon.systems[__sysmon_index].enabled == false) { return; }							\
+	const auto __sysmon_start = std::chrono::high_resolution_clock::now();							\
+	_sysinfo_gpu_begin(world.sysmon.systems[__sysmon_index]);										\
+	mu_defer(_sysinfo_gpu_system_update(world.sysmon.systems[__sysmon_index], __sysmon_start));
 
+#ifdef DEBUG
 	#define DEF_SYSTEM																					\
 		static const auto __sysmon_index = _sysmon_register_system(world.sysmon, __FUNCTION_NAME__);	\
 		if (world.sysmon.systems[__sysmon_index].enabled == false) { return; }							\
 		const auto __sysmon_start = std::chrono::high_resolution_clock::now();							\
 		mu_defer(_sysinfo_update(world.sysmon.systems[__sysmon_index], __sysmon_start));
 #else
-	#define DEF_SYSTEM(_) void();
+	#define DEF_SYSTEM
 #endif
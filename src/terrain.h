@@ -0,0 +1,422 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <limits>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <mu/utils.h>
+
+#include "assets.h"
+
+// cells of the grid over all patches, fewer on each side for small sceneries
+constexpr uint32_t TERRAIN_GRID_CELLS_MAX = 256;
+constexpr float TERRAIN_GRID_CELL_SIZE_MIN = 16; // m
+
+// most samples terrain_time_of_impact takes along a segment, longer ones take bigger steps
+constexpr uint32_t TERRAIN_TIME_OF_IMPACT_STEPS_MAX = 1024;
+
+// ground at (x,z), -y is up like everywhere else
+struct TerrainSample {
+	float y;           // world y of the ground
+	glm::vec3 normal;  // world, points up (y < 0)
+};
+
+// no terrain under the point, the same plane physics had before terrain
+constexpr TerrainSample TERRAIN_SAMPLE_PLANE { .y = 0, .normal = {0, -1, 0} };
+
+// one TerrMesh in world space, heights and orientations are copied so the field can be edited or freed
+struct TerrainPatch {
+	glm::mat4 world_to_local;
+	glm::mat3 local_to_world_rotation;
+	glm::vec3 up_local;      // world +y in patch space, only y != 0 unless field or terrain is rolled/pitched
+	bool tilted;
+	glm::vec2 scale;         // x,z size of a block
+	uint32_t blocks_x, blocks_z;
+	uint32_t heights_offset; // (blocks_z+1) rows of (blocks_x+1) heights in Terrain::heights
+	uint32_t orientations_offset; // blocks_z rows of blocks_x in Terrain::orientations
+};
+
+// height and normal of all TerrMesh of a scenery at any (x,z), in O(1)
+// uniform grid over world XZ, each cell lists patches overlapping it (mostly 0 or 1)
+struct Terrain {
+	mu::Vec<TerrainPatch> patches;
+	mu::Vec<float> heights;
+	mu::Vec<uint8_t> orientations; // Block::RIGHT or Block::LEFT
+
+	glm::vec2 grid_min;
+	float cell_size_inv;
+	uint32_t grid_x, grid_z;
+	mu::Vec<uint32_t> cells_first; // grid_x*grid_z + 1, patches of cell i are cells_patches[cells_first[i]:cells_first[i+1]]
+	mu::Vec<uint32_t> cells_patches;
+
+	// smallest block side of all patches, ground is planar within a block
+	float block_size_min = std::numeric_limits<float>::max();
+};
+
+inline void terrain_clear(Terrain& self) {
+	self.patches.clear();
+	self.heights.clear();
+	self.orientations.clear();
+	self.cells_first.clear();
+	self.cells_patches.clear();
+	self.grid_x = self.grid_z = 0;
+	self.block_size_min = std::numeric_limits<float>::max();
+}
+
+// `model_transformation` is what terrain is rendered with (field and terrain translation/rotation)
+inline void terrain_patch_add(Terrain& self, const TerrMesh& terr_mesh, const glm::mat4& model_transformation) {
+	if (terr_mesh.blocks.empty() || terr_mesh.blocks[0].empty()) {
+		return;
+	}
+
+	const auto up_local = glm::mat3(glm::inverse(model_transformation)) * glm::vec3{0, 1, 0};
+	TerrainPatch patch {
+		.world_to_local = glm::inverse(model_transformation),
+		.local_to_world_rotation = glm::mat3(model_transformation),
+		.up_local = up_local,
+		.tilted = std::abs(up_local.x) > 1e-6f || std::abs(up_local.z) > 1e-6f,
+		.scale = terr_mesh.scale,
+		.blocks_x = (uint32_t) terr_mesh.blocks[0].size(),
+		.blocks_z = (uint32_t) terr_mesh.blocks.size(),
+		.heights_offset = (uint32_t) self.heights.size(),
+		.orientations_offset = (uint32_t) self.orientations.size(),
+	};
+
+	for (const auto& row : terr_mesh.nodes_height) {
+		for (float h : row) {
+			self.heights.push_back(h);
+		}
+	}
+	for (const auto& row : terr_mesh.blocks) {
+		for (const auto& block : row) {
+			self.orientations.push_back(block.orientation);
+		}
+	}
+
+	self.patches.push_back(patch);
+	self.block_size_min = std::min(self.block_size_min, std::min(patch.scale.x, patch.scale.y));
+}
+
+// XZ bounds of patch in world, from corners of its box
+inline void _terrain_patch_bounds(const Terrain& self, const TerrainPatch& patch, glm::vec2& min, glm::vec2& max) {
+	float h_min = std::numeric_limits<float>::max(), h_max = std::numeric_limits<float>::lowest();
+	const size_t heights_count = size_t(patch.blocks_x + 1) * (patch.blocks_z + 1);
+	for (size_t i = 0; i < heights_count; i++) {
+		h_min = std::min(h_min, self.heights[patch.heights_offset + i]);
+		h_max = std::max(h_max, self.heights[patch.heights_offset + i]);
+	}
+
+	const auto local_to_world = glm::inverse(patch.world_to_local);
+	min = glm::vec2{std::numeric_limits<float>::max()};
+	max = glm::vec2{std::numeric_limits<float>::lowest()};
+	for (int i = 0; i < 8; i++) {
+		const glm::vec4 corner {
+			(i & 1)? patch.blocks_x * patch.scale.x : 0,
+			(i & 2)? -h_max : -h_min,
+			(i & 4)? patch.blocks_z * patch.scale.y : 0,
+			1,
+		};
+		const auto world = local_to_world * corner;
+		min = glm::min(min, glm::vec2{world.x, world.z});
+		max = glm::max(max, glm::vec2{world.x, world.z});
+	}
+}
+
+// after adding all patches
+inline void terrain_grid_build(Terrain& self) {
+	self.cells_first.clear();
+	self.cells_patches.clear();
+	self.grid_x = self.grid_z = 0;
+	if (self.patches.empty()) {
+		return;
+	}
+
+	auto patches_min = mu::Vec<glm::vec2>(mu::memory::tmp());
+	auto patches_max = mu::Vec<glm::vec2>(mu::memory::tmp());
+	glm::vec2 min {std::numeric_limits<float>::max()}, max {std::numeric_limits<float>::lowest()};
+	for (const auto& patch : self.patches) {
+		glm::vec2 patch_min, patch_max;
+		_terrain_patch_bounds(self, patch, patch_min, patch_max);
+		patches_min.push_back(patch_min);
+		patches_max.push_back(patch_max);
+		min = glm::min(min, patch_min);
+		max = glm::max(max, patch_max);
+	}
+
+	const auto extent = max - min;
+	const float cell_size = std::max(std::max(extent.x, extent.y) / TERRAIN_GRID_CELLS_MAX, TERRAIN_GRID_CELL_SIZE_MIN);
+	self.grid_min = min;
+	self.cell_size_inv = 1.0f / cell_size;
+	self.grid_x = std::min((uint32_t) (extent.x / cell_size) + 1, TERRAIN_GRID_CELLS_MAX);
+	self.grid_z = std::min((uint32_t) (extent.y / cell_size) + 1, TERRAIN_GRID_CELLS_MAX);
+
+	auto cells_of = [&](size_t patch, uint32_t& x0, uint32_t& z0, uint32_t& x1, uint32_t& z1) {
+		const auto lo = (patches_min[patch] - min) * self.cell_size_inv;
+		const auto hi = (patches_max[patch] - min) * self.cell_size_inv;
+		x0 = std::min((uint32_t) lo.x, self.grid_x - 1); x1 = std::min((uint32_t) hi.x, self.grid_x - 1);
+		z0 = std::min((uint32_t) lo.y, self.grid_z - 1); z1 = std::min((uint32_t) hi.y, self.grid_z - 1);
+	};
+
+	// count, prefix sum, fill
+	self.cells_first.resize(size_t(self.grid_x) * self.grid_z + 1, 0);
+	for (size_t i = 0; i < self.patches.size(); i++) {
+		uint32_t x0, z0, x1, z1;
+		cells_of(i, x0, z0, x1, z1);
+		for (uint32_t z = z0; z <= z1; z++) {
+			for (uint32_t x = x0; x <= x1; x++) {
+				self.cells_first[z * self.grid_x + x + 1]++;
+			}
+		}
+	}
+	for (size_t i = 1; i < self.cells_first.size(); i++) {
+		self.cells_first[i] += self.cells_first[i-1];
+	}
+
+	self.cells_patches.resize(self.cells_first.back());
+	auto cells_filled = mu::Vec<uint32_t>(self.cells_first.begin(), self.cells_first.end() - 1, mu::memory::tmp());
+	for (size_t i = 0; i < self.patches.size(); i++) {
+		uint32_t x0, z0, x1, z1;
+		cells_of(i, x0, z0, x1, z1);
+		for (uint32_t z = z0; z <= z1; z++) {
+			for (uint32_t x = x0; x <= x1; x++) {
+				self.cells_patches[cells_filled[z * self.grid_x + x]++] = (uint32_t) i;
+			}
+		}
+	}
+}
+
+// local y (-height) of patch at local (x,z) and its slopes, false outside the patch
+inline bool _terrain_patch_height(const Terrain& self, const TerrainPatch& patch, float x, float z, float& y, float& dy_dx, float& dy_dz) {
+	const float u = x / patch.scale.x;
+	const float v = z / patch.scale.y;
+	if (!(u >= 0 && v >= 0 && u < patch.blocks_x && v < patch.blocks_z)) {
+		return false;
+	}
+
+	const uint32_t bx = (uint32_t) u, bz = (uint32_t) v;
+	const float fx = u - bx, fz = v - bz;
+	const float* row0 = &self.heights[patch.heights_offset + bz * (patch.blocks_x + 1) + bx];
+	const float* row1 = row0 + patch.blocks_x + 1;
+	const float h00 = row0[0], h10 = row0[1], h01 = row1[0], h11 = row1[1];
+
+	// same triangles terr_mesh_vertices makes, RIGHT splits block (0,0)-(1,1), LEFT (1,0)-(0,1)
+	float h, dh_du, dh_dv;
+	if (self.orientations[patch.orientations_offset + bz * patch.blocks_x + bx] == Block::RIGHT) {
+		if (fz >= fx) {
+			dh_du = h11 - h01; dh_dv = h01 - h00;
+		} else {
+			dh_du = h10 - h00; dh_dv = h11 - h10;
+		}
+		h = h00 + dh_du * fx + dh_dv * fz;
+	} else {
+		if (fx + fz >= 1) {
+			dh_du = h11 - h01; dh_dv = h11 - h10;
+			h = h11 - dh_du * (1 - fx) - dh_dv * (1 - fz);
+		} else {
+			dh_du = h10 - h00; dh_dv = h01 - h00;
+			h = h00 + dh_du * fx + dh_dv * fz;
+		}
+	}
+
+	y = -h;
+	dy_dx = -dh_du / patch.scale.x;
+	dy_dz = -dh_dv / patch.scale.y;
+	return true;
+}
+
+// where world vertical line at (x,z) crosses patch, false if it doesn't
+inline bool _terrain_patch_sample(const Terrain& self, const TerrainPatch& patch, float x, float z, TerrainSample& sample) {
+	if (std::abs(patch.up_local.y) < 1e-3f) {
+		return false;
+	}
+
+	// line is origin + t * up_local in patch space, t is world y
+	const auto origin = glm::vec3(patch.world_to_local * glm::vec4{x, 0, z, 1});
+	auto p = origin;
+	float y, dy_dx, dy_dz, t = 0;
+
+	// exact on first iteration unless tilted, where line's local (x,z) moves with height
+	const int iterations = patch.tilted? 3 : 1;
+	for (int i = 0; i < iterations; i++) {
+		if (_terrain_patch_height(self, patch, p.x, p.z, y, dy_dx, dy_dz) == false) {
+			return false;
+		}
+		t = (y - origin.y) / patch.up_local.y;
+		p = origin + t * patch.up_local;
+	}
+
+	sample.y = t;
+	sample.normal = glm::normalize(patch.local_to_world_rotation * glm::vec3{dy_dx, -1, dy_dz});
+	return true;
+}
+
+// highest ground at (x,z), TERRAIN_SAMPLE_PLANE where there's no terrain
+inline TerrainSample terrain_sample(const Terrain& self, float x, float z) {
+	TerrainSample best = TERRAIN_SAMPLE_PLANE;
+	if (self.grid_x == 0) {
+		return best;
+	}
+
+	const float cx = (x - self.grid_min.x) * self.cell_size_inv;
+	const float cz = (z - self.grid_min.y) * self.cell_size_inv;
+	if (!(cx >= 0 && cz >= 0 && cx < self.grid_x && cz < self.grid_z)) {
+		return best;
+	}
+
+	const uint32_t cell = (uint32_t) cz * self.grid_x + (uint32_t) cx;
+	bool found = false;
+	for (uint32_t i = self.cells_first[cell]; i < self.cells_first[cell+1]; i++) {
+		TerrainSample sample;
+		if (_terrain_patch_sample(self, self.patches[self.cells_patches[i]], x, z, sample) && (found == false || sample.y < best.y)) {
+			best = sample;
+			found = true;
+		}
+	}
+	return best;
+}
+
+// many points at once (gear contacts, vehicles), `samples[i]` is ground at `points[i]` (x,z)
+inline void terrain_sample_batch(const Terrain& self, std::span<const glm::vec2> points, std::span<TerrainSample> samples) {
+	mu_assert(points.size() == samples.size());
+
+	for (size_t i = 0; i < points.size(); i++) {
+		samples[i] = terrain_sample(self, points[i].x, points[i].y);
+	}
+}
+
+// first point of segment from->to under the ground, as fraction `t` of the way, false if it stays above
+// samples every half block so ridges between its ends aren't missed, then bisects the step that went under
+inline bool terrain_time_of_impact(const Terrain& self, const glm::vec3& from, const glm::vec3& to, float& t) {
+	auto under_ground = [&](float s) {
+		const auto p = glm::mix(from, to, s);
+		return p.y > terrain_sample(self, p.x, p.z).y;
+	};
+
+	if (under_ground(0)) {
+		t = 0;
+		return true;
+	}
+
+	const float horizontal = glm::length(glm::vec2{to.x - from.x, to.z - from.z});
+	const float steps = std::clamp(std::ceil(horizontal / (self.block_size_min * 0.5f)), 1.0f, (float) TERRAIN_TIME_OF_IMPACT_STEPS_MAX);
+	float above = 0;
+	for (uint32_t i = 1; i <= (uint32_t) steps; i++) {
+		float under = i / steps;
+		if (under_ground(under) == false) {
+			above = under;
+			continue;
+		}
+
+		for (int j = 0; j < 16; j++) {
+			const float mid = (above + under) * 0.5f;
+			if (under_ground(mid)) {
+				under = mid;
+			} else {
+				above = mid;
+			}
+		}
+		t = under;
+		return true;
+	}
+	return false;
+}
+
+inline void test_terrain() {
+	mu_test_suite("terrain");
+
+	auto approx = [](float a, float b) { return std::abs(a - b) < 1e-3f; };
+
+	// 2x2 blocks of 10x20m, one block of each orientation per row
+	TerrMesh terr_mesh {};
+	terr_mesh.scale = {10, 20};
+	terr_mesh.blocks.resize(2);
+	for (auto& row : terr_mesh.blocks) {
+		row.resize(2);
+		row[0].orientation = Block::RIGHT;
+		row[1].orientation = Block::LEFT;
+	}
+	terr_mesh.nodes_height = {{0, 10, 20}, {5, 15, 5}, {0, 0, 0}};
+
+	Terrain terrain {};
+
+	{
+		terrain_patch_add(terrain, terr_mesh, glm::mat4{1.0f});
+		terrain_grid_build(terrain);
+
+		// nodes
+		mu_test(approx(terrain_sample(terrain, 0, 0).y, 0));
+		mu_test(approx(terrain_sample(terrain, 10, 0).y, -10));
+		mu_test(approx(terrain_sample(terrain, 10, 20).y, -15));
+		mu_test(approx(terrain_sample(terrain, 19.9999f, 20).y, -5));
+
+		// RIGHT block, both triangles
+		mu_test(approx(terrain_sample(terrain, 2.5f, 15).y, -(0 + (15 - 5) * 0.25f + (5 - 0) * 0.75f)));
+		mu_test(approx(terrain_sample(terrain, 7.5f, 5).y, -(0 + (10 - 0) * 0.75f + (15 - 10) * 0.25f)));
+
+		// LEFT block, both triangles
+		mu_test(approx(terrain_sample(terrain, 12.5f, 5).y, -(10 + (20 - 10) * 0.25f + (15 - 10) * 0.25f)));
+		mu_test(approx(terrain_sample(terrain, 17.5f, 15).y, -(5 - (5 - 15) * 0.25f - (5 - 20) * 0.25f)));
+
+		// normal leans away from higher ground
+		const auto sloped = terrain_sample(terrain, 7.5f, 5);
+		mu_test(sloped.normal.x < 0 && sloped.normal.y < 0 && sloped.normal.z < 0);
+		mu_test(approx(glm::length(sloped.normal), 1));
+
+		// outside is plane
+		mu_test(terrain_sample(terrain, -1, 5).y == TERRAIN_SAMPLE_PLANE.y);
+		mu_test(terrain_sample(terrain, 5, 41).y == TERRAIN_SAMPLE_PLANE.y);
+		mu_test(terrain_sample(terrain, 1e6f, -1e6f).y == TERRAIN_SAMPLE_PLANE.y);
+	}
+
+	// moved and yawed patch, highest of overlapping patches
+	{
+		const auto model = glm::rotate(glm::translate(glm::mat4{1.0f}, glm::vec3{1000, -50, 0}), RADIANS_MAX / 4, glm::vec3{0, 1, 0});
+		terrain_patch_add(terrain, terr_mesh, model);
+		const auto raised = glm::translate(glm::mat4{1.0f}, glm::vec3{0, -100, 0});
+		terrain_patch_add(terrain, terr_mesh, raised);
+		terrain_grid_build(terrain);
+
+		const auto local = glm::vec4{10, -15, 20, 1};
+		const auto world = model * local;
+		mu_test(approx(terrain_sample(terrain, world.x, world.z).y, world.y));
+		mu_test(approx(terrain_sample(terrain, 10, 20).y, -115));
+	}
+
+	// batch is the same as one at a time
+	{
+		const glm::vec2 points[] = {{2.5f, 15}, {12.5f, 5}, {-100, 0}, {10, 20}};
+		TerrainSample samples[4];
+		terrain_sample_batch(terrain, points, samples);
+
+		bool same = true;
+		for (int i = 0; i < 4; i++) {
+			same = same && samples[i].y == terrain_sample(terrain, points[i].x, points[i].y).y;
+		}
+		mu_test(same);
+	}
+
+	// segments through a ridge whose ends are both above ground
+	{
+		Terrain ridge {};
+		TerrMesh ridge_mesh {};
+		ridge_mesh.scale = {10, 10};
+		ridge_mesh.blocks.resize(1);
+		ridge_mesh.blocks[0].resize(4);
+		ridge_mesh.nodes_height = {{0, 0, 50, 0, 0}, {0, 0, 50, 0, 0}};
+		terrain_patch_add(ridge, ridge_mesh, glm::mat4{1.0f});
+		terrain_grid_build(ridge);
+
+		float t = -1;
+		mu_test(terrain_time_of_impact(ridge, {1, -20, 5}, {39, -20, 5}, t));
+		// ridge is 20m high at x=14 and x=26
+		mu_test(std::abs(t - (14.0f - 1) / 38) < 1e-3f);
+		mu_test(terrain_time_of_impact(ridge, {1, -60, 5}, {39, -60, 5}, t) == false);
+		mu_test(terrain_time_of_impact(ridge, {-100, -1, 5}, {-50, 1, 5}, t) && std::abs(t - 0.5f) < 1e-3f);
+		mu_test(terrain_time_of_impact(ridge, {1, 1, 5}, {1, -5, 5}, t) && t == 0);
+	}
+}
@@ -0,0 +1,171 @@
+#include <cmath>
+#include <algorithm>
+
+#include "world.h"
+
+namespace sys {
+
+	void textures_init(World& world) {
+		DEF_SYSTEM
+
+		glGenBuffers(1, &world.textures.pbo);
+	}
+
+	void textures_free(World& world) {
+		DEF_SYSTEM
+
+		textures_clear(world.textures);
+		glDeleteBuffers(1, &world.textures.pbo);
+	}
+
+	// all requested textures are decoded, group them by size and filters into new arrays with exact layer counts
+	void _textures_arrays_alloc(World& world, mu::Vec<TextureDecoded>&& decoded) {
+		DEF_SYSTEM
+
+		auto& self = world.textures;
+
+		// layers of earlier arrays are already uploaded and their sizes are fixed, a later batch gets arrays of its own
+		const size_t first_new_array = self.arrays.size();
+
+		for (auto& d : decoded) {
+			if (d.error.empty() == false) {
+				mu::log_warning("{}", d.error);
+				continue;
+			}
+			auto& texture = self.list[d.handle];
+
+			size_t array_index = first_new_array;
+			while (array_index < self.arrays.size()) {
+				const auto& array = self.arrays[array_index];
+				if (array.width == d.width && array.height == d.height
+					&& array.filter_min == texture.filter_min && array.filter_mag == texture.filter_mag) {
+					break;
+				}
+				array_index++;
+			}
+			if (array_index == self.arrays.size()) {
+				TextureArray array {
+					.width = d.width,
+					.height = d.height,
+					.filter_min = texture.filter_min,
+					.filter_mag = texture.filter_mag,
+				};
+				glGenTextures(1, &array.id);
+				self.arrays.push_back(array);
+			}
+
+			texture.ref = TextureRef {
+				.array = self.arrays[array_index].id,
+				.layer = self.arrays[array_index].num_layers++,
+			};
+			self.uploads.push_back(std::move(d));
+		}
+
+		for (size_t i = first_new_array; i < self.arrays.size(); i++) {
+			const auto& array = self.arrays[i];
+			const int num_levels = int(std::floor(std::log2(std::max(array.width, array.height)))) + 1;
+
+			gl_state_bind_texture(0, GL_TEXTURE_2D_ARRAY, array.id);
+				for (int level = 0; level < num_levels; level++) {
+					glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8,
+						std::max(1, array.width >> level), std::max(1, array.height >> level), array.num_layers,
+						0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+				}
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, num_levels-1);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, _textures_filter_min_mipmapped(array.filter_min));
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, array.filter_mag);
+			gl_state_bind_texture(0, GL_TEXTURE_2D_ARRAY, 0);
+
+			mu::log_debug("texture array {}x{} with {} layers", array.width, array.height, array.num_layers);
+		}
+	}
+
+	// uploads decoded textures within per frame budget, a texture becomes ready when its whole array is uploaded
+	void textures_update(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.textures;
+		self.last_frame = {};
+
+		mu::Vec<TextureDecoded> decoded;
+		{
+			std::lock_guard lock(self.mutex);
+			const bool all_decoded = self.decoded.size() == self.num_requested;
+			if (all_decoded && self.decoded.empty() == false) {
+				decoded = std::move(self.decoded);
+				self.decoded = {};
+				self.num_requested = 0;
+			}
+		}
+		if (decoded.empty() == false) {
+			_textures_arrays_alloc(world, std::move(decoded));
+		}
+
+		if (self.uploads_cursor == self.uploads.size()) {
+			return;
+		}
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, self.pbo);
+
+		bool some_array_completed = false;
+		while (self.uploads_cursor < self.uploads.size() && self.last_frame.bytes_uploaded < TEXTURES_UPLOAD_BUDGET_BYTES) {
+			auto& upload = self.uploads[self.uploads_cursor++];
+			const auto& texture = self.list[upload.handle];
+
+			TextureArray* array = nullptr;
+			for (auto& a : self.arrays) {
+				if (a.id == texture.ref.array) {
+					array = &a;
+					break;
+				}
+			}
+			mu_assert(array);
+
+			// orphan so we don't wait for GPU to finish reading previous upload
+			const size_t size = upload.pixels.size();
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+			void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			gl_state_bind_texture(0, GL_TEXTURE_2D_ARRAY, array->id);
+			if (dst) {
+				memcpy(dst, upload.pixels.data(), size);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+				// copy from bound PBO, returns before texels reach the texture
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, texture.ref.layer, upload.width, upload.height, 1,
+					GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			} else {
+				// driver couldn't map it, copy from client memory instead, blocks till GL has read it
+				mu::log_warning("failed to map texture upload buffer of {} bytes, uploading from client memory", size);
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, texture.ref.layer, upload.width, upload.height, 1,
+					GL_RGBA, GL_UNSIGNED_BYTE, upload.pixels.data());
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, self.pbo);
+			}
+
+			upload.pixels = {};
+			array->num_uploaded++;
+			self.last_frame.bytes_uploaded += size;
+			self.last_frame.uploads++;
+
+			if (array->num_uploaded == array->num_layers) {
+				glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+				for (auto& t : self.list) {
+					if (t.ref.array == array->id) {
+						t.ready = true;
+					}
+				}
+				some_array_completed = true;
+			}
+		}
+
+		gl_state_bind_texture(0, GL_TEXTURE_2D_ARRAY, 0);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		if (some_array_completed) {
+			self.generation++;
+		}
+	}
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring> // memcpy
+#include <mutex>
+
+#include <glad/glad.h>
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include <mu/utils.h>
+
+#include "workers.h"
+
+// max bytes of texels copied to GPU per frame, rest of uploads continue next frames
+constexpr size_t TEXTURES_UPLOAD_BUDGET_BYTES = 4 << 20;
+
+// index in Textures::list
+using TextureHandle = uint32_t;
+
+// where a texture lives on GPU, layer of a GL_TEXTURE_2D_ARRAY
+struct TextureRef {
+	GLuint array; // 0 while texture isn't ready
+	GLint layer;
+};
+
+struct Texture {
+	mu::Str name;
+	GLenum filter_min, filter_mag;
+
+	// set on upload, but only valid after `ready`, which is after mipmaps of whole array are generated
+	TextureRef ref;
+	bool ready;
+};
+
+// textures of same size and filters share one array, so draws using any of them can be batched
+struct TextureArray {
+	GLuint id;
+	int width, height;
+	GLenum filter_min, filter_mag;
+	int num_layers, num_uploaded;
+};
+
+struct TextureDecoded {
+	TextureHandle handle;
+	int width, height;
+	mu::Vec<uint8_t> pixels; // RGBA8, tightly packed rows, empty if decoding failed
+	mu::Str error; // logged from main thread, logger isn't thread safe
+};
+
+// decodes textures on job threads, and uploads them over frames through a pixel buffer object
+// arrays are made only once all requested textures are decoded, so each is allocated with its exact layer count
+struct Textures {
+	mu::Vec<Texture> list;
+	mu::Vec<TextureArray> arrays;
+
+	// increments on clear, decodes finishing for older epoch are dropped
+	uint32_t epoch;
+
+	std::mutex mutex;
+	mu::Vec<TextureDecoded> decoded; // guarded by mutex
+	size_t num_requested; // not yet moved to uploads
+
+	// decoded textures assigned to arrays layers waiting for upload
+	mu::Vec<TextureDecoded> uploads;
+	size_t uploads_cursor;
+	GLuint pbo;
+
+	// increments each time some textures become ready, users of TextureRef rebuild when it changes
+	uint64_t generation;
+
+	struct Stats {
+		size_t bytes_uploaded;
+		size_t uploads;
+	} last_frame;
+};
+
+// texture stays not ready until decoded and uploaded, see `textures_ref`
+inline TextureHandle textures_request(Textures& self, JobQueue& jobs, mu::StrView name, mu::Vec<uint8_t>&& png_data, GLenum filter_min, GLenum filter_mag) {
+	const auto handle = TextureHandle(self.list.size());
+	self.list.push_back(Texture {
+		.name = mu::Str(name),
+		.filter_min = filter_min,
+		.filter_mag = filter_mag,
+	});
+	self.num_requested++;
+
+	job_queue_submit(jobs, [self=&self, epoch=self.epoch, handle, name=mu::Str(name), png_data=std::move(png_data)]() {
+		TextureDecoded decoded { .handle = handle };
+
+		auto rw = SDL_RWFromConstMem(png_data.data(), (int)png_data.size());
+		if (auto surface = IMG_Load_RW(rw, 1)) {
+			mu_defer(SDL_FreeSurface(surface));
+
+			if (auto rgba = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0)) {
+				mu_defer(SDL_FreeSurface(rgba));
+
+				decoded.width = rgba->w;
+				decoded.height = rgba->h;
+				decoded.pixels.resize(rgba->w * rgba->h * 4);
+				for (int y = 0; y < rgba->h; y++) {
+					memcpy(decoded.pixels.data() + y * rgba->w * 4, (uint8_t*)rgba->pixels + y * rgba->pitch, rgba->w * 4);
+				}
+			} else {
+				decoded.error = mu::str_format("failed to convert texture '{}': {}", name, SDL_GetError());
+			}
+		} else {
+			decoded.error = mu::str_format("failed to decode texture '{}': {}", name, IMG_GetError());
+		}
+
+		std::lock_guard lock(self->mutex);
+		if (epoch == self->epoch) {
+			self->decoded.push_back(std::move(decoded));
+		}
+	});
+
+	return handle;
+}
+
+inline TextureRef textures_ref(const Textures& self, TextureHandle handle) {
+	if (handle >= self.list.size() || self.list[handle].ready == false) {
+		return {};
+	}
+	return self.list[handle].ref;
+}
+
+// deletes all textures, handles given before are invalid after
+inline void textures_clear(Textures& self) {
+	for (auto& array : self.arrays) {
+		glDeleteTextures(1, &array.id);
+	}
+	self.arrays.clear();
+	self.list.clear();
+	self.uploads.clear();
+	self.uploads_cursor = 0;
+	self.num_requested = 0;
+	self.generation++;
+
+	std::lock_guard lock(self.mutex);
+	self.epoch++;
+	self.decoded.clear();
+}
+
+// mipmapped equivalent of min filter given by asset
+inline GLenum _textures_filter_min_mipmapped(GLenum filter_min) {
+	switch (filter_min) {
+	case GL_NEAREST: return GL_NEAREST_MIPMAP_NEAREST;
+	case GL_LINEAR:  return GL_LINEAR_MIPMAP_LINEAR;
+	default:         return filter_min;
+	}
+}
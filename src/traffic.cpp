@@ -0,0 +1,183 @@
+#include "world.h"
+
+namespace sys {
+
+	void traffic_init(World& world) {
+		DEF_SYSTEM
+
+		signal_listen(world.signals.scenery_loaded);
+	}
+
+	void traffic_free(World& world) {
+		DEF_SYSTEM
+
+		aircraft_unload(world.traffic.aircraft);
+	}
+
+	void _traffic_aircraft_reload(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.traffic;
+
+		auto tmpl_it = world.aircraft_templates.find(world.settings.traffic.aircraft);
+		if (tmpl_it == world.aircraft_templates.end()) {
+			mu::log_warning("traffic aircraft '{}' not found", world.settings.traffic.aircraft);
+			world.settings.traffic.count = 0;
+			return;
+		}
+
+		aircraft_unload(self.aircraft);
+		self.aircraft = aircraft_new(tmpl_it->second);
+		aircraft_load(self.aircraft);
+		aircraft_update_aero_table(self.aircraft);
+
+		// at origin facing +z with gear down, meshes' transformations are of it and agents' transformations go over them
+		self.aircraft.translation = {0, 0, 0};
+		self.aircraft.landing_gear_alpha = 0;
+		_aircraft_transforms_update(world, self.aircraft);
+
+		FlightStates lanes {};
+		for (size_t i = 0; i < FLIGHT_LANES; i++) {
+			aircraft_flight_state_store(self.aircraft, lanes, flight_states_push(lanes));
+		}
+		self.prototype = lanes.blocks[0];
+
+		world.canvas.frame_drawing_stale = true;
+		mu::log_debug("loaded traffic '{}'", self.aircraft.aircraft_template.short_name);
+	}
+
+	// a route per ground path of visible fields, after fields are transformed
+	void _traffic_routes_rebuild(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.traffic;
+		traffic_clear(self);
+
+		for (const Field* fld : field_list_recursively(world.scenery.root_fld, mu::memory::tmp())) {
+			if (fld->visible == false) {
+				continue;
+			}
+
+			for (const auto& path : fld->ground_paths) {
+				const auto model_transformation = _scenery_model_transformation(fld->transformation, path.pos, path.rotation);
+
+				mu::Vec<glm::vec3> points(mu::memory::tmp());
+				for (const auto& p : path.points) {
+					// aircrafts rest 1m above ground
+					points.push_back(glm::vec3(model_transformation * glm::vec4{p, 1.0f}) - glm::vec3{0, 1, 0});
+				}
+				traffic_route_add(self, points, path.is_loop);
+			}
+		}
+
+		mu::log_debug("traffic has {} routes", self.routes.size());
+	}
+
+	// loading traffic's aircraft and spawning agents, on main thread
+	void traffic_update(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.traffic;
+		auto& settings = world.settings.traffic;
+
+		bool should_respawn = false;
+		if (signal_handle(world.signals.scenery_loaded)) {
+			_traffic_routes_rebuild(world);
+			should_respawn = true;
+		}
+
+		if (settings.count > 0 && self.aircraft.aircraft_template.short_name != settings.aircraft) {
+			_traffic_aircraft_reload(world);
+			should_respawn = true;
+		}
+
+		// agents are spread evenly again, whatever count they're changed to
+		const size_t count = std::max(settings.count, 0);
+		if (should_respawn || self.agents.size() != count) {
+			traffic_spawn(self, count, TRAFFIC_TAXI_SPEED);
+		}
+	}
+
+	// one simulation step, on simulation thread
+	void traffic_step(World& world) {
+		DEF_SYSTEM
+
+		auto& self = world.traffic;
+		if (self.agents.empty()) {
+			return;
+		}
+
+		mu::Vec<glm::vec3> focuses(&world.sim_thread.arena);
+		focuses.push_back(world.camera.position);
+		if (world.camera.aircraft) {
+			focuses.push_back(world.camera.aircraft->translation);
+		}
+		const auto& settings = world.settings.traffic;
+		traffic_lod_update(self, focuses, settings.full_radius, std::max(settings.full_max, 0));
+
+		workers_run(world.workers, [&](size_t slot) {
+			const auto [begin, end] = workers_slot_range(world.workers, slot, self.agents.size());
+			traffic_kinematic_step(self, begin, end);
+		});
+
+		// few blocks of FULL agents, not worth splitting
+		traffic_full_step(self, world.scenery.terrain, world.settings.brake_coeff);
+	}
+
+	// meshes of agents near camera, points for the rest
+	void traffic_prepare_render(World& world) {
+		DEF_SYSTEM
+
+		const auto& self = world.traffic;
+		if (self.agents.empty()) {
+			return;
+		}
+
+		const float alpha = world.sim_clock.alpha;
+		const float mesh_radius_sq = world.settings.traffic.mesh_radius * world.settings.traffic.mesh_radius;
+
+		workers_run(world.workers, [&](size_t slot) {
+			auto& cmds = canvas_frame_recording(world.canvas).cmd_lists[CANVAS_LANE_TRAFFIC][slot];
+			const auto [begin, end] = workers_slot_range(world.workers, slot, self.agents.size());
+
+			for (size_t i = begin; i < end; i++) {
+				const auto& agent = self.agents[i];
+				const auto translation = glm::mix(agent.prev_translation, agent.translation, alpha);
+
+				const auto d = translation - world.camera.position;
+				if (glm::dot(d, d) > mesh_radius_sq) {
+					canvas_add(cmds, canvas::ZLPoint {
+						.center = translation,
+						.color = glm::vec3{1.0f, 0.9f, 0.6f},
+					});
+					continue;
+				}
+
+				const auto orientation = glm::slerp(agent.prev_orientation, agent.orientation, alpha);
+				const auto agent_transformation = glm::translate(glm::mat4{1.0f}, translation) * glm::mat4_cast(orientation);
+
+				meshes_visit(self.aircraft.model.meshes, [&](const Mesh& mesh) {
+					if (!mesh.visible) {
+						return MeshVisit::SKIP_CHILDREN;
+					}
+
+					// taxiing, never at full throttle
+					if (mesh.animation_type == AnimationClass::AIRCRAFT_HIGH_THROTTLE
+						|| mesh.animation_type == AnimationClass::AIRCRAFT_AFTERBURNER_REHEAT) {
+						return MeshVisit::SKIP_CHILDREN;
+					}
+
+					const auto transformation = agent_transformation * mesh.transformation;
+					canvas_add(cmds, canvas::Mesh {
+						.vao = mesh.gl_buf.vao,
+						.buf_len = mesh.gl_buf.len,
+						.projection_view_model = world.mats.projection_view * transformation,
+						.model_normal = glm::transpose(glm::inverse(glm::mat3(transformation)))
+					});
+
+					return MeshVisit::CHILDREN;
+				}, &cmds.arena);
+			}
+		});
+	}
+}
@@ -0,0 +1,575 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <span>
+#include <limits>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <mu/utils.h>
+
+#include "math.h"
+#include "flight.h"
+#include "terrain.h"
+#include "aircraft.h"
+
+// route samples between each two points of a path
+constexpr uint32_t TRAFFIC_ROUTE_SEGMENT_SAMPLES = 8;
+
+// FULL agents are demoted this much farther than where they're promoted, so they don't flip every step at the border
+constexpr float TRAFFIC_LOD_HYSTERESIS = 1.25f;
+
+// seconds agents take to get back to cruise speed, and demoted ones to settle onto their route
+constexpr float TRAFFIC_BLEND_TIME = 2.0f;
+// seconds KINEMATIC agents take to turn to where route heads, smooths corners between samples
+constexpr float TRAFFIC_TURN_TIME = 0.25f;
+
+// FULL agents steer toward where route is this many seconds ahead of them (pure pursuit), not nearer than MIN
+constexpr float TRAFFIC_LOOKAHEAD_TIME = 2.0f;
+constexpr float TRAFFIC_LOOKAHEAD_MIN = 15.0f; // m
+
+// m/s, ~20kt, ground paths are taxiways
+constexpr float TRAFFIC_TAXI_SPEED = 10.0f;
+
+// a closed path aircrafts go around, centripetal catmull-rom spline through points of a path (doesn't overshoot
+// or loop at sharp taxiway corners like uniform one) sampled by distance along it
+struct TrafficRoute {
+	mu::Vec<glm::vec3> samples;
+	// distance along route to each sample, first is 0, last is `length` and its sample is the first one again
+	mu::Vec<float> distances;
+	float length;
+};
+
+struct TrafficRouteSample {
+	glm::vec3 position;
+	glm::vec3 direction; // normalized, where route heads at `position`
+};
+
+// paths that aren't loops are gone there and back, length is 0 if points are less than 2 distinct ones
+inline TrafficRoute traffic_route_new(std::span<const glm::vec3> points, bool is_loop) {
+	TrafficRoute self {};
+
+	mu::Vec<glm::vec3> ctrl(mu::memory::tmp());
+	for (const auto& p : points) {
+		if (ctrl.empty() || glm::distance(ctrl.back(), p) > 0.01f) {
+			ctrl.push_back(p);
+		}
+	}
+	if (is_loop && ctrl.size() > 1 && glm::distance(ctrl.front(), ctrl.back()) <= 0.01f) {
+		ctrl.pop_back();
+	}
+	if (ctrl.size() < 2) {
+		return self;
+	}
+	if (is_loop == false) {
+		for (size_t i = ctrl.size() - 2; i > 0; i--) {
+			ctrl.push_back(ctrl[i]);
+		}
+	}
+
+	// https://en.wikipedia.org/wiki/Centripetal_Catmull%E2%80%93Rom_spline, consecutive points are distinct so knots are too
+	const size_t n = ctrl.size();
+	for (size_t i = 0; i < n; i++) {
+		const glm::vec3& p0 = ctrl[(i + n - 1) % n];
+		const glm::vec3& p1 = ctrl[i];
+		const glm::vec3& p2 = ctrl[(i + 1) % n];
+		const glm::vec3& p3 = ctrl[(i + 2) % n];
+		const float t1 = std::sqrt(glm::distance(p0, p1));
+		const float t2 = t1 + std::sqrt(glm::distance(p1, p2));
+		const float t3 = t2 + std::sqrt(glm::distance(p2, p3));
+		for (uint32_t k = 0; k < TRAFFIC_ROUTE_SEGMENT_SAMPLES; k++) {
+			const float t = t1 + (t2 - t1) * k / TRAFFIC_ROUTE_SEGMENT_SAMPLES;
+			const glm::vec3 a1 = glm::mix(p0, p1, t / t1);
+			const glm::vec3 a2 = glm::mix(p1, p2, (t - t1) / (t2 - t1));
+			const glm::vec3 a3 = glm::mix(p2, p3, (t - t2) / (t3 - t2));
+			const glm::vec3 b1 = glm::mix(a1, a2, t / t2);
+			const glm::vec3 b2 = glm::mix(a2, a3, (t - t1) / (t3 - t1));
+			self.samples.push_back(glm::mix(b1, b2, (t - t1) / (t2 - t1)));
+		}
+	}
+	self.samples.push_back(self.samples.front());
+
+	self.distances.push_back(0);
+	for (size_t i = 1; i < self.samples.size(); i++) {
+		self.distances.push_back(self.distances.back() + glm::distance(self.samples[i-1], self.samples[i]));
+	}
+	self.length = self.distances.back();
+	return self;
+}
+
+// any distance to [0, length)
+inline float traffic_route_wrap(const TrafficRoute& self, float distance) {
+	distance = std::fmod(distance, self.length);
+	return distance < 0? distance + self.length : distance;
+}
+
+// `distance` in [0, length], `cursor` is sample at or before it, kept between calls so moving forward a bit is O(1)
+inline TrafficRouteSample traffic_route_sample(const TrafficRoute& self, float distance, uint32_t& cursor) {
+	const uint32_t last = self.samples.size() - 1;
+	if (cursor >= last || self.distances[cursor] > distance) {
+		const auto it = std::upper_bound(self.distances.begin(), self.distances.end(), distance);
+		cursor = std::clamp<uint32_t>(uint32_t(it - self.distances.begin()), 1, last) - 1;
+	}
+	while (cursor + 1 < last && self.distances[cursor+1] <= distance) {
+		cursor++;
+	}
+
+	const glm::vec3& a = self.samples[cursor];
+	const glm::vec3& b = self.samples[cursor+1];
+	const float segment = self.distances[cursor+1] - self.distances[cursor];
+	const float t = segment > 0? std::clamp((distance - self.distances[cursor]) / segment, 0.0f, 1.0f) : 0.0f;
+	return TrafficRouteSample {
+		.position = glm::mix(a, b, t),
+		.direction = segment > 0? (b - a) / segment : glm::vec3{0, 0, 1},
+	};
+}
+
+// distance along route of FULL agent after a step, it goes as far as its velocity along route then to nearest point
+// up to a sample ahead of that, never back, nearest point on whole route would jump between the way there and back
+inline float traffic_route_follow(const TrafficRoute& self, const glm::vec3& position, const glm::vec3& velocity, float distance, uint32_t& cursor) {
+	const auto here = traffic_route_sample(self, distance, cursor);
+	distance = traffic_route_wrap(self, distance + std::max(glm::dot(velocity, here.direction), 0.0f) * float(SIM_STEP));
+	traffic_route_sample(self, distance, cursor);
+
+	const uint32_t segments = self.samples.size() - 1;
+	float best_dist_sq = std::numeric_limits<float>::max();
+	float best_distance = distance;
+	for (uint32_t k = 0; k <= 1; k++) {
+		const uint32_t i = (cursor + k) % segments;
+		const glm::vec3& a = self.samples[i];
+		const glm::vec3 ab = self.samples[i+1] - a;
+		const float len_sq = glm::dot(ab, ab);
+		const float t = len_sq > 0? std::clamp(glm::dot(position - a, ab) / len_sq, 0.0f, 1.0f) : 0.0f;
+		const glm::vec3 d = a + ab * t - position;
+		if (glm::dot(d, d) < best_dist_sq) {
+			best_dist_sq = glm::dot(d, d);
+			best_distance = self.distances[i] + t * (self.distances[i+1] - self.distances[i]) + (i < cursor? self.length : 0);
+		}
+	}
+	return traffic_route_wrap(self, std::max(best_distance, distance));
+}
+
+// level aircraft with its nose along `direction`, see `local_euler_angles_from_quat`
+inline glm::quat traffic_orientation(const glm::vec3& direction) {
+	const float yaw = std::atan2(direction.x, direction.z);
+	const float pitch = std::atan2(-direction.y, std::sqrt(direction.x*direction.x + direction.z*direction.z));
+	return glm::angleAxis(yaw, glm::vec3{0, 1, 0}) * glm::angleAxis(pitch, glm::vec3{1, 0, 0});
+}
+
+enum class TrafficLod : uint8_t {
+	KINEMATIC, // moved along its route, no forces, meshes aren't animated
+	FULL,      // stepped by flight kernel like aircrafts are, steered to follow its route
+};
+
+struct TrafficAgent {
+	uint32_t route;
+	uint32_t cursor; // see `traffic_route_sample`
+	float distance;  // along route, of FULL agents too, where they're steered from
+	float speed, cruise_speed; // m/s
+
+	TrafficLod lod;
+	glm::vec3 translation, velocity;
+	glm::quat orientation{1, 0, 0, 0};
+
+	// FULL agents' flight state between steps
+	glm::vec3 angular_velocity;
+	float engine_speed;
+
+	// KINEMATIC agents are this far from their route, where they were demoted at, decays to zero
+	glm::vec3 offset;
+
+	// state before last step, rendering interpolates from it like aircrafts
+	glm::vec3 prev_translation;
+	glm::quat prev_orientation{1, 0, 0, 0};
+};
+
+// AI aircrafts going around routes, ones near camera or player are FULL up to a budget and the rest are KINEMATIC,
+// so cost of thousands of them is mostly one cheap loop, and FULL ones are a few flight blocks
+struct Traffic {
+	mu::Vec<TrafficRoute> routes;
+	mu::Vec<TrafficAgent> agents;
+
+	// all agents are this one aircraft, its meshes are drawn at each of them, loaded on main thread
+	Aircraft aircraft;
+
+	// constants of traffic's aircraft in every lane, blocks of `flight_states` start as a copy of it
+	FlightBlock prototype;
+
+	// FULL agents ascending, `full[i]` is in lane i of `flight_states`
+	mu::Vec<uint32_t> full;
+	FlightStates flight_states;
+
+	// reused each step, no allocations once they grew
+	mu::Vec<uint32_t> _candidates;
+	mu::Vec<float> _focus_dist_sq;
+	mu::Vec<uint8_t> _wanted;
+	mu::Vec<glm::vec2> _points;
+	mu::Vec<TerrainSample> _samples;
+};
+
+inline void traffic_clear(Traffic& self) {
+	self.routes.clear();
+	self.agents.clear();
+	self.full.clear();
+	flight_states_clear(self.flight_states);
+}
+
+// false if route is too short to follow
+inline bool traffic_route_add(Traffic& self, std::span<const glm::vec3> points, bool is_loop) {
+	auto route = traffic_route_new(points, is_loop);
+	if (route.length <= 0) {
+		return false;
+	}
+	self.routes.push_back(std::move(route));
+	return true;
+}
+
+// replaces agents by `count` KINEMATIC ones spaced evenly over all routes
+inline void traffic_spawn(Traffic& self, size_t count, float cruise_speed) {
+	self.agents.clear();
+	self.full.clear();
+
+	float total_length = 0;
+	for (const auto& route : self.routes) {
+		total_length += route.length;
+	}
+	if (count == 0 || total_length <= 0) {
+		return;
+	}
+
+	const float spacing = total_length / count;
+	uint32_t route_index = 0;
+	float route_start = 0;
+	for (size_t i = 0; i < count; i++) {
+		const float d = (i + 0.5f) * spacing;
+		while (route_index + 1 < self.routes.size() && d - route_start >= self.routes[route_index].length) {
+			route_start += self.routes[route_index].length;
+			route_index++;
+		}
+		const auto& route = self.routes[route_index];
+
+		TrafficAgent agent {
+			.route = route_index,
+			.distance = std::min(d - route_start, route.length),
+			.speed = cruise_speed,
+			.cruise_speed = cruise_speed,
+			.lod = TrafficLod::KINEMATIC,
+		};
+		const auto sample = traffic_route_sample(route, agent.distance, agent.cursor);
+		agent.translation = sample.position;
+		agent.velocity = sample.direction * cruise_speed;
+		agent.orientation = traffic_orientation(sample.direction);
+		agent.prev_translation = agent.translation;
+		agent.prev_orientation = agent.orientation;
+		self.agents.push_back(agent);
+	}
+}
+
+// nearest agents within `full_radius` of any of `focuses` become FULL, at most `full_max` of them, others KINEMATIC
+// both keep their translation, orientation and velocity so it's seamless, a demoted one blends back onto its route
+inline void traffic_lod_update(Traffic& self, std::span<const glm::vec3> focuses, float full_radius, size_t full_max) {
+	self._candidates.clear();
+	self._focus_dist_sq.resize(self.agents.size());
+	for (uint32_t i = 0; i < self.agents.size(); i++) {
+		const auto& agent = self.agents[i];
+
+		float dist_sq = std::numeric_limits<float>::max();
+		for (const auto& focus : focuses) {
+			const glm::vec3 d = agent.translation - focus;
+			dist_sq = std::min(dist_sq, glm::dot(d, d));
+		}
+		self._focus_dist_sq[i] = dist_sq;
+
+		const float radius = agent.lod == TrafficLod::FULL? full_radius * TRAFFIC_LOD_HYSTERESIS : full_radius;
+		if (dist_sq <= radius * radius) {
+			self._candidates.push_back(i);
+		}
+	}
+
+	if (self._candidates.size() > full_max) {
+		std::nth_element(self._candidates.begin(), self._candidates.begin() + full_max, self._candidates.end(), [&](uint32_t a, uint32_t b) {
+			return self._focus_dist_sq[a] < self._focus_dist_sq[b];
+		});
+		self._candidates.resize(full_max);
+	}
+	std::sort(self._candidates.begin(), self._candidates.end());
+
+	self._wanted.assign(self.agents.size(), 0);
+	for (uint32_t i : self._candidates) {
+		self._wanted[i] = 1;
+	}
+
+	for (uint32_t i : self.full) {
+		auto& agent = self.agents[i];
+		if (self._wanted[i] == 0) {
+			const auto& route = self.routes[agent.route];
+			agent.lod = TrafficLod::KINEMATIC;
+			agent.offset = agent.translation - traffic_route_sample(route, agent.distance, agent.cursor).position;
+			agent.speed = glm::length(agent.velocity);
+		}
+	}
+	for (uint32_t i : self._candidates) {
+		auto& agent = self.agents[i];
+		if (agent.lod != TrafficLod::FULL) {
+			agent.lod = TrafficLod::FULL;
+			agent.offset = {};
+			agent.angular_velocity = {};
+		}
+	}
+
+	std::swap(self.full, self._candidates);
+}
+
+// saves previous state of agents in [begin, end) and moves KINEMATIC ones, before `traffic_full_step`
+inline void traffic_kinematic_step(Traffic& self, size_t begin, size_t end) {
+	const float blend = 1.0f - std::exp(-float(SIM_STEP) / TRAFFIC_BLEND_TIME);
+	const float turn = 1.0f - std::exp(-float(SIM_STEP) / TRAFFIC_TURN_TIME);
+
+	for (size_t i = begin; i < end; i++) {
+		auto& agent = self.agents[i];
+		agent.prev_translation = agent.translation;
+		agent.prev_orientation = agent.orientation;
+
+		if (agent.lod != TrafficLod::KINEMATIC) {
+			continue;
+		}
+
+		const auto& route = self.routes[agent.route];
+		agent.speed += (agent.cruise_speed - agent.speed) * blend;
+		agent.distance = traffic_route_wrap(route, agent.distance + agent.speed * float(SIM_STEP));
+		const auto sample = traffic_route_sample(route, agent.distance, agent.cursor);
+
+		agent.offset -= agent.offset * blend;
+		agent.translation = sample.position + agent.offset;
+		agent.velocity = sample.direction * agent.speed;
+		agent.orientation = glm::slerp(agent.orientation, traffic_orientation(sample.direction), turn);
+	}
+}
+
+// one SIM_STEP of FULL agents in the flight kernel, nose wheel steers them after where their route is ahead
+inline void traffic_full_step(Traffic& self, const Terrain& terrain, float brake_coeff) {
+	flight_states_clear(self.flight_states);
+	if (self.full.empty()) {
+		return;
+	}
+
+	self._points.clear();
+	for (uint32_t i : self.full) {
+		self._points.push_back(glm::vec2{self.agents[i].translation.x, self.agents[i].translation.z});
+	}
+	self._samples.resize(self._points.size());
+	terrain_sample_batch(terrain, self._points, self._samples);
+
+	const auto& p = self.prototype;
+	const float wheelbase = std::max(p.wheelbase[0], 0.01f);
+	const float mass = std::max(p.mass[0], 1.0f);
+	const float thrust_idle = flight_thrust(0, p.max_power[0], p.idle_power[0], p.thrust_multiplier[0]);
+	const float thrust_max = flight_thrust(1, p.max_power[0], p.idle_power[0], p.thrust_multiplier[0]);
+	for (size_t j = 0; j < self.full.size(); j++) {
+		const auto& agent = self.agents[self.full[j]];
+		const auto& route = self.routes[agent.route];
+
+		const size_t index = flight_states_push(self.flight_states);
+		auto& b = self.flight_states.blocks[index / FLIGHT_LANES];
+		const size_t l = index % FLIGHT_LANES;
+		if (l == 0) {
+			b = self.prototype;
+		}
+
+		b.px[l] = agent.translation.x; b.py[l] = agent.translation.y; b.pz[l] = agent.translation.z;
+		b.vx[l] = agent.velocity.x; b.vy[l] = agent.velocity.y; b.vz[l] = agent.velocity.z;
+		b.qw[l] = agent.orientation.w; b.qx[l] = agent.orientation.x; b.qy[l] = agent.orientation.y; b.qz[l] = agent.orientation.z;
+		b.wx[l] = agent.angular_velocity.x; b.wy[l] = agent.angular_velocity.y; b.wz[l] = agent.angular_velocity.z;
+		b.ground_y[l] = self._samples[j].y;
+
+		// pure pursuit, curvature of the arc through the point `lookahead` ahead on route, then nose wheel angle of it
+		const float speed = glm::length(agent.velocity);
+		uint32_t cursor = agent.cursor;
+		const float lookahead = std::max(speed * TRAFFIC_LOOKAHEAD_TIME, TRAFFIC_LOOKAHEAD_MIN);
+		const auto target = traffic_route_sample(route, traffic_route_wrap(route, agent.distance + lookahead), cursor).position;
+		const glm::vec3 to_target = target - agent.translation;
+		const glm::vec3 front = agent.orientation * glm::vec3{0, 0, 1};
+		const glm::vec3 up = -(agent.orientation * glm::vec3{0, 1, 0});
+		const float heading_error = std::atan2(glm::dot(to_target, glm::cross(front, up)), glm::dot(to_target, front));
+		const float curvature = 2.0f * std::sin(heading_error) / std::max(glm::length(to_target), 1.0f);
+		// target behind (end of a route that goes back) has no curvature toward it, turn around at full lock
+		const bool behind = std::abs(heading_error) > 0.5f * glm::pi<float>();
+		b.rudder[l] = behind? (heading_error < 0? -1.0f : 1.0f) : std::clamp(std::atan(curvature * wheelbase) / MAX_WHEEL_STEER_ANGLE, -1.0f, 1.0f);
+		b.elevator[l] = 0;
+		b.aileron[l] = 0;
+
+		// thrust that cancels rolling friction and closes speed error in about TRAFFIC_BLEND_TIME, idle thrust is often
+		// more than that so engine_on scales it down, thrust can't slow down so brakes do well above cruise speed
+		const float speed_error = agent.cruise_speed - speed;
+		const float thrust = mass * (p.friction_coeff[0] * FLIGHT_GRAVITY + speed_error * float(SIM_STEP) / (FLIGHT_DT_FREE_TUNING_SCALE * TRAFFIC_BLEND_TIME));
+		if (thrust <= thrust_idle) {
+			b.engine_on[l] = thrust_idle > 0? std::clamp(thrust / thrust_idle, 0.0f, 1.0f) : 0.0f;
+			b.engine_speed[l] = 0;
+		} else {
+			b.engine_on[l] = 1;
+			b.engine_speed[l] = thrust_max > thrust_idle? std::clamp((thrust - thrust_idle) / (thrust_max - thrust_idle), 0.0f, 1.0f) : 0.0f;
+		}
+		b.braking[l] = speed > agent.cruise_speed * 1.1f? 1.0f : 0.0f;
+	}
+
+	flight_states_step(self.flight_states, brake_coeff);
+
+	for (size_t j = 0; j < self.full.size(); j++) {
+		auto& agent = self.agents[self.full[j]];
+		const auto& b = self.flight_states.blocks[j / FLIGHT_LANES];
+		const size_t l = j % FLIGHT_LANES;
+
+		agent.translation = {b.px[l], b.py[l], b.pz[l]};
+		agent.velocity = {b.vx[l], b.vy[l], b.vz[l]};
+		agent.orientation = glm::quat{b.qw[l], b.qx[l], b.qy[l], b.qz[l]};
+		agent.angular_velocity = {b.wx[l], b.wy[l], b.wz[l]};
+		agent.engine_speed = b.engine_speed[l];
+		agent.distance = traffic_route_follow(self.routes[agent.route], agent.translation, agent.velocity, agent.distance, agent.cursor);
+	}
+}
+
+// whole step on calling thread, systems split `traffic_kinematic_step` over workers instead
+inline void traffic_step(Traffic& self, const Terrain& terrain, std::span<const glm::vec3> focuses, float full_radius, size_t full_max, float brake_coeff) {
+	traffic_lod_update(self, focuses, full_radius, full_max);
+	traffic_kinematic_step(self, 0, self.agents.size());
+	traffic_full_step(self, terrain, brake_coeff);
+}
+
+inline void test_traffic() {
+	mu_test_suite("traffic");
+
+	// loop through corners of a square, samples are continuous and end where they start
+	{
+		const glm::vec3 points[] = {{0, -1, 0}, {100, -1, 0}, {100, -1, 100}, {0, -1, 100}};
+		const auto route = traffic_route_new(points, true);
+		mu_test(route.length > 400 && route.length < 430);
+		mu_test(route.samples.size() == 4 * TRAFFIC_ROUTE_SEGMENT_SAMPLES + 1);
+
+		uint32_t cursor = 0;
+		mu_test(glm::distance(traffic_route_sample(route, 0, cursor).position, points[0]) < 1e-4f);
+		mu_test(glm::distance(traffic_route_sample(route, route.length, cursor).position, points[0]) < 1e-3f);
+
+		bool continuous = true;
+		glm::vec3 prev = points[0];
+		for (float d = 1; d < route.length; d += 1) {
+			const auto sample = traffic_route_sample(route, d, cursor);
+			continuous = continuous && glm::distance(prev, sample.position) <= 1.001f && std::abs(glm::length(sample.direction) - 1) < 1e-3f;
+			prev = sample.position;
+		}
+		mu_test(continuous);
+
+		// cursor from a far away distance is found again
+		cursor = 3;
+		mu_test(glm::distance(traffic_route_sample(route, route.length * 0.5f, cursor).position, points[2]) < 1e-3f);
+	}
+
+	// not a loop, there and back on a straight line, too few points isn't a route
+	{
+		const glm::vec3 points[] = {{0, -1, 0}, {0, -1, 50}, {0, -1, 50}};
+		const auto route = traffic_route_new(points, false);
+		mu_test(std::abs(route.length - 100) < 1e-3f);
+		uint32_t cursor = 0;
+		mu_test(glm::distance(traffic_route_sample(route, 75, cursor).position, glm::vec3{0, -1, 25}) < 1e-3f);
+
+		Traffic traffic {};
+		mu_test(traffic_route_add(traffic, std::span(points + 1, 2), true) == false);
+		mu_test(traffic.routes.empty());
+	}
+
+	// KINEMATIC agents go around at cruise speed
+	{
+		const glm::vec3 points[] = {{0, -1, 0}, {400, -1, 0}, {400, -1, 400}, {0, -1, 400}};
+		Traffic traffic {};
+		traffic_route_add(traffic, points, true);
+		traffic_spawn(traffic, 10, 10);
+		mu_test(traffic.agents.size() == 10);
+
+		const float length = traffic.routes[0].length;
+		const float start = traffic.agents[3].distance;
+		mu_test(std::abs(start - 3.5f * length / 10) < 1e-2f);
+
+		for (int step = 0; step < 120 * 30; step++) {
+			traffic_step(traffic, Terrain {}, {}, 0, 0, 1);
+		}
+		const auto& agent = traffic.agents[3];
+		mu_test(std::abs(agent.distance - traffic_route_wrap(traffic.routes[0], start + 300)) < 0.5f);
+		uint32_t cursor = 0;
+		mu_test(glm::distance(agent.translation, traffic_route_sample(traffic.routes[0], agent.distance, cursor).position) < 1e-3f);
+		mu_test(agent.lod == TrafficLod::KINEMATIC && traffic.flight_states.count == 0);
+	}
+
+	// nearest within radius are FULL up to budget, they're kept till a bit farther
+	{
+		const glm::vec3 points[] = {{0, -1, 0}, {1000, -1, 0}};
+		Traffic traffic {};
+		traffic_route_add(traffic, points, false);
+		traffic_spawn(traffic, 20, 10); // 100m apart, first at 50 going +x
+
+		const glm::vec3 focus[] = {{0, -1, 0}};
+		traffic_lod_update(traffic, focus, 320, 2);
+		mu_test(traffic.full.size() == 2 && traffic.full[0] == 0 && traffic.full[1] == 19);
+		mu_test(traffic.agents[0].lod == TrafficLod::FULL && traffic.agents[1].lod == TrafficLod::KINEMATIC);
+
+		traffic_lod_update(traffic, focus, 320, 8);
+		mu_test(traffic.full.size() == 6);
+
+		traffic_lod_update(traffic, focus, 45, 8);
+		mu_test(traffic.full.size() == 2);
+
+		traffic_lod_update(traffic, focus, 10, 8);
+		mu_test(traffic.full.empty() && traffic.agents[0].lod == TrafficLod::KINEMATIC);
+	}
+
+	// FULL agents follow their route in flight kernel, then demoted they blend back onto it without jumping
+	{
+		glm::vec3 points[12];
+		for (int i = 0; i < 12; i++) {
+			const float a = i * 2.0f * 3.14159265f / 12;
+			points[i] = {300 * std::cos(a), -1, 300 * std::sin(a)};
+		}
+
+		Traffic traffic {};
+		traffic_route_add(traffic, points, true);
+		traffic_spawn(traffic, 2, 10);
+		for (int l = 0; l < FLIGHT_LANES; l++) {
+			auto& p = traffic.prototype;
+			p.qw[l] = 1;
+			p.mass[l] = 2.45e7;
+			p.max_power[l] = 3060;
+			p.idle_power[l] = 30;
+			p.thrust_multiplier[l] = 500;
+			p.max_velocity[l] = 150;
+			p.wing_area[l] = 90;
+			p.friction_coeff[l] = 0.032f;
+			p.wheelbase[l] = 10;
+			p.aero[l] = &FLIGHT_AERO_TABLE_ZERO;
+		}
+
+		const float start = traffic.agents[0].distance;
+		float max_off_route = 0;
+		for (int step = 0; step < 120 * 60; step++) {
+			const glm::vec3 focus[] = {traffic.agents[0].translation};
+			traffic_step(traffic, Terrain {}, focus, 1000, 1, 1);
+			uint32_t cursor = traffic.agents[0].cursor;
+			const auto on_route = traffic_route_sample(traffic.routes[0], traffic.agents[0].distance, cursor).position;
+			max_off_route = std::max(max_off_route, glm::distance(traffic.agents[0].translation, on_route));
+		}
+		const auto& agent = traffic.agents[0];
+		mu_test(agent.lod == TrafficLod::FULL && traffic.agents[1].lod == TrafficLod::KINEMATIC);
+		mu_test(traffic.flight_states.count == 1);
+		mu_test(max_off_route < 5);
+		const float traveled = traffic_route_wrap(traffic.routes[0], agent.distance - start);
+		mu_test(traveled > 500 && traveled < 660);
+
+		traffic_step(traffic, Terrain {}, {}, 1000, 1, 1);
+		mu_test(agent.lod == TrafficLod::KINEMATIC);
+		mu_test(glm::distance(agent.translation, agent.prev_translation) < 0.2f);
+		for (int step = 0; step < 120 * 20; step++) {
+			traffic_step(traffic, Terrain {}, {}, 1000, 1, 1);
+		}
+		mu_test(glm::length(agent.offset) < 0.01f && std::abs(agent.speed - 10) < 0.01f);
+	}
+}
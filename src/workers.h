@@ -0,0 +1,286 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include <mu/utils.h>
+
+constexpr size_t WORKERS_MAX = 16;
+
+// jobs spawned with it are done when `pending` is back to 0, see `workers_wait`
+struct WorkersCounter {
+	std::atomic<uint32_t> pending;
+};
+
+struct WorkersJob {
+	const char* name;
+	std::function<void()> fn;
+	WorkersCounter* counter;
+};
+
+// a worker pushes and pops its own jobs at back, others steal from front when theirs run out,
+// so a worker runs what it spawned last while it's still in cache and thieves take the oldest, biggest jobs
+struct WorkersDeque {
+	std::mutex mutex;
+	std::deque<WorkersJob> jobs;
+};
+
+// a job a worker ran, millis since `workers_timeline_begin`
+struct WorkersSpan {
+	const char* name;
+	float begin_millis, end_millis;
+};
+
+// one thread per core that run jobs, each from its own deque first then stealing from others
+// index 0 is whichever thread spawns and waits from outside (simulation thread, or main thread when it's off),
+// waiting runs jobs instead of blocking, so jobs can spawn and wait on jobs of their own
+struct Workers {
+	mu::Vec<std::thread> threads;
+	// threads + 1, set before they start as they read it
+	size_t count;
+	mu::Arr<WorkersDeque, WORKERS_MAX> deques;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::atomic<uint32_t> num_queued;
+	bool quit;
+
+	// jobs each worker ran since last `workers_timeline_begin`, previous frame's are in `timelines`
+	std::chrono::steady_clock::time_point timeline_start;
+	mu::Arr<mu::Vec<WorkersSpan>, WORKERS_MAX> timelines_recording;
+	std::mutex timelines_mutex;
+	mu::Arr<mu::Vec<WorkersSpan>, WORKERS_MAX> timelines;
+	float timeline_millis;
+};
+
+// deque and timeline of thread running it, and name of job it's running (jobs it spawns from workers_run are named the same)
+inline thread_local size_t _workers_index = 0;
+inline thread_local const char* _workers_job_name = "workers";
+
+inline size_t workers_count(const Workers& self) {
+	return std::max<size_t>(self.count, 1);
+}
+
+inline void _workers_job_run(Workers& self, WorkersJob& job) {
+	const char* parent_name = _workers_job_name;
+	_workers_job_name = job.name;
+	const auto begin = std::chrono::steady_clock::now();
+
+	job.fn();
+
+	const auto end = std::chrono::steady_clock::now();
+	_workers_job_name = parent_name;
+	self.timelines_recording[_workers_index].push_back(WorkersSpan {
+		.name = job.name,
+		.begin_millis = std::chrono::duration<float, std::milli>(begin - self.timeline_start).count(),
+		.end_millis = std::chrono::duration<float, std::milli>(end - self.timeline_start).count(),
+	});
+
+	// last thing touching the job, whoever waits on counter may return right after
+	job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+// runs one job, own newest first then oldest of others, false if there was none
+inline bool _workers_run_one(Workers& self) {
+	const size_t count = workers_count(self);
+	for (size_t i = 0; i < count; i++) {
+		const size_t index = (_workers_index + i) % count;
+		auto& deque = self.deques[index];
+
+		WorkersJob job;
+		{
+			std::lock_guard lock(deque.mutex);
+			if (deque.jobs.empty()) {
+				continue;
+			}
+			if (i == 0) {
+				job = std::move(deque.jobs.back());
+				deque.jobs.pop_back();
+			} else {
+				job = std::move(deque.jobs.front());
+				deque.jobs.pop_front();
+			}
+		}
+		self.num_queued.fetch_sub(1, std::memory_order_relaxed);
+
+		_workers_job_run(self, job);
+		return true;
+	}
+	return false;
+}
+
+inline void _workers_thread_main(Workers* self, size_t index) {
+	_workers_index = index;
+	while (true) {
+		if (_workers_run_one(*self)) {
+			continue;
+		}
+
+		std::unique_lock lock(self->mutex);
+		self->cv.wait(lock, [&] { return self->quit || self->num_queued.load(std::memory_order_relaxed) > 0; });
+		if (self->quit) {
+			return;
+		}
+	}
+}
+
+// starts `count-1` threads, count is clamped to [1, WORKERS_MAX]
+inline void workers_init(Workers& self, size_t count) {
+	count = std::clamp<size_t>(count, 1, WORKERS_MAX);
+	self.count = count;
+	self.timeline_start = std::chrono::steady_clock::now();
+	for (size_t index = 1; index < count; index++) {
+		self.threads.emplace_back(_workers_thread_main, &self, index);
+	}
+}
+
+inline void workers_free(Workers& self) {
+	{
+		std::lock_guard lock(self.mutex);
+		self.quit = true;
+	}
+	self.cv.notify_all();
+	for (auto& thread : self.threads) {
+		thread.join();
+	}
+	self.threads.clear();
+	self.count = 1;
+}
+
+// queues `fn` on calling thread's deque, it may run on any worker, wait for it with `workers_wait(counter)`
+inline void workers_spawn(Workers& self, WorkersCounter& counter, const char* name, std::function<void()>&& fn) {
+	counter.pending.fetch_add(1, std::memory_order_relaxed);
+	{
+		auto& deque = self.deques[_workers_index];
+		std::lock_guard lock(deque.mutex);
+		deque.jobs.push_back(WorkersJob {
+			.name = name,
+			.fn = std::move(fn),
+			.counter = &counter,
+		});
+	}
+	self.num_queued.fetch_add(1, std::memory_order_relaxed);
+
+	// sleeping workers check num_queued under mutex, taking it here means they either see the job or get notified
+	{
+		std::lock_guard lock(self.mutex);
+	}
+	self.cv.notify_one();
+}
+
+// runs queued jobs (any, not only counter's) till all jobs spawned with `counter` are done
+inline void workers_wait(Workers& self, WorkersCounter& counter) {
+	while (counter.pending.load(std::memory_order_acquire) > 0) {
+		if (_workers_run_one(self) == false) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+// runs `task(slot)` for every slot in [0, workers_count) and blocks until all of them return
+// calling thread runs slot 0, and it can be called from inside a job
+inline void workers_run(Workers& self, const std::function<void(size_t slot)>& task) {
+	if (workers_count(self) == 1) {
+		task(0);
+		return;
+	}
+
+	WorkersCounter counter {};
+	for (size_t slot = 1; slot < workers_count(self); slot++) {
+		workers_spawn(self, counter, _workers_job_name, [&task, slot] { task(slot); });
+	}
+
+	task(0);
+
+	workers_wait(self, counter);
+}
+
+// contiguous range [begin, end) of `count` items that belongs to `slot`
+// processing slots' ranges in slot order visits items in their original order
+inline std::pair<size_t, size_t> workers_slot_range(const Workers& self, size_t slot, size_t count) {
+	const size_t n = workers_count(self);
+	return { count * slot / n, count * (slot+1) / n };
+}
+
+// what workers ran since last call becomes `timelines`, no job may be running
+inline void workers_timeline_begin(Workers& self) {
+	const auto now = std::chrono::steady_clock::now();
+	{
+		std::lock_guard lock(self.timelines_mutex);
+		for (size_t i = 0; i < workers_count(self); i++) {
+			std::swap(self.timelines[i], self.timelines_recording[i]);
+		}
+		self.timeline_millis = std::chrono::duration<float, std::milli>(now - self.timeline_start).count();
+	}
+
+	for (auto& spans : self.timelines_recording) {
+		spans.clear();
+	}
+	self.timeline_start = now;
+}
+
+// background threads for jobs that take too long to run inside a frame, e.g. decoding assets
+// jobs start in submission order and may finish in any order, jobs still queued on free are dropped
+struct JobQueue {
+	mu::Vec<std::thread> threads;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<std::function<void()>> jobs;
+	bool quit;
+};
+
+inline void _job_queue_thread_main(JobQueue* self) {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock lock(self->mutex);
+			self->cv.wait(lock, [&] { return self->quit || self->jobs.empty() == false; });
+			if (self->quit) {
+				return;
+			}
+			job = std::move(self->jobs.front());
+			self->jobs.pop_front();
+		}
+
+		job();
+	}
+}
+
+// starts `count` threads, count is clamped to [1, WORKERS_MAX]
+inline void job_queue_init(JobQueue& self, size_t count) {
+	count = std::clamp<size_t>(count, 1, WORKERS_MAX);
+	for (size_t i = 0; i < count; i++) {
+		self.threads.emplace_back(_job_queue_thread_main, &self);
+	}
+}
+
+inline void job_queue_free(JobQueue& self) {
+	{
+		std::lock_guard lock(self.mutex);
+		self.quit = true;
+		self.jobs.clear();
+	}
+	self.cv.notify_all();
+	for (auto& thread : self.threads) {
+		thread.join();
+	}
+	self.threads.clear();
+}
+
+// `job` runs on one of the queue threads, it must synchronize whatever it shares with the frame
+inline void job_queue_submit(JobQueue& self, std::function<void()>&& job) {
+	{
+		std::lock_guard lock(self.mutex);
+		self.jobs.push_back(std::move(job));
+	}
+	self.cv.notify_one();
+}
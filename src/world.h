@@ -3,6 +3,8 @@
 #include <SDL.h>
 
 #include <cstdint>
+#include <chrono>
+#include <mutex>
 
 #include <glm/glm.hpp>
 
@@ -16,8 +18,18 @@
 #include "ground_obj.h"
 #include "aircraft.h"
 #include "audio.h"
-
+#include "workers.h"
+#include "textures.h"
+#include "sim.h"
+#include "headless.h"
+#include "simulate.h"
+#include "recorder.h"
+#include "broadphase.h"
+#include "traffic.h"
+
+// logs come from simulation thread too, lock `mutex` to read `logs`
 struct ImGuiWindowLogger : public mu::ILogger {
+	std::mutex mutex;
 	mu::memory::Arena _arena;
 	mu::Vec<mu::Str> logs;
 
@@ -26,23 +38,27 @@ struct ImGuiWindowLogger : public mu::ILogger {
 	float last_scrolled_line = 0;
 
 	virtual void log_debug(mu::StrView str) override {
+		std::lock_guard lock(mutex);
 		logs.push_back(mu::str_format(&_arena, "> {}\n", str));
 		fmt::print("[debug] {}\n", str);
 	}
 
 	virtual void log_info(mu::StrView str) override {
+		std::lock_guard lock(mutex);
 		auto formatted = mu::str_format(&_arena, "[info] {}\n", str);
 		fmt::vprint(stdout, formatted, {});
 		logs.push_back(std::move(formatted));
 	}
 
 	virtual void log_warning(mu::StrView str) override {
+		std::lock_guard lock(mutex);
 		auto formatted = mu::str_format(&_arena, "[warning] {}\n", str);
 		fmt::vprint(stdout, formatted, {});
 		logs.push_back(std::move(formatted));
 	}
 
 	virtual void log_error(mu::StrView str) override {
+		std::lock_guard lock(mutex);
 		auto formatted = mu::str_format(&_arena, "[error] {}\n", str);
 		fmt::vprint(stderr, formatted, {});
 		logs.push_back(std::move(formatted));
@@ -114,18 +130,20 @@ struct Signals {
 	Signal scenery_loaded;
 };
 
+using TimePoint = std::chrono::steady_clock::time_point;
+
 struct LoopTimer {
-	uint64_t _last_time_millis;
-	int64_t _millis_till_render;
+	TimePoint _last_time;
+	TimePoint _next_frame_time; // only when fps is limited
 
-	// seconds since previous frame
+	// seconds since previous frame, measured not forced, simulation steps are fixed by SimClock
 	double delta_time;
 
 	bool ready;
 };
 
-inline uint64_t time_now_millis() {
-	return SDL_GetTicks64();
+inline TimePoint time_now() {
+	return std::chrono::steady_clock::now();
 }
 
 inline void time_delay_millis(uint32_t millis) {
@@ -138,9 +156,12 @@ struct World {
 
 	ImGuiWindowLogger imgui_window_logger;
 	mu::Str imgui_ini_file_path;
-	mu::Vec<mu::Str> text_overlay_list;
 
 	LoopTimer loop_timer;
+	SimThread sim_thread;
+	SimClock sim_clock;
+	// one-shot events (toggles, mouse motion) of frames that had no simulation step, applied with next step
+	Events sim_pending_events;
 
 	// name -> templates
 	mu::Map<mu::Str, AircraftTemplate> aircraft_templates;
@@ -152,7 +173,13 @@ struct World {
 
 	mu::Vec<Aircraft> aircrafts;
 	mu::Vec<GroundObj> ground_objs;
+	// visible aircrafts while physics steps them, rebuilt each step
+	FlightStates flight_states;
 	Scenery scenery;
+	// AABBs of aircrafts and ground objects, synced with them by models_handle_collision
+	Broadphase broadphase;
+	// AI aircrafts, not in aircrafts, broadphase or recordings
+	Traffic traffic;
 
 	Camera camera;
 	PerspectiveProjection projection;
@@ -164,10 +191,26 @@ struct World {
 
 	Canvas canvas;
 
+	// run systems of SimThread frame graphs, and work they split per slot, e.g. prepare_render
+	Workers workers;
+	// long running background jobs, e.g. decoding textures
+	JobQueue jobs;
+
+	Textures textures;
+
+	Headless headless;
+	Simulate simulate;
+	Recorder recorder;
+	Replay replay;
+
 	SysMon sysmon;
 };
 
-#define TEXT_OVERLAY(...) world.text_overlay_list.push_back(mu::str_tmpf(__VA_ARGS__))
+// only from simulation side, lines are part of the recorded frame
+#define TEXT_OVERLAY(...) do {																\
+	auto& _overlay_frame = canvas_frame_recording(world.canvas);							\
+	_overlay_frame.text_overlay_list.push_back(mu::str_format(&_overlay_frame.arena, __VA_ARGS__));	\
+} while (0)
 
 // Forward declarations for sys functions defined in separate .cpp files
 namespace sys {
@@ -176,19 +219,36 @@ namespace sys {
 	void camera_update(World& world);
 	void cached_matrices_recalc(World& world);
 
+	void sim_update(World& world);
+	void sim_frame(World& world);
+	void sim_thread_init(World& world);
+	void sim_thread_free(World& world);
+	void sim_thread_wait(World& world);
+	void sim_thread_kick(World& world);
+
 	void aircrafts_init(World& world);
 	void aircrafts_free(World& world);
 	void _aircrafts_apply_user_controls(World& world);
 	void _aircrafts_apply_physics(World& world);
 	void aircrafts_update(World& world);
+	void aircrafts_step(World& world);
+	void aircrafts_audio_update(World& world);
 	void aircrafts_prepare_render(World& world);
+	void _aircraft_transforms_update(World& world, Aircraft& aircraft);
 
 	void ground_objs_init(World& world);
 	void ground_objs_free(World& world);
 	void _ground_objs_apply_physics(World& world);
 	void ground_objs_update(World& world);
+	void ground_objs_step(World& world);
 	void ground_objs_prepare_render(World& world);
 
+	void traffic_init(World& world);
+	void traffic_free(World& world);
+	void traffic_update(World& world);
+	void traffic_step(World& world);
+	void traffic_prepare_render(World& world);
+
 	void scenery_init(World& world);
 	void scenery_free(World& world);
 	void scenery_update(World& world);
@@ -208,4 +268,25 @@ namespace sys {
 	void canvas_render_hud_text(World& world);
 	void canvas_render_hud_geoms(World& world);
 	void canvas_render_lines(World& world);
+
+	void textures_init(World& world);
+	void textures_free(World& world);
+	void textures_update(World& world);
+
+	void headless_init(World& world);
+	void headless_free(World& world);
+	void headless_frame_begin(World& world);
+	void headless_frame_end(World& world);
+	void headless_report(World& world);
+
+	void simulate_init(World& world);
+	void simulate_run(World& world);
+	void simulate_report(World& world);
+	void simulate_bench(World& world);
+
+	void recorder_init(World& world);
+	void recorder_free(World& world);
+	void recorder_step(World& world);
+	void replay_init(World& world);
+	void replay_free(World& world);
 }